@@ -0,0 +1,177 @@
+﻿//	MIT License
+//
+//	Copyright (c) 2016 Fabian Löschner
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in all
+//	copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//	SOFTWARE.
+
+// The accounting changes the inline functions of the library, so these tests
+// are built as their own program instead of being part of test_tool
+#define LIN_ALGEBRA_FLOP_ACCOUNTING
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "vector3.h"
+#include "quaternion.h"
+#include "dynamic_matrix.h"
+#include "counting_scalar.h"
+
+using namespace lin_algebra;
+
+/**
+ * Checks that an operation is tallied as a single call whose floating point
+ * operations match the arithmetic operations counted by CountingScalar
+ */
+template<typename F>
+static void checkAccountedFlops(const char* name, F operation)
+{
+	INFO(name);
+	resetOperationTallies();
+	OperationCounter counter;
+	operation();
+	const OperationCounts counts = counter.counts();
+	const OperationTally total = operationTallies().total();
+	CHECK(total.calls == 1);
+	CHECK(total.flops == counts.arithmetic());
+}
+
+TEST_CASE("Testing FLOP accounting")
+{
+	REQUIRE(flopAccountingEnabled);
+
+	SECTION("Testing the tallies")
+	{
+		typedef Quaternion<double> quatd;
+		const quatd p(0.5, 0.5, 0.5, 0.5), q(0.8, 0., 0.6, 0.);
+
+		resetOperationTallies();
+		const quatd r = p*q;
+		(void)r;
+		OperationTallies tallies = operationTallies();
+		REQUIRE(tallies[AccountedOperation::QuaternionProduct].calls == 1);
+		REQUIRE(tallies[AccountedOperation::QuaternionProduct].flops == 29);
+		REQUIRE(tallies[AccountedOperation::QuaternionProduct].bytes == 12*sizeof(double));
+		// The inner and cross product of the vector components are part of the quaternion product
+		REQUIRE(tallies.total().calls == 1);
+
+		const quatd s = quatd::slerp(p, q, 0.5);
+		(void)s;
+		tallies = operationTallies();
+		REQUIRE(tallies[AccountedOperation::QuaternionSlerp].calls == 1);
+		REQUIRE(tallies[AccountedOperation::QuaternionSlerp].flops == 127);
+		REQUIRE(tallies[AccountedOperation::QuaternionProduct].calls == 1);
+		REQUIRE(tallies.total().calls == 2);
+
+		const Matrix<double,4,4> a = Matrix<double,4,4>::createIdentity();
+		resetOperationTallies();
+		const Matrix<double,4,4> b = a*a;
+		(void)b;
+		tallies = operationTallies();
+		REQUIRE(tallies[AccountedOperation::MatrixProduct].calls == 1);
+		REQUIRE(tallies[AccountedOperation::MatrixProduct].flops == 2*4*4*4);
+		REQUIRE(tallies[AccountedOperation::MatrixProduct].bytes == 3*16*sizeof(double));
+		REQUIRE(tallies[AccountedOperation::MatrixProduct].intensity() == Approx(128.0/384.0));
+
+		const DynamicMatrix<double> c(5, 3), d(3, 2);
+		resetOperationTallies();
+		const DynamicMatrix<double> e = c*d;
+		(void)e;
+		REQUIRE(operationTallies()[AccountedOperation::MatrixProduct].flops == 2*5*3*2);
+
+		resetOperationTallies();
+		REQUIRE(operationTallies().total().calls == 0);
+		REQUIRE(operationTallies().total().flops == 0);
+	}
+
+	SECTION("Testing the report")
+	{
+		const Vector3<double> x(1, 2, 3), y(3, 2, 1);
+		resetOperationTallies();
+		const Vector3<double> z = Vector3<double>::crossProduct(x, y);
+		(void)z;
+
+		std::ostringstream report;
+		printOperationReport(report, operationTallies(), 1e-6);
+		REQUIRE(report.str().find("cross product") != std::string::npos);
+		REQUIRE(report.str().find("total") != std::string::npos);
+		REQUIRE(report.str().find("inverse") == std::string::npos);
+		REQUIRE(report.str().find("GFLOP/s") != std::string::npos);
+	}
+
+	SECTION("Comparing the tallies with the counted operations")
+	{
+		typedef CountingScalar<double> scalar;
+		typedef Matrix<scalar, 3, 3> mat3x3;
+		typedef Matrix<scalar, 4, 4> mat4x4;
+		typedef ColumnVector<scalar, 4> vec4;
+		typedef Vector3<scalar> vec3;
+		typedef Quaternion<scalar> quat;
+
+		const mat3x3 a{ 1., 2., 3., 4., 5., 6., 7., 8., 10. }, b(a);
+		const mat4x4 t{ 1., 0., 0., 0., 0., 0., 1., 0., 0., -1., 0., 0., 1., 2., 3., 1. };
+		const vec3 x(1., 2., 3.), y(-1., 0.5, 2.);
+		const vec4 u{ 1., 2., 3., 4. }, w{ 4., 3., 2., 1. };
+		const quat p(0.5, 0.5, 0.5, 0.5), q(0.8, 0., 0.6, 0.);
+		const scalar half(0.5);
+
+		checkAccountedFlops("a + 2*b", [&]() { const mat3x3 m = a + 2.0*b; (void)m; });
+		checkAccountedFlops("a*b", [&]() { const mat3x3 m = a*b; (void)m; });
+		checkAccountedFlops("(a + b)*b^T", [&]() { const mat3x3 m = (a + b)*b.transposed(); (void)m; });
+		checkAccountedFlops("a*x", [&]() { const vec3 m = a*x; (void)m; });
+		checkAccountedFlops("x^T*y", [&]() { const scalar d = x.transposed()*y; (void)d; });
+		checkAccountedFlops("m += b", [&]() { mat3x3 m(a); m += 2.0*b; });
+		checkAccountedFlops("m *= s", [&]() { mat3x3 m(a); m *= half; });
+		checkAccountedFlops("determinant", [&]() { const scalar d = a.determinant(); (void)d; });
+		checkAccountedFlops("inverse", [&]() { const mat3x3 m = a.inverse(); (void)m; });
+		checkAccountedFlops("inverse 4x4", [&]() { const mat4x4 m = t.inverse(); (void)m; });
+		checkAccountedFlops("affineInverse", [&]() { const mat4x4 m = t.affineInverse(); (void)m; });
+		checkAccountedFlops("rigidInverse", [&]() { const mat4x4 m = t.rigidInverse(); (void)m; });
+
+		checkAccountedFlops("ColumnVector::dotProduct", [&]() { const scalar d = vec4::dotProduct(u, w); (void)d; });
+		checkAccountedFlops("ColumnVector::norm", [&]() { const scalar d = u.norm(); (void)d; });
+		checkAccountedFlops("ColumnVector::normalized", [&]() { const vec4 m = u.normalized(); (void)m; });
+		checkAccountedFlops("Vector3::crossProduct", [&]() { const vec3 m = vec3::crossProduct(x, y); (void)m; });
+		checkAccountedFlops("Vector3::normSquared", [&]() { const scalar d = x.normSquared(); (void)d; });
+		checkAccountedFlops("Vector3::normalized", [&]() { const vec3 m = y.normalized(); (void)m; });
+
+		checkAccountedFlops("Quaternion product", [&]() { const quat m = p*q; (void)m; });
+		checkAccountedFlops("Quaternion compound product", [&]() { quat m(p); m *= q; });
+		checkAccountedFlops("Quaternion sum", [&]() { const quat m = p + q; (void)m; });
+		checkAccountedFlops("Quaternion difference", [&]() { const quat m = p - q; (void)m; });
+		checkAccountedFlops("Quaternion scale", [&]() { const quat m = half*q; (void)m; });
+		checkAccountedFlops("Quaternion::conjugated", [&]() { const quat m = q.conjugated(); (void)m; });
+		checkAccountedFlops("Quaternion::norm", [&]() { const scalar d = q.norm(); (void)d; });
+		checkAccountedFlops("Quaternion::normalized", [&]() { const quat m = q.normalized(); (void)m; });
+		checkAccountedFlops("Quaternion::normalize", [&]() { quat m(q); m.normalize(); });
+		checkAccountedFlops("Quaternion::inverse", [&]() { const quat m = q.inverse(); (void)m; });
+		checkAccountedFlops("Quaternion::invert", [&]() { quat m(q); m.invert(); });
+		checkAccountedFlops("Quaternion::log", [&]() { const quat m = quat::log(q); (void)m; });
+		checkAccountedFlops("Quaternion::exp", [&]() { const quat m = quat::exp(q); (void)m; });
+		checkAccountedFlops("Quaternion::pow", [&]() { const quat m = quat::pow(q, half); (void)m; });
+		checkAccountedFlops("Quaternion::composition", [&]() { const quat m = quat::composition(p, q); (void)m; });
+		checkAccountedFlops("Quaternion::difference", [&]() { const quat m = quat::difference(p, q); (void)m; });
+		checkAccountedFlops("Quaternion::slerp", [&]() { const quat m = quat::slerp(p, q, half); (void)m; });
+		checkAccountedFlops("Quaternion::transform", [&]() { const vec3 m = q.transform(x); (void)m; });
+		checkAccountedFlops("Quaternion::toMatrix", [&]() { const mat3x3 m = q.toMatrix(); (void)m; });
+	}
+}
@@ -0,0 +1,289 @@
+//	MIT License
+//
+//	Copyright (c) 2016 Fabian Lschner
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in all
+//	copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//	SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace benchmark {
+
+#if defined(__GNUC__)
+//! Forces the compiler to assume that value is read and modified, so computations producing it are not optimized away
+template<typename T>
+inline void doNotOptimize(T& value)
+{
+	asm volatile("" : "+m"(value) : : "memory");
+}
+
+//! Forces the compiler to assume that value is read, so computations producing it are not optimized away
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+	asm volatile("" : : "m"(value) : "memory");
+}
+
+//! Forces the compiler to assume that all memory is read and written at this point
+inline void clobberMemory()
+{
+	asm volatile("" : : : "memory");
+}
+#else
+namespace detail {
+//! Escapes a pointer to the optimizer by storing it in a volatile sink
+inline void escape(const volatile void* p)
+{
+	static const volatile void* volatile sink;
+	sink = p;
+}
+}
+
+//! Forces the compiler to assume that value is read, so computations producing it are not optimized away
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+	detail::escape(&value);
+	_ReadWriteBarrier();
+}
+
+//! Forces the compiler to assume that all memory is read and written at this point
+inline void clobberMemory()
+{
+	_ReadWriteBarrier();
+}
+#endif
+
+//! Summary statistics of the samples of a benchmark (all values in ns per operation)
+struct Statistics
+{
+	double min;
+	double max;
+	double mean;
+	double median;
+	double stddev;
+
+	//! Computes the statistics of the specified samples
+	static Statistics compute(std::vector<double> samples)
+	{
+		Statistics stats = {};
+		if(samples.empty()) return stats;
+
+		std::sort(samples.begin(), samples.end());
+		const size_t n = samples.size();
+		stats.min = samples.front();
+		stats.max = samples.back();
+		stats.median = (n % 2 == 1) ? samples[n/2] : 0.5*(samples[n/2 - 1] + samples[n/2]);
+
+		double sum = 0;
+		for(double s : samples) sum += s;
+		stats.mean = sum/double(n);
+
+		double squares = 0;
+		for(double s : samples) squares += (s - stats.mean)*(s - stats.mean);
+		stats.stddev = (n > 1) ? std::sqrt(squares/double(n - 1)) : 0.0;
+		return stats;
+	}
+};
+
+/**
+ * A single benchmark
+ *
+ * The body runs the benchmarked operation the specified number of times.
+ * Setup has to be done before the body is created or, for expensive setup
+ * that should only happen if the benchmark is selected, in the first call
+ * of the body (part of the warm up), so that only the operation itself is
+ * measured.
+ */
+struct Benchmark
+{
+	//! Name of the operation, e.g. "operator*"
+	std::string name;
+	//! Name of the scalar type
+	std::string type;
+	//! Problem size, e.g. the dimension of the matrices
+	size_t size;
+	//! Floating point operations of a single operation (0 if not meaningful)
+	double flops;
+	//! Runs the operation the specified number of times
+	std::function<void(size_t)> body;
+
+	//! Returns the full name of the benchmark used for filtering and reporting
+	std::string fullName() const { return name + "<" + type + ">/" + std::to_string(size); }
+};
+
+//! Result of a benchmark
+struct Result
+{
+	Benchmark benchmark;
+	//! Number of operations per sample
+	size_t iterations;
+	//! Number of samples
+	size_t repetitions;
+	//! Statistics of the time per operation in ns
+	Statistics nsPerOp;
+
+	//! Returns the time per floating point operation in ns (based on the median) or 0 if the flop count is unknown
+	double nsPerFlop() const { return (benchmark.flops > 0) ? nsPerOp.median/benchmark.flops : 0.0; }
+};
+
+//! Options of the benchmark runner
+struct Options
+{
+	//! Time spent running a benchmark before the measurement starts in seconds
+	double warmupTime = 0.05;
+	//! Minimum time of a single sample in seconds
+	double minSampleTime = 0.01;
+	//! Number of samples per benchmark
+	size_t repetitions = 10;
+	//! Only benchmarks whose full name contains this string are run
+	std::string filter;
+};
+
+/**
+ * Runs benchmarks and collects their results
+ *
+ * Every benchmark is warmed up first, then the number of iterations is
+ * increased until one sample takes at least Options::minSampleTime. Finally
+ * Options::repetitions samples with that number of iterations are measured.
+ */
+class Runner
+{
+public:
+	explicit Runner(const Options& options) : options_(options) {}
+
+	//! Returns whether the benchmark is selected by the filter of the options
+	bool selected(const Benchmark& benchmark) const
+	{
+		return options_.filter.empty() || (benchmark.fullName().find(options_.filter) != std::string::npos);
+	}
+
+	//! Runs the specified benchmark
+	Result run(const Benchmark& benchmark) const
+	{
+		size_t iterations = 1;
+		const auto warmupEnd = Clock::now() + toDuration(options_.warmupTime);
+		while(Clock::now() < warmupEnd) benchmark.body(iterations);
+
+		while(measure(benchmark, iterations) < options_.minSampleTime) iterations *= 2;
+
+		std::vector<double> samples;
+		for(size_t r = 0; r < options_.repetitions; r++) {
+			samples.push_back(1e9*measure(benchmark, iterations)/double(iterations));
+		}
+
+		Result result;
+		result.benchmark = benchmark;
+		result.iterations = iterations;
+		result.repetitions = options_.repetitions;
+		result.nsPerOp = Statistics::compute(samples);
+		return result;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Options options_;
+
+	static Clock::duration toDuration(double seconds)
+	{
+		return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	}
+
+	//! Returns the time in seconds of the specified number of iterations
+	static double measure(const Benchmark& benchmark, size_t iterations)
+	{
+		clobberMemory();
+		const auto start = Clock::now();
+		benchmark.body(iterations);
+		clobberMemory();
+		const auto end = Clock::now();
+		return std::chrono::duration<double>(end - start).count();
+	}
+};
+
+//! Prints the results as a table
+inline void printTable(std::ostream& os, const Result& result)
+{
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-44s %14.2f %14.2f %10.2f %%  %12.4f",
+		result.benchmark.fullName().c_str(), result.nsPerOp.median, result.nsPerOp.min,
+		(result.nsPerOp.mean > 0) ? 100.0*result.nsPerOp.stddev/result.nsPerOp.mean : 0.0, result.nsPerFlop());
+	os << line << std::endl;
+}
+
+//! Prints the header of the result table
+inline void printTableHeader(std::ostream& os)
+{
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-44s %14s %14s %12s  %12s", "benchmark", "median [ns]", "min [ns]", "stddev", "ns/FLOP");
+	os << line << std::endl;
+}
+
+//! Writes the results as JSON document
+inline void writeJson(std::ostream& os, const std::vector<Result>& results, const std::string& instructionSet)
+{
+	char number[64];
+	auto format = [&number](double value) -> const char* {
+		std::snprintf(number, sizeof(number), "%.6g", value);
+		return number;
+	};
+
+	os << "{\n";
+	os << "  \"instruction_set\": \"" << instructionSet << "\",\n";
+	os << "  \"benchmarks\": [\n";
+	for(size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		os << "    {";
+		os << "\"name\": \"" << r.benchmark.name << "\", ";
+		os << "\"type\": \"" << r.benchmark.type << "\", ";
+		os << "\"size\": " << r.benchmark.size << ", ";
+		os << "\"flops\": " << format(r.benchmark.flops) << ", ";
+		os << "\"iterations\": " << r.iterations << ", ";
+		os << "\"repetitions\": " << r.repetitions << ", ";
+		os << "\"ns_per_op\": {";
+		os << "\"median\": " << format(r.nsPerOp.median) << ", ";
+		os << "\"mean\": " << format(r.nsPerOp.mean) << ", ";
+		os << "\"min\": " << format(r.nsPerOp.min) << ", ";
+		os << "\"max\": " << format(r.nsPerOp.max) << ", ";
+		os << "\"stddev\": " << format(r.nsPerOp.stddev) << "}, ";
+		os << "\"ns_per_flop\": " << format(r.nsPerFlop());
+		os << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+	os << "  ]\n";
+	os << "}\n";
+}
+
+//! Returns all benchmarks of the library (see benchmarks.cpp)
+std::vector<Benchmark> createBenchmarks();
+
+}
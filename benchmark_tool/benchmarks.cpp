@@ -0,0 +1,548 @@
+//	MIT License
+//
+//	Copyright (c) 2016 Fabian Lschner
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in all
+//	copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//	SOFTWARE.
+
+#include "benchmark.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "vector3.h"
+#include "vector3_array.h"
+#include "quaternion.h"
+#include "dynamic_matrix.h"
+#include "matrix_view.h"
+#include "lu_decomposition.h"
+#include "cholesky_decomposition.h"
+#include "householder_qr.h"
+#include "symmetric_eigen_decomposition.h"
+#include "singular_value_decomposition.h"
+
+using namespace lin_algebra;
+using benchmark::Benchmark;
+using benchmark::doNotOptimize;
+
+namespace {
+
+//! List of problem sizes
+template<size_t ...sizes>
+struct SizeList {};
+
+//! Dimensions of the matrix and vector benchmarks
+typedef SizeList<2, 3, 4, 8, 16, 32, 64, 128, 256, 512> MatrixSizes;
+
+//! Dimensions of the parallel matrix product benchmarks
+const size_t parallelSizes[] = { 256, 512, 1024 };
+
+//! Numbers of points of the batched 3d benchmarks
+const size_t pointCounts[] = { 16, 256, 4096 };
+
+template<typename T>
+struct TypeName;
+
+template<>
+struct TypeName<float> { static const char* get() { return "float"; } };
+
+template<>
+struct TypeName<double> { static const char* get() { return "double"; } };
+
+//! Fills the entries with deterministic values in [-1, 1]
+template<typename T>
+void fillValues(T* entries, size_t count, size_t seed)
+{
+	for(size_t i = 0; i < count; i++) {
+		entries[i] = T(int((i*7919 + seed*104729) % 2001) - 1000)/T(1000);
+	}
+}
+
+//! Returns count normalized quaternions
+template<typename T>
+std::vector<Quaternion<T>> makeRotations(size_t count)
+{
+	std::vector<Quaternion<T>> rotations;
+	for(size_t i = 0; i < count; i++) {
+		const Vector3<T> axis(T(1), T(i % 7) - T(3), T(i % 5) + T(0.5));
+		rotations.push_back(Quaternion<T>::fromAxisAndAngle(axis.normalized(), T(0.01)*T(i % 314)));
+	}
+	return rotations;
+}
+
+//! Returns count points
+template<typename T>
+std::vector<Vector3<T>> makePoints(size_t count)
+{
+	std::vector<Vector3<T>> points(count);
+	fillValues(reinterpret_cast<T*>(points.data()), 3*count, 3);
+	for(Vector3<T>& p : points) p[0] += T(2);
+	return points;
+}
+
+template<typename T, size_t N>
+void addMatrixBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+	typedef Matrix<T,N,N> MatrixType;
+	typedef ColumnVector<T,N> VectorType;
+	const char* type = TypeName<T>::get();
+
+	// Large matrices don't fit on the stack
+	std::shared_ptr<MatrixType> a(new MatrixType), b(new MatrixType), c(new MatrixType);
+	fillValues(a->data(), N*N, 1);
+	fillValues(b->data(), N*N, 2);
+
+	benchmarks.push_back({ "operator*", type, N, 2.0*N*N*N, [a, b, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = (*a)*(*b);
+			doNotOptimize(*c);
+		}
+	}});
+
+	benchmarks.push_back({ "operator+", type, N, 2.0*N*N, [a, b, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = *a + T(2)*(*b);
+			doNotOptimize(*c);
+		}
+	}});
+
+	benchmarks.push_back({ "operator+=", type, N, 1.0*N*N, [a, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c += *a;
+			doNotOptimize(*c);
+		}
+	}});
+
+	benchmarks.push_back({ "transposed()", type, N, 0.0, [a, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = a->transposed();
+			doNotOptimize(*c);
+		}
+	}});
+
+	// The transposed view reads the left matrix row-major
+	benchmarks.push_back({ "operator*(transposed view)", type, N, 2.0*N*N*N, [a, b, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = ConstMatrixView<T,N,N>(*a).transposed()*(*b);
+			doNotOptimize(*c);
+		}
+	}});
+
+	// The transposed is not formed, gemm reads the entries of a with swapped strides
+	benchmarks.push_back({ "operator*(transposed)", type, N, 2.0*N*N*N, [a, b, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = a->transposed()*(*b);
+			doNotOptimize(*c);
+		}
+	}});
+
+	benchmarks.push_back({ "operator*(evaluated transposed)", type, N, 2.0*N*N*N, [a, b, c](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			*c = a->transposed().eval()*(*b);
+			doNotOptimize(*c);
+		}
+	}});
+
+	std::shared_ptr<DynamicMatrix<T>> da(new DynamicMatrix<T>(*a)), db(new DynamicMatrix<T>(*b)), dc(new DynamicMatrix<T>(N, N));
+	benchmarks.push_back({ "operator*(dynamic)", type, N, 2.0*N*N*N, [da, db, dc](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*da);
+			*dc = (*da)*(*db);
+			doNotOptimize(*dc);
+		}
+	}});
+
+	benchmarks.push_back({ "transposed(dynamic)", type, N, 0.0, [da, dc](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*da);
+			*dc = da->transposed();
+			doNotOptimize(*dc);
+		}
+	}});
+
+	std::shared_ptr<VectorType> v(new VectorType);
+	fillValues(v->data(), N, 4);
+	benchmarks.push_back({ "dotProduct()", type, N, 2.0*N, [v](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*v);
+			T d = VectorType::dotProduct(*v, *v);
+			doNotOptimize(d);
+		}
+	}});
+
+	benchmarks.push_back({ "normalize()", type, N, 3.0*N + 1, [v](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*v);
+			v->normalize();
+			doNotOptimize(*v);
+		}
+	}});
+
+	// Factorization and solve of a diagonally dominant system, large matrices are factorized on the heap
+	typedef typename std::conditional<(N >= 64), HeapStorage<64>, DenseStorage>::type LUStorage;
+	std::shared_ptr<Matrix<T,N,N,LUStorage>> s(new Matrix<T,N,N,LUStorage>);
+	for(size_t k = 0; k < N*N; k++) (*s)[k] = (*a)[k];
+	for(size_t k = 0; k < N; k++) (*s)(k,k) += T(N);
+	benchmarks.push_back({ "LUDecomposition::solve", type, N, 2.0/3.0*N*N*N + 2.0*N*N, [s, v](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*s);
+			const LUDecomposition<T,N,LUStorage> lu(*s);
+			VectorType x = lu.solve(*v);
+			doNotOptimize(x);
+		}
+	}});
+
+	// The lower triangle of s is diagonally dominant, i.e. it is the lower triangle of a positive definite matrix
+	benchmarks.push_back({ "CholeskyDecomposition::solve", type, N, 1.0/3.0*N*N*N + 2.0*N*N, [s, v](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*s);
+			const CholeskyDecomposition<T,N,LUStorage> cholesky(*s);
+			VectorType x = cholesky.solve(*v);
+			doNotOptimize(x);
+		}
+	}});
+}
+
+template<typename T, size_t ...sizes>
+void addMatrixBenchmarks(std::vector<Benchmark>& benchmarks, SizeList<sizes...>)
+{
+	const int expand[] = { (addMatrixBenchmarks<T,sizes>(benchmarks), 0)... };
+	(void)expand;
+}
+
+template<typename T>
+void addRotationBenchmarks(std::vector<Benchmark>& benchmarks, size_t count)
+{
+	typedef Vector3<T> VectorType;
+	typedef Quaternion<T> QuaternionType;
+	const char* type = TypeName<T>::get();
+
+	const QuaternionType q = makeRotations<T>(2)[1];
+	std::shared_ptr<std::vector<QuaternionType>> rotations(new std::vector<QuaternionType>(makeRotations<T>(count)));
+	std::shared_ptr<std::vector<VectorType>> in(new std::vector<VectorType>(makePoints<T>(count)));
+	std::shared_ptr<std::vector<VectorType>> out(new std::vector<VectorType>(count));
+
+	// A matrix-vector product has 15 FLOPs, the direct quaternion rotation 33 FLOPs
+	benchmarks.push_back({ "Quaternion::transform(scalar)", type, count, 15.0*count, [q, in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = q.transform((*in)[j]);
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ "Quaternion::transform(batch)", type, count, 15.0*count, [q, in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			q.transform(in->data(), out->data(), in->size());
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ "Quaternion::transform(stream,scalar)", type, count, 33.0*count, [rotations, in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = (*rotations)[j].transform((*in)[j]);
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ "Quaternion::transform(stream,batch)", type, count, 33.0*count, [rotations, in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			QuaternionType::transform(rotations->data(), in->data(), out->data(), in->size());
+			doNotOptimize(*out);
+		}
+	}});
+
+	std::shared_ptr<std::vector<Matrix<T,3,3>>> matrices(new std::vector<Matrix<T,3,3>>(count));
+	benchmarks.push_back({ "Quaternion::toMatrices", type, count, 0.0, [rotations, matrices](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*rotations);
+			QuaternionType::toMatrices(rotations->data(), matrices->data(), rotations->size());
+			doNotOptimize(*matrices);
+		}
+	}});
+
+	std::shared_ptr<std::vector<QuaternionType>> slerped(new std::vector<QuaternionType>(count));
+	benchmarks.push_back({ "Quaternion::slerp", type, count, 0.0, [rotations, slerped](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*rotations);
+			for(size_t j = 0; j + 1 < rotations->size(); j++) {
+				(*slerped)[j] = QuaternionType::slerp((*rotations)[j], (*rotations)[j + 1], T(0.3));
+			}
+			doNotOptimize(*slerped);
+		}
+	}});
+
+	// Normalization of 3d vectors: 6 multiplications, 2 additions, a square root and a division
+	benchmarks.push_back({ "Vector3::normalize(aos)", type, count, 10.0*count, [in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = (*in)[j].normalized();
+			doNotOptimize(*out);
+		}
+	}});
+
+	std::shared_ptr<Vector3Array<T>> soaIn(new Vector3Array<T>(*in)), soaOut(new Vector3Array<T>(count));
+	benchmarks.push_back({ "Vector3Array::normalize", type, count, 10.0*count, [soaIn, soaOut](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*soaIn);
+			*soaOut = *soaIn;
+			soaOut->normalize();
+			doNotOptimize(*soaOut);
+		}
+	}});
+}
+
+template<typename T, size_t N>
+void addInverseBenchmarks(std::vector<Benchmark>& benchmarks, size_t count)
+{
+	typedef Matrix<T,N,N> MatrixType;
+	const char* type = TypeName<T>::get();
+
+	std::shared_ptr<std::vector<MatrixType>> in(new std::vector<MatrixType>(count)), out(new std::vector<MatrixType>(count));
+	for(size_t i = 0; i < count; i++) {
+		fillValues((*in)[i].data(), N*N, i);
+		for(size_t k = 0; k < N; k++) (*in)[i](k,k) += T(N);
+	}
+
+	const std::string name = "inverse" + std::to_string(N) + "x" + std::to_string(N);
+	benchmarks.push_back({ name + "(scalar)", type, count, 0.0, [in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = (*in)[j].inverse();
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ name + "(batch)", type, count, 0.0, [in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			invertMatrices(in->data(), out->data(), in->size());
+			doNotOptimize(*out);
+		}
+	}});
+}
+
+template<typename T>
+void addEigenBenchmarks(std::vector<Benchmark>& benchmarks, size_t count)
+{
+	const char* type = TypeName<T>::get();
+
+	// Symmetric matrices in six streams (s00, s11, s22, s01, s02, s12) followed by the seven output streams
+	std::shared_ptr<std::vector<T>> streams(new std::vector<T>(13*count));
+	fillValues(streams->data(), 6*count, 1);
+	std::shared_ptr<std::vector<Matrix<T,3,3>>> in(new std::vector<Matrix<T,3,3>>(count));
+	std::shared_ptr<std::vector<Quaternion<T>>> out(new std::vector<Quaternion<T>>(count));
+	const size_t entries[6] = { 0, 4, 8, 1, 2, 5 };
+	for(size_t i = 0; i < count; i++) {
+		for(size_t k = 0; k < 6; k++) (*in)[i][entries[k]] = (*streams)[k*count + i];
+	}
+
+	benchmarks.push_back({ "eigen3x3(scalar)", type, count, 0.0, [in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = SymmetricEigenDecomposition3<T>((*in)[j]).rotation();
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ "eigen3x3(batch)", type, count, 0.0, [streams, count](size_t iterations) {
+		T* data = streams->data();
+		const T* tensors[6] = { data, data + count, data + 2*count, data + 3*count, data + 4*count, data + 5*count };
+		T* eigenvalues[3] = { data + 6*count, data + 7*count, data + 8*count };
+		T* rotations[4] = { data + 9*count, data + 10*count, data + 11*count, data + 12*count };
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*streams);
+			SymmetricEigenDecomposition3<T>::compute(tensors, eigenvalues, rotations, count);
+			doNotOptimize(*streams);
+		}
+	}});
+}
+
+template<typename T>
+void addSvdBenchmarks(std::vector<Benchmark>& benchmarks, size_t count)
+{
+	const char* type = TypeName<T>::get();
+
+	// Matrices in nine streams of the column-major entries followed by the eleven SVD output streams
+	std::shared_ptr<std::vector<T>> streams(new std::vector<T>(20*count));
+	fillValues(streams->data(), 9*count, 1);
+	std::shared_ptr<std::vector<Matrix<T,3,3>>> in(new std::vector<Matrix<T,3,3>>(count));
+	std::shared_ptr<std::vector<Quaternion<T>>> out(new std::vector<Quaternion<T>>(count));
+	for(size_t i = 0; i < count; i++) {
+		for(size_t k = 0; k < 9; k++) (*in)[i][k] = (*streams)[k*count + i];
+	}
+
+	benchmarks.push_back({ "svd3x3(scalar)", type, count, 0.0, [in, out](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*in);
+			for(size_t j = 0; j < in->size(); j++) (*out)[j] = SingularValueDecomposition3<T>((*in)[j]).rotationU();
+			doNotOptimize(*out);
+		}
+	}});
+
+	benchmarks.push_back({ "svd3x3(batch)", type, count, 0.0, [streams, count](size_t iterations) {
+		T* data = streams->data();
+		const T* matrices[9];
+		T* results[11];
+		for(size_t k = 0; k < 9; k++) matrices[k] = data + k*count;
+		for(size_t k = 0; k < 11; k++) results[k] = data + (9 + k)*count;
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*streams);
+			SingularValueDecomposition3<T>::compute(matrices, results, results + 4, results + 7, count);
+			doNotOptimize(*streams);
+		}
+	}});
+
+	benchmarks.push_back({ "polar3x3(batch)", type, count, 0.0, [streams, count](size_t iterations) {
+		T* data = streams->data();
+		const T* matrices[9];
+		T* results[10];
+		for(size_t k = 0; k < 9; k++) matrices[k] = data + k*count;
+		for(size_t k = 0; k < 10; k++) results[k] = data + (9 + k)*count;
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*streams);
+			PolarDecomposition3<T>::compute(matrices, results, results + 4, count);
+			doNotOptimize(*streams);
+		}
+	}});
+}
+
+//! Returns the thread counts of the scaling benchmarks (powers of two up to the number of hardware threads)
+std::vector<size_t> threadCounts()
+{
+	const size_t hardwareThreads = (std::thread::hardware_concurrency() > 0) ? std::thread::hardware_concurrency() : 1;
+	std::vector<size_t> counts;
+	for(size_t count = 1; count < hardwareThreads; count *= 2) counts.push_back(count);
+	counts.push_back(hardwareThreads);
+	return counts;
+}
+
+//! Operands of the parallel products of one size
+template<typename T>
+struct ProductOperands
+{
+	DynamicMatrix<T> a, b, c;
+
+	explicit ProductOperands(size_t n) : a(n, n), b(n, n), c(n, n)
+	{
+		fillValues(a.data(), n*n, 1);
+		fillValues(b.data(), n*n, 2);
+	}
+};
+
+//! Returns the operands of the parallel products of size n, allocated when the first benchmark of that size runs
+template<typename T>
+ProductOperands<T>& productOperands(size_t n)
+{
+	static std::unique_ptr<ProductOperands<T>> operands;
+	if(!operands || operands->a.rows() != n) operands.reset(new ProductOperands<T>(n));
+	return *operands;
+}
+
+//! Returns the pool of the parallel products, every benchmark resizes it to its thread count
+ThreadPool& productPool()
+{
+	static ThreadPool pool(1);
+	return pool;
+}
+
+template<typename T>
+void addParallelBenchmarks(std::vector<Benchmark>& benchmarks, size_t n)
+{
+	const char* type = TypeName<T>::get();
+
+	// The same product on pools of increasing size gives the scaling curve of the parallel kernel. The pool
+	// and the operands are only created when a benchmark runs (in its warm up), not when it is registered.
+	for(size_t threads : threadCounts()) {
+		benchmarks.push_back({ "operator*(threads=" + std::to_string(threads) + ")", type, n, 2.0*n*n*n, [n, threads](size_t iterations) {
+			ProductOperands<T>& operands = productOperands<T>(n);
+			ThreadPool& pool = productPool();
+			if(pool.threadCount() != threads) pool.resize(threads);
+			for(size_t i = 0; i < iterations; i++) {
+				doNotOptimize(operands.a);
+				detail::gemmParallel(n, n, n, operands.a.data(), 1, n, operands.b.data(), 1, n, operands.c.data(), n, pool);
+				doNotOptimize(operands.c);
+			}
+		}});
+	}
+}
+
+template<typename T, size_t M, size_t N>
+void addLeastSquaresBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+	const char* type = TypeName<T>::get();
+
+	// Fit of a tall design matrix, factorized on the heap
+	std::shared_ptr<Matrix<T,M,N,HeapStorage<64>>> a(new Matrix<T,M,N,HeapStorage<64>>);
+	std::shared_ptr<Matrix<T,M,1,HeapStorage<64>>> b(new Matrix<T,M,1,HeapStorage<64>>);
+	fillValues(a->data(), M*N, 1);
+	fillValues(b->data(), M, 2);
+	benchmarks.push_back({ "leastSquares(" + std::to_string(M) + "x" + std::to_string(N) + ")", type, N, 2.0*M*N*N - 2.0/3.0*N*N*N + 4.0*M*N, [a, b](size_t iterations) {
+		for(size_t i = 0; i < iterations; i++) {
+			doNotOptimize(*a);
+			Matrix<T,N,1,HeapStorage<64>> x = leastSquares(*a, *b);
+			doNotOptimize(x);
+		}
+	}});
+}
+
+template<typename T>
+void addBenchmarks(std::vector<Benchmark>& benchmarks)
+{
+	addMatrixBenchmarks<T>(benchmarks, MatrixSizes());
+	for(size_t n : parallelSizes) addParallelBenchmarks<T>(benchmarks, n);
+	for(size_t count : pointCounts) addRotationBenchmarks<T>(benchmarks, count);
+	for(size_t count : pointCounts) {
+		addInverseBenchmarks<T,2>(benchmarks, count);
+		addInverseBenchmarks<T,3>(benchmarks, count);
+		addInverseBenchmarks<T,4>(benchmarks, count);
+		addEigenBenchmarks<T>(benchmarks, count);
+		addSvdBenchmarks<T>(benchmarks, count);
+	}
+	addLeastSquaresBenchmarks<T,10000,6>(benchmarks);
+	addLeastSquaresBenchmarks<T,1000,100>(benchmarks);
+}
+
+}
+
+namespace benchmark {
+
+std::vector<Benchmark> createBenchmarks()
+{
+	std::vector<Benchmark> benchmarks;
+	addBenchmarks<float>(benchmarks);
+	addBenchmarks<double>(benchmarks);
+	return benchmarks;
+}
+
+}
@@ -0,0 +1,107 @@
+//	MIT License
+//
+//	Copyright (c) 2016 Fabian Lschner
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in all
+//	copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//	SOFTWARE.
+
+#include "benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cpu_dispatch.h"
+
+namespace {
+
+void printUsage(const char* program)
+{
+	std::cout << "Usage: " << program << " [options]\n"
+		<< "  --filter <text>       Only run benchmarks whose name contains text\n"
+		<< "  --json <file>         Write the results as JSON to file\n"
+		<< "  --repetitions <n>     Number of samples per benchmark (default 10)\n"
+		<< "  --min-time <seconds>  Minimum time per sample (default 0.01)\n"
+		<< "  --warmup <seconds>    Warmup time per benchmark (default 0.05)\n"
+		<< "  --list                List the benchmarks without running them\n";
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+	benchmark::Options options;
+	std::string jsonFile;
+	bool listOnly = false;
+
+	for(int i = 1; i < argc; i++) {
+		const bool hasValue = (i + 1 < argc);
+		if(std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+			options.filter = argv[++i];
+		} else if(std::strcmp(argv[i], "--json") == 0 && hasValue) {
+			jsonFile = argv[++i];
+		} else if(std::strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+			options.repetitions = size_t(std::atoi(argv[++i]));
+		} else if(std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+			options.minSampleTime = std::atof(argv[++i]);
+		} else if(std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+			options.warmupTime = std::atof(argv[++i]);
+		} else if(std::strcmp(argv[i], "--list") == 0) {
+			listOnly = true;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	if(options.repetitions == 0) options.repetitions = 1;
+
+	const benchmark::Runner runner(options);
+	const std::vector<benchmark::Benchmark> benchmarks = benchmark::createBenchmarks();
+	const char* instructionSet = lin_algebra::simd::instructionSetName(lin_algebra::simd::runtimeInstructionSet());
+
+	if(listOnly) {
+		for(const auto& b : benchmarks) {
+			if(runner.selected(b)) std::cout << b.fullName() << "\n";
+		}
+		return 0;
+	}
+
+	std::cout << "Instruction set: " << instructionSet << "\n\n";
+	benchmark::printTableHeader(std::cout);
+
+	std::vector<benchmark::Result> results;
+	for(const auto& b : benchmarks) {
+		if(!runner.selected(b)) continue;
+		results.push_back(runner.run(b));
+		benchmark::printTable(std::cout, results.back());
+	}
+
+	if(!jsonFile.empty()) {
+		std::ofstream file(jsonFile);
+		if(!file) {
+			std::cerr << "Could not open " << jsonFile << "\n";
+			return 1;
+		}
+		benchmark::writeJson(file, results, instructionSet);
+	}
+
+	return 0;
+}
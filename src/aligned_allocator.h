@@ -0,0 +1,94 @@
+/*
+	linear_algebra_containers/aligned_allocator header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * @brief Allocate memory with the specified alignment
+ *
+ * Over-allocates with operator new and stores the original pointer in front
+ * of the aligned block (operator new only supports extended alignments since
+ * C++17). Throws std::bad_alloc on failure. The memory has to be released
+ * with alignedFree.
+ */
+inline void* alignedAllocate(size_t size, size_t alignment)
+{
+	void* raw = ::operator new(size + alignment + sizeof(void*));
+	const std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~std::uintptr_t(alignment - 1);
+	reinterpret_cast<void**>(aligned)[-1] = raw;
+	return reinterpret_cast<void*>(aligned);
+}
+
+//! Releases memory allocated with alignedAllocate
+inline void alignedFree(void* ptr)
+{
+	if(ptr) ::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+}
+
+}
+
+/**
+ * Allocator for standard containers returning memory with the specified alignment
+ *
+ * @tparam T Type of the allocated objects.
+ * @tparam alignment Alignment in bytes, a power of two.
+ */
+template<typename T, size_t alignment>
+class AlignedAllocator
+{
+	static_assert((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef AlignedAllocator<U,alignment> other;
+	};
+
+	AlignedAllocator() = default;
+
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U,alignment>&) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(detail::alignedAllocate(count*sizeof(T), alignment)); }
+	void deallocate(T* ptr, size_t) { detail::alignedFree(ptr); }
+
+	template<typename U>
+	friend bool operator==(const AlignedAllocator&, const AlignedAllocator<U,alignment>&) { return true; }
+	template<typename U>
+	friend bool operator!=(const AlignedAllocator&, const AlignedAllocator<U,alignment>&) { return false; }
+};
+
+}
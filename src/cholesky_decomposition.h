@@ -0,0 +1,132 @@
+/*
+	linear_algebra_containers/cholesky_decomposition header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "cholesky_kernels.h"
+#include "triangular_kernels.h"
+
+namespace lin_algebra {
+
+/**
+ * Cholesky decomposition of a symmetric positive definite matrix
+ *
+ * Factorizes a symmetric positive definite [n x n] matrix A into A = L*L^T
+ * with a lower triangular matrix L, which takes half of the operations of
+ * the LUDecomposition and doesn't pivot. Only the lower triangle of A is
+ * read, L is computed in place in the lower triangle of a copy of the matrix
+ * (the upper triangle keeps the entries of A). Matrices with up to 12 rows
+ * are factorized by unrolled code, matrices with at least 64 rows by a
+ * blocked algorithm whose updates are computed by the cache blocked matrix
+ * product (see cholesky_kernels.h). Once computed, the factorization solves
+ * A*X = B for any number of right-hand sides.
+ *
+ * @tparam T Type of the entries.
+ * @tparam n Dimension of the matrix.
+ * @tparam Storage Storage policy of the factorized matrix, see storage.h.
+ */
+template<typename T, size_t n, typename Storage = DenseStorage>
+class CholeskyDecomposition
+{
+public:
+	//! Type of the factorized matrix
+	typedef Matrix<T,n,n,Storage> MatrixType;
+
+private:
+	MatrixType l_;
+	bool positiveDefinite_;
+
+public:
+	//! Computes the decomposition of the specified matrix (only its lower triangle is read)
+	explicit CholeskyDecomposition(const MatrixType& matrix)
+		: l_(matrix)
+	{
+		factorize();
+	}
+
+	//! Computes the decomposition in the entries of the specified expiring matrix
+	explicit CholeskyDecomposition(MatrixType&& matrix)
+		: l_(std::move(matrix))
+	{
+		factorize();
+	}
+
+	/**
+	 * @brief Returns the factor L
+	 *
+	 * L is stored in the lower triangle including the diagonal, the entries
+	 * above the diagonal are the entries of the factorized matrix.
+	 */
+	const MatrixType& matrixL() const { return l_; }
+
+	//! Returns false if the factorization failed because the matrix is not positive definite
+	bool isPositiveDefinite() const { return positiveDefinite_; }
+
+	//! Returns the determinant of the factorized matrix
+	T determinant() const
+	{
+		T result(1);
+		for(size_t i = 0; i < n; i++) result *= l_(i,i);
+		return result*result;
+	}
+
+	/**
+	 * @brief Solve the linear system for the specified right-hand sides
+	 *
+	 * Returns the solution X of A*X = B for the k columns of B by a forward
+	 * substitution with L and a back substitution with L^T. The matrix must
+	 * be positive definite.
+	 */
+	template<size_t k, typename RhsStorage>
+	Matrix<T,n,k,RhsStorage> solve(const Matrix<T,n,k,RhsStorage>& rhs) const
+	{
+		Matrix<T,n,k,RhsStorage> result(rhs);
+		solveInPlace(result);
+		return result;
+	}
+
+	//! Overwrites the right-hand sides B with the solution X of A*X = B (see solve())
+	template<size_t k, typename RhsStorage>
+	void solveInPlace(Matrix<T,n,k,RhsStorage>& rhs) const
+	{
+		typedef Matrix<T,n,k,RhsStorage> RhsType;
+		const size_t ld = MatrixType::leading_dimension;
+		detail::solveLower(n, k, l_.data(), ld, rhs.data(), RhsType::leading_dimension, false);
+		detail::solveLowerTransposed(n, k, l_.data(), ld, rhs.data(), RhsType::leading_dimension, false);
+	}
+
+private:
+	void factorize()
+	{
+		positiveDefinite_ = detail::choleskyFactorize<T,n>(l_.data(), MatrixType::leading_dimension);
+	}
+};
+
+}
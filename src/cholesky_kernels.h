@@ -0,0 +1,239 @@
+/*
+	linear_algebra_containers/cholesky_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "triangular_kernels.h"
+
+// Largest dimension of the matrices factorized by the unrolled Cholesky kernel
+#ifndef LIN_ALGEBRA_UNROLL_MAX_CHOLESKY
+	#define LIN_ALGEBRA_UNROLL_MAX_CHOLESKY 12
+#endif
+
+// Smallest dimension of the matrices factorized by the blocked Cholesky kernel
+#ifndef LIN_ALGEBRA_BLOCKED_CHOLESKY_MIN
+	#define LIN_ALGEBRA_BLOCKED_CHOLESKY_MIN 64
+#endif
+
+namespace lin_algebra {
+namespace detail {
+
+//! Evaluates to true if n x n matrices are factorized by UnrolledCholesky
+template<size_t n>
+struct IsUnrolledCholesky : std::integral_constant<bool, (n <= LIN_ALGEBRA_UNROLL_MAX_CHOLESKY)> {};
+
+/**
+ * @brief Cholesky decomposition of a symmetric positive definite matrix
+ *
+ * Overwrites the lower triangle of the column-major [n x n] matrix a with
+ * the lower triangular L of a = L*L^T. Only the lower triangle of a is read
+ * and written. Every step scales a column and updates the lower triangle of
+ * the trailing matrix column by column (unit stride). Stops and returns false
+ * if a diagonal entry is not positive, i.e. the matrix is not positive
+ * definite.
+ */
+template<typename T>
+inline bool choleskyUnblocked(size_t n, T* a, size_t lda)
+{
+	using std::sqrt;
+	for(size_t k = 0; k < n; k++) {
+		T* ak = a + k*lda;
+		if(!(ak[k] > T(0))) return false;
+		ak[k] = sqrt(ak[k]);
+		const T reciprocal = T(1)/ak[k];
+		for(size_t i = k + 1; i < n; i++) ak[i] *= reciprocal;
+		for(size_t j = k + 1; j < n; j++) {
+			T* aj = a + j*lda;
+			const T ljk = ak[j];
+			for(size_t i = j; i < n; i++) aj[i] -= ak[i]*ljk;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Solve for the panel below a diagonal block
+ *
+ * Overwrites the column-major [m x n] matrix b with the solution x of
+ * x*l^T = b, where l is the lower triangle of the column-major [n x n]
+ * matrix l, i.e. the block of L below the factorized diagonal block l.
+ */
+template<typename T>
+inline void choleskySolvePanel(size_t m, size_t n, const T* l, size_t ldl, T* b, size_t ldb)
+{
+	for(size_t j = 0; j < n; j++) {
+		T* bj = b + j*ldb;
+		for(size_t k = 0; k < j; k++) {
+			const T* bk = b + k*ldb;
+			const T ljk = l[j + k*ldl];
+			for(size_t i = 0; i < m; i++) bj[i] -= bk[i]*ljk;
+		}
+		const T reciprocal = T(1)/l[j + j*ldl];
+		for(size_t i = 0; i < m; i++) bj[i] *= reciprocal;
+	}
+}
+
+/**
+ * @brief Blocked right-looking Cholesky decomposition
+ *
+ * Computes the same factorization as choleskyUnblocked in steps of
+ * triangular_block_size columns: the diagonal block is factorized by
+ * choleskyUnblocked, the panel below it by choleskySolvePanel and the lower
+ * triangle of the trailing matrix is updated one block column at a time.
+ * The part of a block column below its diagonal block is updated with
+ * subtractProduct on the cache blocked gemm kernel, the diagonal block
+ * itself with a loop that only writes its lower triangle.
+ */
+template<typename T>
+inline bool choleskyBlocked(size_t n, T* a, size_t lda)
+{
+	for(size_t j = 0; j < n; j += triangular_block_size) {
+		const size_t nb = (n - j < triangular_block_size) ? n - j : triangular_block_size;
+		const size_t next = j + nb;
+		if(!choleskyUnblocked(nb, a + j + j*lda, lda)) return false;
+		if(next == n) break;
+
+		choleskySolvePanel(n - next, nb, a + j + j*lda, lda, a + next + j*lda, lda);
+		for(size_t c = next; c < n; c += triangular_block_size) {
+			const size_t cb = (n - c < triangular_block_size) ? n - c : triangular_block_size;
+			for(size_t k = 0; k < nb; k++) {
+				const T* lk = a + (j + k)*lda;
+				for(size_t jj = c; jj < c + cb; jj++) {
+					T* ajj = a + jj*lda;
+					const T ljk = lk[jj];
+					for(size_t ii = jj; ii < c + cb; ii++) ajj[ii] -= lk[ii]*ljk;
+				}
+			}
+			// Rows of the panel below the diagonal block times the transposed rows c, ..., c + cb - 1 of the panel
+			subtractProduct(n - c - cb, nb, cb, a + c + cb + j*lda, 1, lda, a + c + j*lda, lda, 1, a + c + cb + c*lda, lda);
+		}
+	}
+	return true;
+}
+
+//! Returns the column of the e-th entry of the lower triangle of a [m x m] matrix (entries numbered column by column)
+constexpr size_t lowerTriangleColumn(size_t e, size_t m)
+{
+	size_t j = 0;
+	while(e >= m - j) {
+		e -= m - j;
+		j++;
+	}
+	return j;
+}
+
+//! Returns the row of the e-th entry of the lower triangle of a [m x m] matrix (entries numbered column by column)
+constexpr size_t lowerTriangleRow(size_t e, size_t m)
+{
+	size_t j = 0;
+	while(e >= m - j) {
+		e -= m - j;
+		j++;
+	}
+	return j + e;
+}
+
+/**
+ * @brief Cholesky decomposition of small matrices with compile-time dimension
+ *
+ * Computes the same factorization as choleskyUnblocked. Every step is
+ * expanded from index sequences over the rows below the diagonal and over
+ * the entries of the lower triangle of the trailing matrix, so the kernel is
+ * straight-line code without loops.
+ */
+template<typename T, size_t n, size_t k = 0, bool last = (k == n)>
+struct UnrolledCholesky
+{
+	static bool run(T* a, size_t lda)
+	{
+		constexpr size_t rest = n - k - 1;
+		return step(a, lda, std::make_index_sequence<rest>(), std::make_index_sequence<rest*(rest + 1)/2>())
+			&& UnrolledCholesky<T,n,k + 1>::run(a, lda);
+	}
+
+private:
+	template<size_t e>
+	struct Row : std::integral_constant<size_t, k + 1 + lowerTriangleRow(e, n - k - 1)> {};
+	template<size_t e>
+	struct Column : std::integral_constant<size_t, k + 1 + lowerTriangleColumn(e, n - k - 1)> {};
+
+	template<size_t ...I, size_t ...E>
+	static bool step(T* a, size_t lda, std::index_sequence<I...>, std::index_sequence<E...>)
+	{
+		using std::sqrt;
+		T* ak = a + k*lda;
+		if(!(ak[k] > T(0))) return false;
+		ak[k] = sqrt(ak[k]);
+		const T reciprocal = T(1)/ak[k];
+		const int scale[] = { 0, ((void)(ak[k + 1 + I] *= reciprocal), 0)... };
+		(void)scale;
+		(void)reciprocal;
+		const int update[] = { 0, ((void)(a[Row<E>::value + Column<E>::value*lda] -= ak[Row<E>::value]*ak[Column<E>::value]), 0)... };
+		(void)update;
+		return true;
+	}
+};
+
+template<typename T, size_t n, size_t k>
+struct UnrolledCholesky<T,n,k,true>
+{
+	static bool run(T*, size_t) { return true; }
+};
+
+template<typename T, size_t n>
+inline bool choleskyFactorize(T* a, size_t lda, std::true_type)
+{
+	return UnrolledCholesky<T,n>::run(a, lda);
+}
+
+template<typename T, size_t n>
+inline bool choleskyFactorize(T* a, size_t lda, std::false_type)
+{
+	if(n >= LIN_ALGEBRA_BLOCKED_CHOLESKY_MIN) return choleskyBlocked(n, a, lda);
+	return choleskyUnblocked(n, a, lda);
+}
+
+/**
+ * @brief Cholesky decomposition of a matrix with compile-time dimension
+ *
+ * Overwrites the lower triangle of the column-major [n x n] matrix a with L
+ * (see choleskyUnblocked). Matrices with up to LIN_ALGEBRA_UNROLL_MAX_CHOLESKY
+ * rows are factorized by UnrolledCholesky, matrices with at least
+ * LIN_ALGEBRA_BLOCKED_CHOLESKY_MIN rows by choleskyBlocked. Returns false if
+ * the matrix is not positive definite.
+ */
+template<typename T, size_t n>
+inline bool choleskyFactorize(T* a, size_t lda)
+{
+	return choleskyFactorize<T,n>(a, lda, IsUnrolledCholesky<n>());
+}
+
+}
+}
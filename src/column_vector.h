@@ -26,9 +26,11 @@
 #pragma once
 
 #include <cmath>
+#include <type_traits>
 
 #include "matrixbase.h"
 #include "matrix.h"
+#include "matrix_expression.h"
 
 namespace lin_algebra {
 
@@ -43,17 +45,18 @@ namespace lin_algebra {
  * @tparam T Type used for the entries of the vector. Must support basic
  * aritmethic operations.
  * @tparam dim Number of Matrix::rows of the vector.
+ * @tparam Storage Storage policy of the entries, see storage.h.
  */
-template<class T, size_t dim>
-class Matrix<T,dim,1> : public MatrixBase<T,dim,1>
+template<class T, size_t dim, typename Storage>
+class Matrix<T,dim,1,Storage> : public MatrixBase<T,dim,1,Storage>
 {
 private:
-	typedef MatrixBase<T,dim,1> MatrixBaseType;
+	typedef MatrixBase<T,dim,1,Storage> MatrixBaseType;
 
 public:
 	//! Type of this vector
-	typedef Matrix<T,dim,1> VectorType;
-	//! Type of the transposed vector
+	typedef Matrix<T,dim,1,Storage> VectorType;
+	//! Type of the evaluated transposed vector
 	typedef Matrix<T,1,dim> TransposedVectorType;
 
 	/**
@@ -62,12 +65,28 @@ public:
 	 * Constructs a vector either without initilization or a parameter pack
 	 * for initialization depending on the arguments of the constructor.
 	 */
-	template<typename ...Ts>
-	Matrix(Ts... values)
+	template<typename ...Ts, typename = typename std::enable_if<IsEntryList<Ts...>::value>::type>
+	constexpr Matrix(Ts... values)
 		: MatrixBaseType(values...)
 	{
 	}
 
+	//! Constructs a vector by evaluating the specified matrix expression
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,dim,1>::value>::type>
+	constexpr Matrix(const E& expr)
+		: MatrixBaseType(detail::UninitializedTag())
+	{
+		this->assign(expr);
+	}
+
+	//! Assigns the result of the specified matrix expression to this vector
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,dim,1>::value>::type>
+	VectorType& operator=(const E& expr)
+	{
+		this->assignAliased(expr);
+		return *this;
+	}
+
 	/**
 	 * @brief Calculate the inner product
 	 *
@@ -79,11 +98,8 @@ public:
 	 */
 	static T dotProduct(const VectorType& v1, const VectorType& v2)
 	{
-		T product{T(0)};
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			product += v1[i]*v2[i];
-		}
-		return product;
+		const detail::OperationScope<T> scope(AccountedOperation::InnerProduct, 2*dim, 2*dim);
+		return detail::DotKernel<T,dim>::dot(v1.data(), v2.data(), dim);
 	}
 
 	/**
@@ -95,11 +111,8 @@ public:
 	 */
 	T normSquared() const
 	{
-		T norm{T(0)};
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			norm += this->entries_[i]*this->entries_[i];
-		}
-		return norm;
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, 2*dim, dim);
+		return detail::DotKernel<T,dim>::dot(this->entries_.data(), this->entries_.data(), dim);
 	}
 
 	/**
@@ -111,6 +124,7 @@ public:
 	T norm() const
 	{
 		using std::sqrt;
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, 2*dim + 1, dim);
 		return sqrt(this->normSquared());
 	}
 
@@ -122,6 +136,8 @@ public:
 	 */
 	VectorType& normalize()
 	{
+		// The norm, its reciprocal and the scaling
+		const detail::OperationScope<T> scope(AccountedOperation::Normalize, 3*dim + 2, 2*dim);
 		(*this) *= (1/norm());
 		return *this;
 	}
@@ -139,76 +155,35 @@ public:
 		return copy;
 	}
 
-	//! Returns the transposed vector
-	TransposedVectorType transposed() const
+	//! Returns the transposed vector (an expression referring to this vector, see TransposeExpression)
+	constexpr TransposeExpression<VectorType> transposed() const
 	{
-		return TransposedVectorType{this->entries_};
+		return TransposeExpression<VectorType>(*this);
 	}
 
 	//! Adds the right vector to the left.
-	VectorType operator+=(const VectorType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,dim,1>::value>::type>
+	VectorType& operator+=(const E& rhs)
 	{
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			this->entries_[i] += rhs.entries_[i];
-		}
+		this->addAssign(rhs);
 		return *this;
 	}
 
 	//! Substracts the right vector from the left.
-	VectorType operator-=(const VectorType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,dim,1>::value>::type>
+	VectorType& operator-=(const E& rhs)
 	{
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			this->entries_[i] -= rhs.entries_[i];
-		}
+		this->subtractAssign(rhs);
 		return *this;
 	}
 
 	//! Scales the vector by the specified factor.
-	VectorType operator*=(double factor)
+	template<typename S, typename = typename std::enable_if<IsScalarFor<S,VectorType>::value>::type>
+	VectorType& operator*=(const S& factor)
 	{
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			this->entries_[i] *= factor;
-		}
+		this->scaleAssign(factor);
 		return *this;
 	}
-
-	//! Returns the vector scaled by the specified factor.
-	friend VectorType operator*(const VectorType& mat, double factor)
-	{
-		VectorType result(mat);
-		result *= factor;
-		return result;
-	}
-
-	//! Returns the vector scaled by the specified factor.
-	friend VectorType operator*(double factor, const VectorType& mat)
-	{
-		VectorType result(mat);
-		result *= factor;
-		return result;
-	}
-
-	//! Returns the sum of the two matrices. Vector dimensions must agree.
-	friend VectorType operator+(const VectorType& lhs, const VectorType& rhs)
-	{
-		VectorType result(lhs);
-		result += rhs;
-		return result;
-	}
-
-	//! Returns the difference of the two matrices. Vector dimensions must agree.
-	friend VectorType operator-(const VectorType& lhs, const VectorType& rhs)
-	{
-		VectorType result(lhs);
-		result -= rhs;
-		return result;
-	}
-
-	//! Returns the negated vector.
-	friend VectorType operator-(const VectorType& in)
-	{
-		return T(-1)*VectorType(in);
-	}
 };
 
 //! Column vector template alias
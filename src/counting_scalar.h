@@ -0,0 +1,200 @@
+/*
+	linear_algebra_containers/counting_scalar header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+
+namespace lin_algebra {
+
+/**
+ * Numbers of operations performed on CountingScalar values
+ *
+ * Constructions count the default constructions and the conversions from
+ * other types, copies and moves count both constructions and assignments.
+ * Additions include subtractions and negations, functions count the calls
+ * of sqrt, abs, the exponential, logarithmic and trigonometric functions.
+ */
+struct OperationCounts
+{
+	size_t constructions = 0;
+	size_t copies = 0;
+	size_t moves = 0;
+	size_t additions = 0;
+	size_t multiplications = 0;
+	size_t divisions = 0;
+	size_t functions = 0;
+
+	//! Returns the number of values that were created or overwritten (constructions, copies and moves)
+	size_t temporaries() const { return constructions + copies + moves; }
+	//! Returns the number of arithmetic operations (additions, multiplications, divisions and functions)
+	size_t arithmetic() const { return additions + multiplications + divisions + functions; }
+
+	//! Returns the operations performed between the other counts and these counts
+	friend OperationCounts operator-(const OperationCounts& lhs, const OperationCounts& rhs)
+	{
+		OperationCounts result;
+		result.constructions = lhs.constructions - rhs.constructions;
+		result.copies = lhs.copies - rhs.copies;
+		result.moves = lhs.moves - rhs.moves;
+		result.additions = lhs.additions - rhs.additions;
+		result.multiplications = lhs.multiplications - rhs.multiplications;
+		result.divisions = lhs.divisions - rhs.divisions;
+		result.functions = lhs.functions - rhs.functions;
+		return result;
+	}
+
+	friend bool operator==(const OperationCounts& lhs, const OperationCounts& rhs)
+	{
+		return lhs.constructions == rhs.constructions && lhs.copies == rhs.copies && lhs.moves == rhs.moves
+			&& lhs.additions == rhs.additions && lhs.multiplications == rhs.multiplications
+			&& lhs.divisions == rhs.divisions && lhs.functions == rhs.functions;
+	}
+
+	friend bool operator!=(const OperationCounts& lhs, const OperationCounts& rhs) { return !(lhs == rhs); }
+};
+
+//! Prints the operation counts to the specified stream
+inline std::ostream& operator<<(std::ostream& os, const OperationCounts& counts)
+{
+	os << "{constructions: " << counts.constructions << ", copies: " << counts.copies << ", moves: " << counts.moves
+		<< ", additions: " << counts.additions << ", multiplications: " << counts.multiplications
+		<< ", divisions: " << counts.divisions << ", functions: " << counts.functions << "}";
+	return os;
+}
+
+namespace detail {
+
+//! Returns the operations performed on CountingScalar values by the calling thread since it was started
+inline OperationCounts& operationCounts()
+{
+	static thread_local OperationCounts counts;
+	return counts;
+}
+
+}
+
+/**
+ * Counts the operations performed on CountingScalar values in a scope
+ *
+ * Records the counts of the calling thread on construction, counts()
+ * returns the operations performed by the thread since then. Counters can be
+ * nested, e.g. a test can measure a single operation inside of a loop.
+ */
+class OperationCounter
+{
+private:
+	OperationCounts start_;
+
+public:
+	OperationCounter()
+		: start_(detail::operationCounts())
+	{
+	}
+
+	//! Returns the operations performed since the construction or the last reset()
+	OperationCounts counts() const { return detail::operationCounts() - start_; }
+	//! Starts counting again from zero
+	void reset() { start_ = detail::operationCounts(); }
+};
+
+/**
+ * Scalar type counting its constructions, copies and arithmetic operations
+ *
+ * Drop-in replacement for T as entry type of the matrix, vector and
+ * quaternion classes that counts every operation in the thread-local
+ * counters read by OperationCounter. It is intended for tests and audits
+ * of the number of temporaries and operations of the library functions,
+ * the counting makes it much slower than T. Values convert implicitly from
+ * T, value() returns the wrapped value.
+ *
+ * @tparam T Type of the wrapped value, e.g. double.
+ */
+template<typename T>
+class CountingScalar
+{
+private:
+	T value_;
+
+	static OperationCounts& counts() { return detail::operationCounts(); }
+
+	struct RawTag {};
+	CountingScalar(RawTag, const T& value) : value_(value) {}
+
+	//! Returns a new value without counting its construction (the operation producing it is counted instead)
+	static CountingScalar result(const T& value) { return CountingScalar(RawTag(), value); }
+
+public:
+	//! Constructs a zero value
+	CountingScalar() : value_() { counts().constructions++; }
+	//! Constructs a value from T
+	CountingScalar(const T& value) : value_(value) { counts().constructions++; }
+	CountingScalar(const CountingScalar& other) : value_(other.value_) { counts().copies++; }
+	CountingScalar(CountingScalar&& other) noexcept : value_(other.value_) { counts().moves++; }
+
+	CountingScalar& operator=(const CountingScalar& other) { value_ = other.value_; counts().copies++; return *this; }
+	CountingScalar& operator=(CountingScalar&& other) noexcept { value_ = other.value_; counts().moves++; return *this; }
+
+	//! Returns the wrapped value
+	const T& value() const { return value_; }
+	//! Converts the value to the specified arithmetic type
+	explicit operator T() const { return value_; }
+
+	CountingScalar& operator+=(const CountingScalar& rhs) { value_ += rhs.value_; counts().additions++; return *this; }
+	CountingScalar& operator-=(const CountingScalar& rhs) { value_ -= rhs.value_; counts().additions++; return *this; }
+	CountingScalar& operator*=(const CountingScalar& rhs) { value_ *= rhs.value_; counts().multiplications++; return *this; }
+	CountingScalar& operator/=(const CountingScalar& rhs) { value_ /= rhs.value_; counts().divisions++; return *this; }
+
+	CountingScalar operator-() const { counts().additions++; return result(-value_); }
+	const CountingScalar& operator+() const { return *this; }
+
+	friend CountingScalar operator+(const CountingScalar& lhs, const CountingScalar& rhs) { counts().additions++; return result(lhs.value_ + rhs.value_); }
+	friend CountingScalar operator-(const CountingScalar& lhs, const CountingScalar& rhs) { counts().additions++; return result(lhs.value_ - rhs.value_); }
+	friend CountingScalar operator*(const CountingScalar& lhs, const CountingScalar& rhs) { counts().multiplications++; return result(lhs.value_ * rhs.value_); }
+	friend CountingScalar operator/(const CountingScalar& lhs, const CountingScalar& rhs) { counts().divisions++; return result(lhs.value_ / rhs.value_); }
+
+	friend bool operator==(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ == rhs.value_; }
+	friend bool operator!=(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ != rhs.value_; }
+	friend bool operator<(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ < rhs.value_; }
+	friend bool operator>(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ > rhs.value_; }
+	friend bool operator<=(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ <= rhs.value_; }
+	friend bool operator>=(const CountingScalar& lhs, const CountingScalar& rhs) { return lhs.value_ >= rhs.value_; }
+
+	// Found by argument dependent lookup after using std::sqrt etc.
+	friend CountingScalar sqrt(const CountingScalar& x) { using std::sqrt; counts().functions++; return result(sqrt(x.value_)); }
+	friend CountingScalar abs(const CountingScalar& x) { using std::abs; counts().functions++; return result(abs(x.value_)); }
+	friend CountingScalar exp(const CountingScalar& x) { using std::exp; counts().functions++; return result(exp(x.value_)); }
+	friend CountingScalar log(const CountingScalar& x) { using std::log; counts().functions++; return result(log(x.value_)); }
+	friend CountingScalar sin(const CountingScalar& x) { using std::sin; counts().functions++; return result(sin(x.value_)); }
+	friend CountingScalar cos(const CountingScalar& x) { using std::cos; counts().functions++; return result(cos(x.value_)); }
+	friend CountingScalar acos(const CountingScalar& x) { using std::acos; counts().functions++; return result(acos(x.value_)); }
+
+	friend std::ostream& operator<<(std::ostream& os, const CountingScalar& x) { return os << x.value_; }
+};
+
+}
@@ -0,0 +1,638 @@
+/*
+	linear_algebra_containers/cpu_dispatch header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "simd.h"
+#include "gemm_kernels.h"
+#include "transform_kernels.h"
+#include "soa_kernels.h"
+#include "rotation_kernels.h"
+#include "inverse_kernels.h"
+#include "eigen_kernels.h"
+#include "unrolled_kernels.h"
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Minimum number of entries of a matrix for which the elementwise operations
+// use the runtime dispatched kernels. Smaller matrices use the kernels of the
+// instruction sets enabled at compile time which can be inlined completely.
+#ifndef LIN_ALGEBRA_DISPATCH_MIN_SIZE
+	#define LIN_ALGEBRA_DISPATCH_MIN_SIZE 64
+#endif
+
+namespace lin_algebra {
+namespace simd {
+
+//! Instruction sets that can be selected at runtime
+enum class InstructionSet
+{
+	Scalar,
+	Sse2,
+	Avx2,
+	Avx512
+};
+
+//! Returns the name of the instruction set
+inline const char* instructionSetName(InstructionSet isa)
+{
+	switch(isa) {
+	case InstructionSet::Sse2: return "SSE2";
+	case InstructionSet::Avx2: return "AVX2";
+	case InstructionSet::Avx512: return "AVX-512";
+	default: return "Scalar";
+	}
+}
+
+/**
+ * @brief Detect the widest instruction set supported by the CPU
+ *
+ * AVX2 is only reported together with FMA. The AVX instruction sets also
+ * require that the operating system saves the extended register state. If
+ * runtime dispatch is disabled the widest instruction set enabled at compile
+ * time is returned.
+ */
+inline InstructionSet detectInstructionSet()
+{
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const bool sse2 = (info[3] & (1 << 26)) != 0;
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+
+	bool avx2 = false;
+	bool avx512f = false;
+	if(maxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+		avx512f = (info[1] & (1 << 16)) != 0;
+	}
+
+	// XCR0 bits 1-2: SSE and AVX state, bits 5-7: AVX-512 state
+	const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	const bool osYmm = (xcr0 & 0x6) == 0x6;
+	const bool osZmm = (xcr0 & 0xE6) == 0xE6;
+
+	if(avx512f && avx2 && fma && osZmm) return InstructionSet::Avx512;
+	if(avx && avx2 && fma && osYmm) return InstructionSet::Avx2;
+	if(sse2) return InstructionSet::Sse2;
+	return InstructionSet::Scalar;
+#elif defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+	// The builtins also check the operating system support of the register state
+	__builtin_cpu_init();
+	const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	if(avx2 && __builtin_cpu_supports("avx512f")) return InstructionSet::Avx512;
+	if(avx2) return InstructionSet::Avx2;
+	if(__builtin_cpu_supports("sse2")) return InstructionSet::Sse2;
+	return InstructionSet::Scalar;
+#else
+	if(IsaEnabled<Avx512>::value) return InstructionSet::Avx512;
+	if(IsaEnabled<Avx2>::value) return InstructionSet::Avx2;
+	if(IsaEnabled<Sse2>::value) return InstructionSet::Sse2;
+	return InstructionSet::Scalar;
+#endif
+}
+
+//! Returns the instruction set used by the runtime dispatched kernels (detected once on first use)
+inline InstructionSet runtimeInstructionSet()
+{
+	static const InstructionSet isa = detectInstructionSet();
+	return isa;
+}
+
+}
+}
+
+// Kernels compiled with the instruction sets enabled at compile time
+#define LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE native
+#include "packet_kernels.h"
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+// Kernels compiled for AVX2 and AVX-512 independent of the compiler flags.
+// All functions in these regions (including the instantiations of the kernel
+// templates) use the target options, so that packets are never passed between
+// functions compiled for different instruction sets.
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx2,fma")
+#endif
+#define LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE avx2
+#include "packet_kernels.h"
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx512f,avx2,fma")
+#endif
+#define LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE avx512
+#include "packet_kernels.h"
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
+#endif
+
+namespace lin_algebra {
+namespace detail {
+
+//! Elementwise kernels for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct ElementwiseKernel : native::PacketElementwiseKernel<T,Isa> {};
+
+template<typename T>
+struct ElementwiseKernel<T,simd::Scalar> : ScalarElementwiseKernel<T> {};
+
+//! Micro kernel of the matrix product for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct GemmMicroKernelFor : native::PacketGemmMicroKernel<T,Isa> {};
+
+template<typename T>
+struct GemmMicroKernelFor<T,simd::Scalar>
+{
+	static void run(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr, bool accumulate)
+	{
+		gemmMicroKernel<T,GemmBlocking<T>::MR,GemmBlocking<T>::NR>(kc, a, b, c, ldc, mr, nr, accumulate);
+	}
+};
+
+//! Batched 3d transformation kernel for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct Transform3For : native::PacketTransform3<T,Isa> {};
+
+template<typename T>
+struct Transform3For<T,simd::Scalar>
+{
+	static void run(const T* mat, const T* in, T* out, size_t count) { transform3(mat, in, out, count); }
+	static void rotate(const T* quats, const T* in, T* out, size_t count) { quaternionRotate3(quats, in, out, count); }
+};
+
+//! Kernels on 3d vectors in structure-of-arrays layout for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct SoaKernelFor : native::PacketSoaKernel<T,Isa> {};
+
+template<typename T>
+struct SoaKernelFor<T,simd::Scalar> : ScalarSoaKernel<T> {};
+
+//! Conversions between quaternions and rotation matrices for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct RotationKernelFor : native::PacketRotationKernel<T,Isa> {};
+
+template<typename T>
+struct RotationKernelFor<T,simd::Scalar>
+{
+	static void toMatrix(const T* quats, T* mats, size_t count) { quaternionToMatrix(quats, mats, count); }
+	static void fromMatrix(const T* mats, T* quats, size_t count) { matrixToQuaternion(mats, quats, count); }
+};
+
+//! Batched inversion of small matrices for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct InverseKernelFor : native::PacketInverseKernel<T,Isa> {};
+
+template<typename T>
+struct InverseKernelFor<T,simd::Scalar>
+{
+	static void invert2(const T* in, T* out, size_t count) { invertMatrices<T,2>(in, out, count); }
+	static void invert3(const T* in, T* out, size_t count) { invertMatrices<T,3>(in, out, count); }
+	static void invert4(const T* in, T* out, size_t count) { invertMatrices<T,4>(in, out, count); }
+};
+
+//! Batched eigen decomposition of symmetric 3x3 matrices for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct SymmetricEigenKernelFor : native::PacketSymmetricEigenKernel<T,Isa> {};
+
+template<typename T>
+struct SymmetricEigenKernelFor<T,simd::Scalar> : native::JacobiEigen3<T,simd::ScalarPacket<T>> {};
+
+//! Batched singular value and polar decomposition of 3x3 matrices for an instruction set enabled at compile time
+template<typename T, typename Isa>
+struct SvdKernelFor : native::PacketSvdKernel<T,Isa> {};
+
+template<typename T>
+struct SvdKernelFor<T,simd::Scalar> : native::JacobiSvd3<T,simd::ScalarPacket<T>> {};
+
+//! Elementwise kernels for arrays of type T with the specified compile-time size (instruction sets enabled at compile time only)
+template<typename T, size_t size>
+using StaticElementwise = ElementwiseKernel<T,typename simd::SelectIsa<T,size>::type>;
+
+//! Evaluates to true if runtime dispatched kernels exist for T
+template<typename T>
+struct HasDispatchedKernels : std::integral_constant<bool,
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+	std::is_same<T,float>::value || std::is_same<T,double>::value
+#else
+	false
+#endif
+	> {};
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+
+/**
+ * Table of kernels compiled for one instruction set
+ *
+ * The table is filled once with the kernels of the instruction set that is
+ * detected at runtime so that a single executable can use AVX2 or AVX-512
+ * on CPUs supporting it without requiring it on all other CPUs.
+ */
+template<typename T>
+struct KernelTable
+{
+	simd::InstructionSet isa;
+	void (*add)(T* dst, const T* src, size_t n);
+	void (*subtract)(T* dst, const T* src, size_t n);
+	void (*scale)(T* dst, const T& factor, size_t n);
+	void (*fill)(T* dst, const T& value, size_t n);
+	bool (*equal)(const T* lhs, const T* rhs, size_t n);
+	T (*dot)(const T* lhs, const T* rhs, size_t n);
+	GemmMicroKernelFunction<T> gemmMicroKernel;
+	Transform3Function<T> transform3;
+	QuaternionRotate3Function<T> quaternionRotate3;
+	void (*dot3)(const T* const* a, const T* const* b, T* out, size_t n);
+	void (*cross3)(const T* const* a, const T* const* b, T* const* out, size_t n);
+	void (*normSquared3)(const T* const* a, T* out, size_t n);
+	void (*normalize3)(const T* const* a, T* const* out, size_t n);
+	QuaternionToMatrixFunction<T> quaternionToMatrix;
+	MatrixToQuaternionFunction<T> matrixToQuaternion;
+	InverseFunction<T> invert2;
+	InverseFunction<T> invert3;
+	InverseFunction<T> invert4;
+	SymmetricEigen3Function<T> symmetricEigen3;
+	Svd3Function<T> svd3;
+	Polar3Function<T> polar3;
+};
+
+//! Returns a kernel table with the kernels of the specified types
+template<typename T, typename Elementwise, typename GemmMicroKernel, typename Transform3, typename Soa, typename Rotation, typename Inverse, typename Eigen, typename Svd>
+inline KernelTable<T> makeKernelTable(simd::InstructionSet isa)
+{
+	KernelTable<T> kernels = {
+		isa,
+		&Elementwise::add,
+		&Elementwise::subtract,
+		&Elementwise::template scale<T>,
+		&Elementwise::fill,
+		&Elementwise::equal,
+		&Elementwise::dot,
+		&GemmMicroKernel::run,
+		&Transform3::run,
+		&Transform3::rotate,
+		&Soa::dot3,
+		&Soa::cross3,
+		&Soa::normSquared3,
+		&Soa::normalize3,
+		&Rotation::toMatrix,
+		&Rotation::fromMatrix,
+		&Inverse::invert2,
+		&Inverse::invert3,
+		&Inverse::invert4,
+		&Eigen::run,
+		&Svd::run,
+		&Svd::runPolar
+	};
+	return kernels;
+}
+
+//! Returns the kernel table of the specified instruction set
+template<typename T>
+inline KernelTable<T> makeKernelTable(simd::InstructionSet isa)
+{
+	switch(isa) {
+	case simd::InstructionSet::Sse2:
+		return makeKernelTable<T, native::PacketElementwiseKernel<T,simd::Sse2>,
+			native::PacketGemmMicroKernel<T,simd::Sse2>, native::PacketTransform3<T,simd::Sse2>,
+			native::PacketSoaKernel<T,simd::Sse2>, native::PacketRotationKernel<T,simd::Sse2>,
+			native::PacketInverseKernel<T,simd::Sse2>, native::PacketSymmetricEigenKernel<T,simd::Sse2>,
+			native::PacketSvdKernel<T,simd::Sse2>>(isa);
+	case simd::InstructionSet::Avx2:
+		return makeKernelTable<T, avx2::PacketElementwiseKernel<T,simd::Avx2>,
+			avx2::PacketGemmMicroKernel<T,simd::Avx2>, avx2::PacketTransform3<T,simd::Avx2>,
+			avx2::PacketSoaKernel<T,simd::Avx2>, avx2::PacketRotationKernel<T,simd::Avx2>,
+			avx2::PacketInverseKernel<T,simd::Avx2>, avx2::PacketSymmetricEigenKernel<T,simd::Avx2>,
+			avx2::PacketSvdKernel<T,simd::Avx2>>(isa);
+	case simd::InstructionSet::Avx512:
+		return makeKernelTable<T, avx512::PacketElementwiseKernel<T,simd::Avx512>,
+			avx512::PacketGemmMicroKernel<T,simd::Avx512>, avx512::PacketTransform3<T,simd::Avx512>,
+			avx512::PacketSoaKernel<T,simd::Avx512>, avx512::PacketRotationKernel<T,simd::Avx512>,
+			avx512::PacketInverseKernel<T,simd::Avx512>, avx512::PacketSymmetricEigenKernel<T,simd::Avx512>,
+			avx512::PacketSvdKernel<T,simd::Avx512>>(isa);
+	default:
+		return makeKernelTable<T, ScalarElementwiseKernel<T>,
+			GemmMicroKernelFor<T,simd::Scalar>, Transform3For<T,simd::Scalar>,
+			ScalarSoaKernel<T>, RotationKernelFor<T,simd::Scalar>,
+			InverseKernelFor<T,simd::Scalar>, SymmetricEigenKernelFor<T,simd::Scalar>,
+			SvdKernelFor<T,simd::Scalar>>(simd::InstructionSet::Scalar);
+	}
+}
+
+//! Returns the kernel table of the instruction set detected at runtime
+template<typename T>
+inline const KernelTable<T>& kernelTable()
+{
+	static const KernelTable<T> kernels = makeKernelTable<T>(simd::runtimeInstructionSet());
+	return kernels;
+}
+
+/**
+ * Elementwise kernels calling the runtime dispatched implementations
+ *
+ * Provides the same interface as ElementwiseKernel. Scaling with a factor
+ * that is not exactly representable in T uses the scalar kernel to keep the
+ * results independent of the instruction set.
+ */
+template<typename T>
+struct DispatchedElementwiseKernel
+{
+	static void add(T* dst, const T* src, size_t n) { kernelTable<T>().add(dst, src, n); }
+	static void subtract(T* dst, const T* src, size_t n) { kernelTable<T>().subtract(dst, src, n); }
+	template<typename S>
+	static void scale(T* dst, const S& factor, size_t n)
+	{
+		const T f = T(factor);
+		if(S(f) != factor) {
+			ScalarElementwiseKernel<T>::scale(dst, factor, n);
+			return;
+		}
+		kernelTable<T>().scale(dst, f, n);
+	}
+	static void fill(T* dst, const T& value, size_t n) { kernelTable<T>().fill(dst, value, n); }
+	static T dot(const T* lhs, const T* rhs, size_t n) { return kernelTable<T>().dot(lhs, rhs, n); }
+	static bool equal(const T* lhs, const T* rhs, size_t n) { return kernelTable<T>().equal(lhs, rhs, n); }
+};
+
+//! Kernels on 3d vectors in structure-of-arrays layout calling the runtime dispatched implementations
+template<typename T>
+struct DispatchedSoaKernel
+{
+	static void dot3(const T* const* a, const T* const* b, T* out, size_t n) { kernelTable<T>().dot3(a, b, out, n); }
+	static void cross3(const T* const* a, const T* const* b, T* const* out, size_t n) { kernelTable<T>().cross3(a, b, out, n); }
+	static void normSquared3(const T* const* a, T* out, size_t n) { kernelTable<T>().normSquared3(a, out, n); }
+	static void normalize3(const T* const* a, T* const* out, size_t n) { kernelTable<T>().normalize3(a, out, n); }
+};
+
+#endif
+
+//! Selects the unrolled elementwise kernels (with the packets of the instruction sets enabled at compile time if they fit)
+template<typename T, size_t size, typename Isa = typename simd::SelectIsa<T,size>::type>
+struct SelectUnrolledElementwise
+{
+	typedef native::UnrolledPacketElementwiseKernel<T,Isa,size> type;
+};
+
+template<typename T, size_t size>
+struct SelectUnrolledElementwise<T,size,simd::Scalar>
+{
+	typedef UnrolledElementwiseKernel<T,size> type;
+};
+
+template<typename T, size_t size, bool dispatched = HasDispatchedKernels<T>::value && (size >= LIN_ALGEBRA_DISPATCH_MIN_SIZE),
+	bool unrolled = IsUnrolledSize<size>::value>
+struct SelectElementwise
+{
+	typedef StaticElementwise<T,size> type;
+};
+
+template<typename T, size_t size, bool dispatched>
+struct SelectElementwise<T,size,dispatched,true>
+{
+	typedef typename SelectUnrolledElementwise<T,size>::type type;
+};
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<typename T, size_t size>
+struct SelectElementwise<T,size,true,false>
+{
+	typedef DispatchedElementwiseKernel<T> type;
+};
+#endif
+
+/**
+ * @brief Elementwise kernels for arrays of type T with the specified compile-time size
+ *
+ * Arrays with at most LIN_ALGEBRA_UNROLL_MAX_SIZE entries use the unrolled
+ * kernels (SIMD packets if they fit, constexpr scalar code otherwise), arrays with at least LIN_ALGEBRA_DISPATCH_MIN_SIZE entries the
+ * runtime dispatched kernels and all other arrays the kernels of the
+ * instruction sets enabled at compile time.
+ */
+template<typename T, size_t size>
+using Elementwise = typename SelectElementwise<T,size>::type;
+
+//! Selects the kernel summing up inner products sequentially
+template<typename T, size_t size, bool unrolled = IsUnrolledSize<size>::value>
+struct SelectSequentialKernel
+{
+	typedef ScalarElementwiseKernel<T> type;
+};
+
+template<typename T, size_t size>
+struct SelectSequentialKernel<T,size,true>
+{
+	typedef UnrolledElementwiseKernel<T,size> type;
+};
+
+/**
+ * @brief Kernel for inner products of vectors with the specified compile-time size
+ *
+ * Vectors with less than 16 entries are summed up sequentially in the
+ * original order, longer vectors use the elementwise kernels (i.e. one
+ * partial sum per SIMD lane unless they are unrolled).
+ */
+template<typename T, size_t size>
+using DotKernel = typename std::conditional<(size >= 16), Elementwise<T,size>, typename SelectSequentialKernel<T,size>::type>::type;
+
+//! Selects the micro kernel of the matrix product
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct GemmMicroKernelSelect
+{
+	static GemmMicroKernelFunction<T> get()
+	{
+		return &GemmMicroKernelFor<T,typename simd::SelectIsa<T,GemmBlocking<T>::MR>::type>::run;
+	}
+};
+
+//! Selects the batched 3d transformation kernel
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct Transform3Select
+{
+	static Transform3Function<T> get()
+	{
+		return &Transform3For<T,typename simd::SelectIsa<T,16>::type>::run;
+	}
+};
+
+//! Selects the batched quaternion rotation kernel
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct QuaternionRotate3Select
+{
+	static QuaternionRotate3Function<T> get()
+	{
+		return &Transform3For<T,typename simd::SelectIsa<T,16>::type>::rotate;
+	}
+};
+
+//! Selects the conversions between quaternions and rotation matrices
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct RotationKernelSelect
+{
+	static QuaternionToMatrixFunction<T> toMatrix()
+	{
+		return &RotationKernelFor<T,typename simd::SelectIsa<T,16>::type>::toMatrix;
+	}
+
+	static MatrixToQuaternionFunction<T> fromMatrix()
+	{
+		return &RotationKernelFor<T,typename simd::SelectIsa<T,16>::type>::fromMatrix;
+	}
+};
+
+//! Selects the batched inversion kernel for n x n matrices (n = 2, 3 or 4)
+template<typename T, size_t n, bool dispatched = HasDispatchedKernels<T>::value>
+struct InverseKernelSelect
+{
+	static InverseFunction<T> get()
+	{
+		typedef InverseKernelFor<T,typename simd::SelectIsa<T,16>::type> Kernel;
+		return (n == 2) ? &Kernel::invert2 : ((n == 3) ? &Kernel::invert3 : &Kernel::invert4);
+	}
+};
+
+//! Selects the batched eigen decomposition kernel of symmetric 3x3 matrices
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct SymmetricEigenKernelSelect
+{
+	static SymmetricEigen3Function<T> get()
+	{
+		return &SymmetricEigenKernelFor<T,typename simd::SelectIsa<T,16>::type>::run;
+	}
+};
+
+//! Selects the batched singular value and polar decomposition kernels of 3x3 matrices
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct SvdKernelSelect
+{
+	static Svd3Function<T> svd()
+	{
+		return &SvdKernelFor<T,typename simd::SelectIsa<T,16>::type>::run;
+	}
+
+	static Polar3Function<T> polar()
+	{
+		return &SvdKernelFor<T,typename simd::SelectIsa<T,16>::type>::runPolar;
+	}
+};
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<typename T>
+struct GemmMicroKernelSelect<T,true>
+{
+	static GemmMicroKernelFunction<T> get() { return kernelTable<T>().gemmMicroKernel; }
+};
+
+template<typename T>
+struct Transform3Select<T,true>
+{
+	static Transform3Function<T> get() { return kernelTable<T>().transform3; }
+};
+
+template<typename T>
+struct QuaternionRotate3Select<T,true>
+{
+	static QuaternionRotate3Function<T> get() { return kernelTable<T>().quaternionRotate3; }
+};
+
+template<typename T>
+struct RotationKernelSelect<T,true>
+{
+	static QuaternionToMatrixFunction<T> toMatrix() { return kernelTable<T>().quaternionToMatrix; }
+	static MatrixToQuaternionFunction<T> fromMatrix() { return kernelTable<T>().matrixToQuaternion; }
+};
+
+template<typename T, size_t n>
+struct InverseKernelSelect<T,n,true>
+{
+	static InverseFunction<T> get()
+	{
+		const KernelTable<T>& kernels = kernelTable<T>();
+		return (n == 2) ? kernels.invert2 : ((n == 3) ? kernels.invert3 : kernels.invert4);
+	}
+};
+
+template<typename T>
+struct SymmetricEigenKernelSelect<T,true>
+{
+	static SymmetricEigen3Function<T> get() { return kernelTable<T>().symmetricEigen3; }
+};
+
+template<typename T>
+struct SvdKernelSelect<T,true>
+{
+	static Svd3Function<T> svd() { return kernelTable<T>().svd3; }
+	static Polar3Function<T> polar() { return kernelTable<T>().polar3; }
+};
+#endif
+
+//! Selects the kernels on 3d vectors in structure-of-arrays layout
+template<typename T, bool dispatched = HasDispatchedKernels<T>::value>
+struct SelectSoaKernel
+{
+	typedef SoaKernelFor<T,typename simd::SelectIsa<T,16>::type> type;
+};
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<typename T>
+struct SelectSoaKernel<T,true>
+{
+	typedef DispatchedSoaKernel<T> type;
+};
+#endif
+
+//! Kernels on 3d vectors in structure-of-arrays layout (runtime dispatched for float and double)
+template<typename T>
+using SoaKernel = typename SelectSoaKernel<T>::type;
+
+//! Elementwise kernels for arrays with a size that is only known at runtime
+template<typename T>
+using DynamicElementwise = Elementwise<T,size_t(-1)>;
+
+}
+}
@@ -0,0 +1,618 @@
+/*
+	linear_algebra_containers/dynamic_matrix header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "aligned_allocator.h"
+#include "cpu_dispatch.h"
+#include "gemm.h"
+#include "flop_accounting.h"
+#include "transpose_kernels.h"
+
+namespace lin_algebra {
+/**
+ * Matrix template with dimensions specified at runtime
+ *
+ * Counterpart of Matrix for problems whose dimensions are only known at
+ * runtime. The entries are stored on the heap in the same column-major layout
+ * as the entries of a Matrix without padding, so mat(row,column), mat[i] and
+ * data() address the entries exactly like they do for the fixed-size
+ * template. The products, transposition and elementwise operations use the
+ * same cache blocked and SIMD kernels as the fixed-size matrices.
+ * The dimensions usually come from input data, so operations and
+ * conversions check that the dimensions of their operands agree in all
+ * builds and throw std::invalid_argument otherwise. Only the element access
+ * is checked with assert (i.e. only if NDEBUG is not defined).
+ *
+ * Matrices with heap storage (HeapMatrix) use the same allocation as dynamic
+ * matrices, so a HeapMatrix can be moved into a DynamicMatrix and back again
+ * without copying the entries. The entries of a dynamic matrix can also be
+ * accessed as a fixed-size Matrix with asMatrix().
+ * @tparam T Type used for the entries of the matrix. Must support basic
+ * aritmethic operations.
+ */
+template<typename T>
+class DynamicMatrix
+{
+public:
+	//! Type of the matrix entries
+	typedef T ScalarType;
+	//! Alignment of the entries in bytes
+	static constexpr size_t alignment = 64;
+
+private:
+	typedef detail::DynamicElementwise<T> ElementwiseKernels;
+
+	size_t rows_;
+	size_t cols_;
+	T* entries_;
+
+	//! Allocates an array of size entries, which are value-initialized if initialize is set
+	static T* allocate(size_t size, bool initialize)
+	{
+		if(size == 0) return nullptr;
+		T* entries = static_cast<T*>(detail::alignedAllocate(size*sizeof(T), alignment));
+		for(size_t i = 0; i < size; i++) {
+			if(initialize) new (entries + i) T();
+			else new (entries + i) T;
+		}
+		return entries;
+	}
+
+	//! Throws std::invalid_argument with the specified message if the dimensions don't agree
+	static void checkDimensions(bool agree, const char* message)
+	{
+		if(!agree) throw std::invalid_argument(message);
+	}
+
+	void destroy()
+	{
+		if(!entries_) return;
+		for(size_t i = 0; i < size(); i++) entries_[i].~T();
+		detail::alignedFree(entries_);
+		entries_ = nullptr;
+	}
+
+public:
+	//! Constructs an empty [0 x 0] matrix
+	DynamicMatrix()
+		: rows_(0), cols_(0), entries_(nullptr)
+	{
+	}
+
+	//! Constructs a [rows x cols] matrix with all entries set to zero
+	DynamicMatrix(size_t rows, size_t cols)
+		: rows_(rows), cols_(cols), entries_(allocate(rows*cols, true))
+	{
+	}
+
+	//! Constructs a [rows x cols] matrix without initializing the entries
+	DynamicMatrix(size_t rows, size_t cols, detail::UninitializedTag)
+		: rows_(rows), cols_(cols), entries_(allocate(rows*cols, false))
+	{
+	}
+
+	//! Constructs a [rows x cols] matrix from the specified rows*cols entries in column-major order
+	DynamicMatrix(size_t rows, size_t cols, const T* values)
+		: DynamicMatrix(rows, cols, detail::UninitializedTag())
+	{
+		for(size_t i = 0; i < size(); i++) entries_[i] = values[i];
+	}
+
+	//! Constructs a matrix with the dimensions and a copy of the entries of the specified fixed-size matrix
+	template<size_t m, size_t n, typename Storage>
+	explicit DynamicMatrix(const Matrix<T,m,n,Storage>& mat)
+		: DynamicMatrix(m, n, detail::UninitializedTag())
+	{
+		for(size_t j = 0; j < n; j++) {
+			for(size_t i = 0; i < m; i++) entries_[index(i,j)] = mat(i,j);
+		}
+	}
+
+	/**
+	 * @brief Take over the entries of a heap matrix
+	 *
+	 * Constructs a matrix with the dimensions of the specified heap matrix,
+	 * which takes over the entries of the heap matrix without copying them.
+	 * Like every moved-from heap matrix, mat has no entries afterwards. A heap
+	 * matrix without entries (because it was moved from) gives an empty
+	 * matrix.
+	 */
+	template<size_t m, size_t n>
+	DynamicMatrix(HeapMatrix<T,m,n,alignment>&& mat) noexcept
+		: rows_(mat.data() ? m : 0), cols_(mat.data() ? n : 0), entries_(mat.entries_.release())
+	{
+	}
+
+	DynamicMatrix(const DynamicMatrix& other)
+		: DynamicMatrix(other.rows_, other.cols_, other.entries_)
+	{
+	}
+
+	//! Moves the entries of the other matrix to this matrix, the other matrix is empty afterwards
+	DynamicMatrix(DynamicMatrix&& other) noexcept
+		: rows_(other.rows_), cols_(other.cols_), entries_(other.entries_)
+	{
+		other.rows_ = 0;
+		other.cols_ = 0;
+		other.entries_ = nullptr;
+	}
+
+	DynamicMatrix& operator=(const DynamicMatrix& other)
+	{
+		if(this == &other) return *this;
+		if(size() != other.size()) {
+			DynamicMatrix copy(other);
+			swap(copy);
+		} else {
+			rows_ = other.rows_;
+			cols_ = other.cols_;
+			for(size_t i = 0; i < size(); i++) entries_[i] = other.entries_[i];
+		}
+		return *this;
+	}
+
+	DynamicMatrix& operator=(DynamicMatrix&& other) noexcept
+	{
+		swap(other);
+		return *this;
+	}
+
+	~DynamicMatrix() { destroy(); }
+
+	//! Exchanges the dimensions and entries of the two matrices
+	void swap(DynamicMatrix& other) noexcept
+	{
+		std::swap(rows_, other.rows_);
+		std::swap(cols_, other.cols_);
+		std::swap(entries_, other.entries_);
+	}
+
+	/**
+	 * @brief Create an identity matrix
+	 *
+	 * This method constructs a [rows x cols] matrix with all entries set to
+	 * zero except for the diagonal entries which are set to one.
+	 * @return An identity matrix.
+	 */
+	static DynamicMatrix createIdentity(size_t rows, size_t cols)
+	{
+		DynamicMatrix result(rows, cols);
+		result.toIdentity();
+		return result;
+	}
+
+	//! Sets all entries to zero except for the diagonal entries which are set to one
+	DynamicMatrix& toIdentity()
+	{
+		fill(T(0));
+		const size_t smaller_dim = (rows_ < cols_) ? rows_ : cols_;
+		for(size_t i = 0; i < smaller_dim; i++) entries_[index(i,i)] = T(1);
+		return *this;
+	}
+
+	//! Returns the number of rows of the matrix
+	size_t rows() const { return rows_; }
+	//! Returns the number of columns of the matrix
+	size_t cols() const { return cols_; }
+	//! Returns the number of entries of the matrix
+	size_t size() const { return rows_*cols_; }
+	//! Returns whether the matrix has no entries
+	bool empty() const { return size() == 0; }
+
+	//! Changes the dimensions of the matrix, all entries are set to zero
+	void resize(size_t rows, size_t cols)
+	{
+		if(rows*cols != size()) {
+			DynamicMatrix resized(rows, cols);
+			swap(resized);
+		} else {
+			rows_ = rows;
+			cols_ = cols;
+			zeros();
+		}
+	}
+
+	//! Returns the element index of the specified coordinates in the underlying array
+	size_t index(size_t row, size_t column) const { return row + column*rows_; }
+
+	//! Returns a reference to the entry at the specified coordinates
+	T& operator()(size_t row, size_t column)
+	{
+		assert(row < rows_ && column < cols_);
+		return entries_[index(row,column)];
+	}
+
+	//! Returns a const reference to the entry at the specified coordinates
+	const T& operator()(size_t row, size_t column) const
+	{
+		assert(row < rows_ && column < cols_);
+		return entries_[index(row,column)];
+	}
+
+	//! Returns a reference to the i-th element stored in the matrix (column major)
+	T& operator[](size_t i)
+	{
+		assert(i < size());
+		return entries_[i];
+	}
+
+	//! Returns a const-reference to the i-th element stored in the matrix (column major)
+	const T& operator[](size_t i) const
+	{
+		assert(i < size());
+		return entries_[i];
+	}
+
+	//! Returns a pointer to the underlying array (column-major, aligned to alignment bytes, nullptr if the matrix is empty)
+	T* data() { return entries_; }
+	//! Returns a const-pointer to the underlying array (see data())
+	const T* data() const { return entries_; }
+
+	//! Sets all entries to the specified value
+	DynamicMatrix& fill(const T& val) { ElementwiseKernels::fill(entries_, val, size()); return *this; }
+	//! Sets all entries to zero
+	DynamicMatrix& zeros() { return fill(T(0)); }
+
+	//! Returns the transposed of this matrix
+	DynamicMatrix transposed() const
+	{
+		DynamicMatrix result(cols_, rows_, detail::UninitializedTag());
+		detail::transposeBlocked(rows_, cols_, entries_, 1, rows_, result.entries_, cols_);
+		return result;
+	}
+
+	/**
+	 * @brief Access the entries as a fixed-size matrix
+	 *
+	 * Returns a reference to the entries of this matrix interpreted as an
+	 * [m x n] Matrix without copying them. The reference is only valid as
+	 * long as the entries of this matrix are not reallocated. Throws
+	 * std::invalid_argument if the dimensions don't agree with the dimensions
+	 * of this matrix.
+	 */
+	template<size_t m, size_t n>
+	Matrix<T,m,n>& asMatrix()
+	{
+		static_assert(sizeof(Matrix<T,m,n>) == m*n*sizeof(T), "Matrices must be stored without padding");
+		checkDimensions(rows_ == m && cols_ == n, "DynamicMatrix::asMatrix: dimensions don't agree");
+		return *reinterpret_cast<Matrix<T,m,n>*>(entries_);
+	}
+
+	//! Returns a const reference to the entries interpreted as an [m x n] Matrix (see asMatrix())
+	template<size_t m, size_t n>
+	const Matrix<T,m,n>& asMatrix() const
+	{
+		static_assert(sizeof(Matrix<T,m,n>) == m*n*sizeof(T), "Matrices must be stored without padding");
+		checkDimensions(rows_ == m && cols_ == n, "DynamicMatrix::asMatrix: dimensions don't agree");
+		return *reinterpret_cast<const Matrix<T,m,n>*>(entries_);
+	}
+
+	//! Returns a fixed-size [m x n] copy of this matrix, throws std::invalid_argument if the dimensions don't agree
+	template<size_t m, size_t n>
+	Matrix<T,m,n> toMatrix() const
+	{
+		return asMatrix<m,n>();
+	}
+
+	/**
+	 * @brief Hand over the entries to a heap matrix
+	 *
+	 * Returns an [m x n] HeapMatrix which takes over the entries of this
+	 * matrix without copying them, this matrix is empty afterwards. Throws
+	 * std::invalid_argument (and keeps the entries) if the dimensions don't
+	 * agree with the dimensions of this matrix.
+	 */
+	template<size_t m, size_t n>
+	HeapMatrix<T,m,n,alignment> toHeapMatrix() &&
+	{
+		checkDimensions(rows_ == m && cols_ == n, "DynamicMatrix::toHeapMatrix: dimensions don't agree");
+		HeapMatrix<T,m,n,alignment> result(detail::AdoptTag(), entries_);
+		rows_ = 0;
+		cols_ = 0;
+		entries_ = nullptr;
+		return result;
+	}
+
+	//! Adds the right matrix to the left, throws std::invalid_argument if the dimensions don't agree
+	DynamicMatrix& operator+=(const DynamicMatrix& rhs)
+	{
+		checkDimensions(rows_ == rhs.rows_ && cols_ == rhs.cols_, "DynamicMatrix::operator+=: dimensions don't agree");
+		ElementwiseKernels::add(entries_, rhs.entries_, size());
+		return *this;
+	}
+
+	//! Substracts the right matrix from the left, throws std::invalid_argument if the dimensions don't agree
+	DynamicMatrix& operator-=(const DynamicMatrix& rhs)
+	{
+		checkDimensions(rows_ == rhs.rows_ && cols_ == rhs.cols_, "DynamicMatrix::operator-=: dimensions don't agree");
+		ElementwiseKernels::subtract(entries_, rhs.entries_, size());
+		return *this;
+	}
+
+	//! Scales the matrix by the specified factor
+	DynamicMatrix& operator*=(const T& factor)
+	{
+		ElementwiseKernels::scale(entries_, factor, size());
+		return *this;
+	}
+
+	//! Compares the dimensions and the entries of the matrices for equality
+	bool operator==(const DynamicMatrix& rhs) const
+	{
+		return (rows_ == rhs.rows_) && (cols_ == rhs.cols_) && ElementwiseKernels::equal(entries_, rhs.entries_, size());
+	}
+
+	//! Compares the dimensions and the entries of the matrices for inequality
+	bool operator!=(const DynamicMatrix& rhs) const { return !(*this == rhs); }
+};
+
+/**
+ * Column vector with a dimension specified at runtime
+ *
+ * A dynamic [dim x 1] matrix with the vector operations of the fixed-size
+ * column vectors.
+ * @tparam T Type used for the entries of the vector.
+ */
+template<typename T>
+class DynamicVector : public DynamicMatrix<T>
+{
+private:
+	typedef DynamicMatrix<T> DynamicMatrixType;
+
+public:
+	//! Constructs an empty vector
+	DynamicVector()
+		: DynamicMatrixType(0, 1)
+	{
+	}
+
+	//! Constructs a vector of dimension dim with all entries set to zero
+	explicit DynamicVector(size_t dim)
+		: DynamicMatrixType(dim, 1)
+	{
+	}
+
+	//! Constructs a vector of dimension dim without initializing the entries
+	DynamicVector(size_t dim, detail::UninitializedTag tag)
+		: DynamicMatrixType(dim, 1, tag)
+	{
+	}
+
+	//! Constructs a vector from the specified dim entries
+	DynamicVector(size_t dim, const T* values)
+		: DynamicMatrixType(dim, 1, values)
+	{
+	}
+
+	//! Constructs a vector with a copy of the entries of the specified fixed-size column vector
+	template<size_t dim, typename Storage>
+	explicit DynamicVector(const Matrix<T,dim,1,Storage>& vec)
+		: DynamicMatrixType(vec)
+	{
+	}
+
+	//! Constructs a vector taking over the entries of a heap column vector (see DynamicMatrix)
+	template<size_t dim>
+	DynamicVector(HeapMatrix<T,dim,1,DynamicMatrixType::alignment>&& vec) noexcept
+		: DynamicMatrixType(std::move(vec))
+	{
+	}
+
+	//! Converts a [dim x 1] matrix to a vector without copying the entries, throws std::invalid_argument for other matrices
+	explicit DynamicVector(DynamicMatrixType&& mat)
+		: DynamicMatrixType(std::move(mat))
+	{
+		if(this->cols() != 1 && !this->empty()) throw std::invalid_argument("DynamicVector: the matrix is not a column vector");
+	}
+
+	//! Calculates the inner product of two vectors, throws std::invalid_argument if the dimensions don't agree
+	static T dotProduct(const DynamicVector& v1, const DynamicVector& v2)
+	{
+		if(v1.size() != v2.size()) throw std::invalid_argument("DynamicVector::dotProduct: dimensions don't agree");
+		return detail::DynamicElementwise<T>::dot(v1.data(), v2.data(), v1.size());
+	}
+
+	//! Returns the squared euclidean norm of the vector
+	T normSquared() const { return dotProduct(*this, *this); }
+
+	//! Returns the euclidean norm of the vector
+	T norm() const
+	{
+		using std::sqrt;
+		return sqrt(normSquared());
+	}
+
+	//! Divides all entries by the length of the vector
+	DynamicVector& normalize()
+	{
+		(*this) *= (1/norm());
+		return *this;
+	}
+
+	//! Returns a normalized copy of the vector
+	DynamicVector normalized() const
+	{
+		DynamicVector copy(*this);
+		copy.normalize();
+		return copy;
+	}
+
+	//! Adds the right vector to the left, throws std::invalid_argument if the dimensions don't agree
+	DynamicVector& operator+=(const DynamicVector& rhs)
+	{
+		DynamicMatrixType::operator+=(rhs);
+		return *this;
+	}
+
+	//! Substracts the right vector from the left, throws std::invalid_argument if the dimensions don't agree
+	DynamicVector& operator-=(const DynamicVector& rhs)
+	{
+		DynamicMatrixType::operator-=(rhs);
+		return *this;
+	}
+
+	//! Scales the vector by the specified factor
+	DynamicVector& operator*=(const T& factor)
+	{
+		DynamicMatrixType::operator*=(factor);
+		return *this;
+	}
+};
+
+//! Returns the sum of the two matrices. Throws std::invalid_argument if the dimensions don't agree.
+template<typename T>
+inline DynamicMatrix<T> operator+(DynamicMatrix<T> lhs, const DynamicMatrix<T>& rhs)
+{
+	lhs += rhs;
+	return lhs;
+}
+
+//! Returns the difference of the two matrices. Throws std::invalid_argument if the dimensions don't agree.
+template<typename T>
+inline DynamicMatrix<T> operator-(DynamicMatrix<T> lhs, const DynamicMatrix<T>& rhs)
+{
+	lhs -= rhs;
+	return lhs;
+}
+
+//! Returns the negated matrix.
+template<typename T>
+inline DynamicMatrix<T> operator-(DynamicMatrix<T> mat)
+{
+	mat *= T(-1);
+	return mat;
+}
+
+//! Returns the matrix scaled by the specified factor.
+template<typename T>
+inline DynamicMatrix<T> operator*(DynamicMatrix<T> mat, const typename DynamicMatrix<T>::ScalarType& factor)
+{
+	mat *= factor;
+	return mat;
+}
+
+//! Returns the matrix scaled by the specified factor.
+template<typename T>
+inline DynamicMatrix<T> operator*(const typename DynamicMatrix<T>::ScalarType& factor, DynamicMatrix<T> mat)
+{
+	mat *= factor;
+	return mat;
+}
+
+/**
+ * @brief Matrix product of two dynamic matrices
+ *
+ * Returns the matrix product of two matrices ([m x n]*[n x p] = [m x p]),
+ * throws std::invalid_argument if the dimensions don't agree. Larger
+ * products are computed by the cache blocked kernel of the fixed-size
+ * matrices, see gemm.h.
+ */
+template<typename T>
+inline DynamicMatrix<T> operator*(const DynamicMatrix<T>& lhs, const DynamicMatrix<T>& rhs)
+{
+	if(lhs.cols() != rhs.rows()) throw std::invalid_argument("DynamicMatrix: dimensions of the product don't agree");
+	const size_t m = lhs.rows(), n = lhs.cols(), p = rhs.cols();
+	const detail::OperationScope<T> scope(AccountedOperation::MatrixProduct, 2*m*n*p, m*n + n*p + m*p);
+	DynamicMatrix<T> result(lhs.rows(), rhs.cols(), detail::UninitializedTag());
+	detail::gemm<T>(lhs.rows(), lhs.cols(), rhs.cols(), lhs.data(), lhs.rows(), rhs.data(), rhs.rows(),
+		result.data(), result.rows());
+	return result;
+}
+
+//! Returns the product of a matrix and a column vector. Throws std::invalid_argument if the dimensions don't agree.
+template<typename T>
+inline DynamicVector<T> operator*(const DynamicMatrix<T>& lhs, const DynamicVector<T>& rhs)
+{
+	return DynamicVector<T>(lhs*static_cast<const DynamicMatrix<T>&>(rhs));
+}
+
+//! Returns the sum of the two vectors. Throws std::invalid_argument if the dimensions don't agree.
+template<typename T>
+inline DynamicVector<T> operator+(DynamicVector<T> lhs, const DynamicVector<T>& rhs)
+{
+	lhs += rhs;
+	return lhs;
+}
+
+//! Returns the difference of the two vectors. Throws std::invalid_argument if the dimensions don't agree.
+template<typename T>
+inline DynamicVector<T> operator-(DynamicVector<T> lhs, const DynamicVector<T>& rhs)
+{
+	lhs -= rhs;
+	return lhs;
+}
+
+//! Returns the negated vector.
+template<typename T>
+inline DynamicVector<T> operator-(DynamicVector<T> vec)
+{
+	vec *= T(-1);
+	return vec;
+}
+
+//! Returns the vector scaled by the specified factor.
+template<typename T>
+inline DynamicVector<T> operator*(DynamicVector<T> vec, const typename DynamicVector<T>::ScalarType& factor)
+{
+	vec *= factor;
+	return vec;
+}
+
+//! Returns the vector scaled by the specified factor.
+template<typename T>
+inline DynamicVector<T> operator*(const typename DynamicVector<T>::ScalarType& factor, DynamicVector<T> vec)
+{
+	vec *= factor;
+	return vec;
+}
+
+//! Prints the matrix to the specified stream
+template<typename T>
+inline std::ostream& operator<<(std::ostream& os, const DynamicMatrix<T>& mat)
+{
+	os << "[";
+	for(size_t i = 0; i < mat.rows(); i++) {
+		for(size_t j = 0; j + 1 < mat.cols(); j++) os << mat(i,j) << " ";
+		if(mat.cols() > 0) os << mat(i,mat.cols()-1);
+		os << ";";
+		if(i + 1 < mat.rows()) os << " ";
+	}
+	os << "]";
+
+	return os;
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+	linear_algebra_containers/eigen_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * @brief Signature of the batched eigen decomposition kernels of symmetric 3x3 matrices
+ *
+ * The count matrices are passed in structure-of-arrays layout as six streams
+ * of the entries (s00, s11, s22, s01, s02, s12). The kernels write the
+ * eigenvalues in descending order to three streams and the rotations whose
+ * matrices have the corresponding eigenvectors as columns as normalized
+ * quaternions to four streams (q0, q1, q2, q3).
+ */
+template<typename T>
+using SymmetricEigen3Function = void (*)(const T* const* tensors, T* const* eigenvalues, T* const* rotations, size_t count);
+
+/**
+ * @brief Signature of the batched singular value decomposition kernels of 3x3 matrices
+ *
+ * The count matrices are passed in structure-of-arrays layout as nine
+ * streams of their column-major entries (a00, a10, a20, a01, ..., a22). The
+ * kernels write the rotations U and V of A = U*diag(sigma)*V^T as normalized
+ * quaternions to four streams each and the singular values in descending
+ * order of their absolute values to three streams.
+ */
+template<typename T>
+using Svd3Function = void (*)(const T* const* matrices, T* const* u, T* const* sigma, T* const* v, size_t count);
+
+/**
+ * @brief Signature of the batched polar decomposition kernels of 3x3 matrices
+ *
+ * The matrices are passed as for Svd3Function. The kernels write the
+ * rotations R of A = R*S as normalized quaternions to four streams and the
+ * symmetric matrices S to six streams of the entries (s00, s11, s22, s01,
+ * s02, s12).
+ */
+template<typename T>
+using Polar3Function = void (*)(const T* const* matrices, T* const* rotations, T* const* stretches, size_t count);
+
+/**
+ * @brief Number of Jacobi sweeps of the symmetric 3x3 eigen decomposition
+ *
+ * The approximate rotations reduce the off-diagonal entries slowly in the
+ * first sweeps and cubically once they are small. Five sweeps reach the
+ * rounding error of float for all matrices, the sixth sweep the rounding
+ * error of double.
+ */
+template<typename T>
+struct JacobiSweeps : std::integral_constant<int, 6> {};
+
+template<>
+struct JacobiSweeps<float> : std::integral_constant<int, 5> {};
+
+}
+}
@@ -0,0 +1,267 @@
+/*
+	linear_algebra_containers/flop_accounting header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+// Define LIN_ALGEBRA_FLOP_ACCOUNTING to count the floating point operations
+// and the memory traffic of the matrix, vector and quaternion operations.
+// Without it the accounting functions are empty and compiled away.
+
+// Accounting is skipped while an operation is evaluated in a constant
+// expression, which requires __builtin_is_constant_evaluated
+#if defined(__has_builtin)
+	#if __has_builtin(__builtin_is_constant_evaluated)
+		#define LIN_ALGEBRA_HAS_IS_CONSTANT_EVALUATED
+	#endif
+#endif
+#if !defined(LIN_ALGEBRA_HAS_IS_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+	#define LIN_ALGEBRA_HAS_IS_CONSTANT_EVALUATED
+#endif
+
+namespace lin_algebra {
+
+//! Operations tallied by the FLOP accounting (see LIN_ALGEBRA_FLOP_ACCOUNTING)
+enum class AccountedOperation
+{
+	Elementwise,			//!< Evaluation of elementwise expressions and compound assignments
+	MatrixProduct,			//!< Matrix products
+	InnerProduct,			//!< Inner products of vectors and quaternions
+	Transpose,				//!< Assignment of a transposed matrix
+	Norm,					//!< Norms and squared norms
+	Normalize,				//!< normalize() and normalized() of vectors
+	CrossProduct,			//!< Cross products
+	Determinant,			//!< Determinants of small matrices
+	Inverse,				//!< Inverses of small matrices
+	QuaternionArithmetic,	//!< Sums, differences, scalings and conjugates of quaternions
+	QuaternionProduct,		//!< Quaternion composition
+	QuaternionNormalize,	//!< normalize() and normalized() of quaternions
+	QuaternionInverse,		//!< inverse() and invert() of quaternions
+	QuaternionLog,			//!< Quaternion::log
+	QuaternionExp,			//!< Quaternion::exp
+	QuaternionPow,			//!< Quaternion::pow
+	QuaternionComposition,	//!< Quaternion::composition
+	QuaternionDifference,	//!< Quaternion::difference
+	QuaternionSlerp,		//!< Quaternion::slerp
+	QuaternionTransform,	//!< Quaternion::transform of a single vector
+	QuaternionToMatrix,		//!< Quaternion::toMatrix
+	Count
+};
+
+//! Returns the name of the operation used in the report
+inline const char* operationName(AccountedOperation op)
+{
+	static const char* const names[] = {
+		"elementwise", "matrix product", "inner product", "transpose", "norm", "normalize", "cross product",
+		"determinant", "inverse", "Quaternion arithmetic", "Quaternion::operator*", "Quaternion::normalize",
+		"Quaternion::inverse", "Quaternion::log", "Quaternion::exp", "Quaternion::pow", "Quaternion::composition",
+		"Quaternion::difference", "Quaternion::slerp", "Quaternion::transform", "Quaternion::toMatrix"
+	};
+	static_assert(sizeof(names)/sizeof(names[0]) == size_t(AccountedOperation::Count), "Every operation needs a name");
+	return names[size_t(op)];
+}
+
+//! Number of calls, floating point operations and bytes of memory traffic of an operation
+struct OperationTally
+{
+	std::uint64_t calls = 0;
+	std::uint64_t flops = 0;
+	std::uint64_t bytes = 0;
+
+	//! Returns the arithmetic intensity (floating point operations per byte)
+	double intensity() const { return bytes ? double(flops)/double(bytes) : 0.0; }
+
+	OperationTally& operator+=(const OperationTally& other)
+	{
+		calls += other.calls;
+		flops += other.flops;
+		bytes += other.bytes;
+		return *this;
+	}
+};
+
+//! Tallies of all accounted operations
+class OperationTallies
+{
+private:
+	std::array<OperationTally, size_t(AccountedOperation::Count)> tallies_;
+
+public:
+	OperationTally& operator[](AccountedOperation op) { return tallies_[size_t(op)]; }
+	const OperationTally& operator[](AccountedOperation op) const { return tallies_[size_t(op)]; }
+
+	//! Returns the sum of the tallies of all operations
+	OperationTally total() const
+	{
+		OperationTally sum;
+		for(const OperationTally& tally : tallies_) sum += tally;
+		return sum;
+	}
+
+	//! Adds the tallies of another thread
+	OperationTallies& operator+=(const OperationTallies& other)
+	{
+		for(size_t i = 0; i < tallies_.size(); i++) tallies_[i] += other.tallies_[i];
+		return *this;
+	}
+};
+
+#if defined(LIN_ALGEBRA_FLOP_ACCOUNTING)
+//! True if the operations are accounted (LIN_ALGEBRA_FLOP_ACCOUNTING is defined)
+constexpr bool flopAccountingEnabled = true;
+#else
+constexpr bool flopAccountingEnabled = false;
+#endif
+
+namespace detail {
+
+//! Tallies of the calling thread and the nesting depth of the running accounted operations
+struct AccountingState
+{
+	OperationTallies tallies;
+	size_t depth = 0;
+};
+
+inline AccountingState& accountingState()
+{
+	static thread_local AccountingState state;
+	return state;
+}
+
+//! Returns true during the evaluation of a constant expression (false if the compiler can't tell)
+constexpr bool isConstantEvaluated()
+{
+#if defined(LIN_ALGEBRA_HAS_IS_CONSTANT_EVALUATED)
+	return __builtin_is_constant_evaluated();
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Starts an accounted operation
+ *
+ * Adds a call with the specified number of floating point operations and
+ * the memory traffic of reading and writing the specified number of entries
+ * of type T once to the tallies of the calling thread. Operations started
+ * before the matching endOperation() are part of this operation and are not
+ * tallied separately, e.g. the products inside of Quaternion::slerp. The
+ * floating point operations are the arithmetic operations and calls of math
+ * functions performed by the implementation (see CountingScalar), the memory
+ * traffic is the size of the operands and the result. Does nothing without
+ * LIN_ALGEBRA_FLOP_ACCOUNTING.
+ */
+template<typename T>
+inline constexpr void beginOperation(AccountedOperation op, size_t flops, size_t entries)
+{
+#if defined(LIN_ALGEBRA_FLOP_ACCOUNTING)
+	if(isConstantEvaluated()) return;
+	AccountingState& state = accountingState();
+	if(state.depth++ == 0) {
+		OperationTally& tally = state.tallies[op];
+		tally.calls++;
+		tally.flops += flops;
+		tally.bytes += entries*sizeof(T);
+	}
+#else
+	(void)op; (void)flops; (void)entries;
+#endif
+}
+
+//! Ends the innermost operation started with beginOperation()
+template<typename T>
+inline constexpr void endOperation()
+{
+#if defined(LIN_ALGEBRA_FLOP_ACCOUNTING)
+	if(isConstantEvaluated()) return;
+	accountingState().depth--;
+#endif
+}
+
+//! Accounts the operation from its construction to its destruction (for functions that are not constexpr)
+template<typename T>
+class OperationScope
+{
+public:
+	OperationScope(AccountedOperation op, size_t flops, size_t entries) { beginOperation<T>(op, flops, entries); }
+	~OperationScope() { endOperation<T>(); }
+
+	OperationScope(const OperationScope&) = delete;
+	OperationScope& operator=(const OperationScope&) = delete;
+};
+
+}
+
+//! Returns the tallies of the operations performed by the calling thread (all zero without LIN_ALGEBRA_FLOP_ACCOUNTING)
+inline OperationTallies operationTallies()
+{
+	return detail::accountingState().tallies;
+}
+
+//! Resets the tallies of the calling thread
+inline void resetOperationTallies()
+{
+	detail::accountingState().tallies = OperationTallies();
+}
+
+/**
+ * @brief Print a report of the tallies
+ *
+ * Prints the calls, floating point operations, bytes and arithmetic
+ * intensity of every operation that was called. If the runtime in seconds
+ * is specified, the achieved GFLOP/s and GB/s are printed as well.
+ */
+inline void printOperationReport(std::ostream& os, const OperationTallies& tallies, double seconds = 0.0)
+{
+	const std::ios_base::fmtflags flags = os.flags();
+	const std::streamsize precision = os.precision();
+
+	os << std::left << std::setw(26) << "operation" << std::right << std::setw(14) << "calls" << std::setw(18) << "flops"
+		<< std::setw(18) << "bytes" << std::setw(12) << "flop/byte" << "\n";
+	os << std::fixed << std::setprecision(3);
+	for(size_t i = 0; i <= size_t(AccountedOperation::Count); i++) {
+		const bool isTotal = (i == size_t(AccountedOperation::Count));
+		const OperationTally tally = isTotal ? tallies.total() : tallies[AccountedOperation(i)];
+		if(!isTotal && tally.calls == 0) continue;
+		os << std::left << std::setw(26) << (isTotal ? "total" : operationName(AccountedOperation(i))) << std::right
+			<< std::setw(14) << tally.calls << std::setw(18) << tally.flops << std::setw(18) << tally.bytes
+			<< std::setw(12) << tally.intensity() << "\n";
+	}
+	if(seconds > 0.0) {
+		const OperationTally total = tallies.total();
+		os << "GFLOP/s: " << double(total.flops)/seconds*1e-9 << ", GB/s: " << double(total.bytes)/seconds*1e-9 << "\n";
+	}
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+}
@@ -0,0 +1,327 @@
+/*
+	linear_algebra_containers/gemm header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "gemm_kernels.h"
+#include "cpu_dispatch.h"
+#include "unrolled_kernels.h"
+#include "thread_pool.h"
+
+namespace lin_algebra {
+namespace detail {
+
+//! Returns a thread local scratch buffer with room for at least size elements
+template<typename T>
+inline T* gemmBuffer(size_t which, size_t size)
+{
+	thread_local std::vector<T> buffers[2];
+	if(buffers[which].size() < size) buffers[which].resize(size);
+	return buffers[which].data();
+}
+
+/**
+ * @brief Pack a block of the left matrix
+ *
+ * Copies the mc x kc block starting at a (entry (i,k) at a[i*rsa + k*csa],
+ * i.e. rsa = 1 and csa = lda for column-major matrices) into consecutive MR
+ * row panels. Inside of a panel the entries are stored k-major so that the
+ * micro kernel reads them with unit stride. Rows beyond mc are padded with
+ * zeros.
+ */
+template<typename T, size_t MR>
+inline void gemmPackLhs(size_t mc, size_t kc, const T* a, size_t rsa, size_t csa, T* buffer)
+{
+	for(size_t ir = 0; ir < mc; ir += MR) {
+		const size_t mr = (mc - ir < MR) ? mc - ir : MR;
+		for(size_t k = 0; k < kc; k++) {
+			const T* ak = a + ir*rsa + k*csa;
+			if(rsa == 1) {
+				for(size_t i = 0; i < mr; i++) buffer[i] = ak[i];
+			} else {
+				for(size_t i = 0; i < mr; i++) buffer[i] = ak[i*rsa];
+			}
+			for(size_t i = mr; i < MR; i++) buffer[i] = T(0);
+			buffer += MR;
+		}
+	}
+}
+
+/**
+ * @brief Pack a block of the right matrix
+ *
+ * Copies the kc x nc block starting at b (entry (k,j) at b[k*rsb + j*csb])
+ * into consecutive NR column panels stored k-major. Columns beyond nc are
+ * padded with zeros.
+ */
+template<typename T, size_t NR>
+inline void gemmPackRhs(size_t kc, size_t nc, const T* b, size_t rsb, size_t csb, T* buffer)
+{
+	for(size_t jr = 0; jr < nc; jr += NR) {
+		const size_t nr = (nc - jr < NR) ? nc - jr : NR;
+		for(size_t k = 0; k < kc; k++) {
+			for(size_t j = 0; j < nr; j++) buffer[j] = b[k*rsb + (jr + j)*csb];
+			for(size_t j = nr; j < NR; j++) buffer[j] = T(0);
+			buffer += NR;
+		}
+	}
+}
+
+/**
+ * @brief Matrix product without packing
+ *
+ * Computes c = a*b for a [m x n] and b [n x p] (all column-major) as a
+ * sequence of column updates so that the innermost loop runs with unit stride
+ * over the columns of a and c. Used for small products where packing does
+ * not pay off.
+ */
+template<typename T>
+inline void gemmSmall(size_t m, size_t n, size_t p, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc)
+{
+	for(size_t j = 0; j < p; j++) {
+		T* cj = c + j*ldc;
+		for(size_t i = 0; i < m; i++) cj[i] = T(0);
+		for(size_t k = 0; k < n; k++) {
+			const T bkj = b[k + j*ldb];
+			const T* ak = a + k*lda;
+			for(size_t i = 0; i < m; i++) {
+				cj[i] += ak[i]*bkj;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Matrix product of strided operands without packing
+ *
+ * Computes c = a*b for a [m x n] with the entry (i,k) at a[i*rsa + k*csa],
+ * b [n x p] with the entry (k,j) at b[k*rsb + j*csb] and column-major c. Used
+ * for small products of operands that are not stored column by column.
+ */
+template<typename T>
+inline void gemmSmallStrided(size_t m, size_t n, size_t p, const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+{
+	for(size_t j = 0; j < p; j++) {
+		for(size_t i = 0; i < m; i++) {
+			T sum(0);
+			for(size_t k = 0; k < n; k++) sum += a[i*rsa + k*csa]*b[k*rsb + j*csb];
+			c[i + j*ldc] = sum;
+		}
+	}
+}
+
+/**
+ * @brief Cache blocked matrix product
+ *
+ * Computes c = a*b for a [m x n] and b [n x p] with the strides of gemmPackLhs
+ * and gemmPackRhs and column-major c. As the operands are packed anyway,
+ * the strides don't affect the speed of the kernel. The loops
+ * over the result are blocked for the cache hierarchy as described by
+ * GemmBlocking and both operands are packed into contiguous panels before
+ * the register tiles are computed by the micro kernel selected by
+ * GemmMicroKernelSelect.
+ */
+template<typename T>
+inline void gemmBlocked(size_t m, size_t n, size_t p, const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+{
+	typedef GemmBlocking<T> Blocking;
+	const size_t MR = Blocking::MR;
+	const size_t NR = Blocking::NR;
+	const size_t KC = Blocking::KC;
+	const size_t MC = Blocking::MC;
+	const size_t NC = Blocking::NC;
+
+	const GemmMicroKernelFunction<T> microKernel = GemmMicroKernelSelect<T>::get();
+
+	T* packedLhs = gemmBuffer<T>(0, MC*KC);
+	T* packedRhs = gemmBuffer<T>(1, KC*(((p < NC) ? p : NC) + NR));
+
+	for(size_t jc = 0; jc < p; jc += NC) {
+		const size_t nc = (p - jc < NC) ? p - jc : NC;
+
+		for(size_t pc = 0; pc < n; pc += KC) {
+			const size_t kc = (n - pc < KC) ? n - pc : KC;
+			const bool accumulate = (pc != 0);
+			gemmPackRhs<T,Blocking::NR>(kc, nc, b + pc*rsb + jc*csb, rsb, csb, packedRhs);
+
+			for(size_t ic = 0; ic < m; ic += MC) {
+				const size_t mc = (m - ic < MC) ? m - ic : MC;
+				gemmPackLhs<T,Blocking::MR>(mc, kc, a + ic*rsa + pc*csa, rsa, csa, packedLhs);
+
+				for(size_t jr = 0; jr < nc; jr += NR) {
+					const size_t nr = (nc - jr < NR) ? nc - jr : NR;
+					for(size_t ir = 0; ir < mc; ir += MR) {
+						const size_t mr = (mc - ir < MR) ? mc - ir : MR;
+						microKernel(kc, packedLhs + ir*kc, packedRhs + jr*kc,
+							c + (ic + ir) + (jc + jr)*ldc, ldc, mr, nr, accumulate);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Parallel cache blocked matrix product
+ *
+ * Computes c = a*b for a [m x n] and b [n x p] (with the strides of
+ * gemmBlocked) and column-major c on the threads of the specified pool. The result is split into tiles of MC rows,
+ * so that every thread keeps its packed block of the left matrix in its own
+ * L2 cache, and into column tiles of a multiple of NR columns. There are at
+ * least four tiles per thread (if the result is large enough) so that the
+ * work stealing of the pool can balance the load. Every tile is computed by
+ * gemmBlocked with the thread local packing buffers of its thread.
+ */
+template<typename T>
+inline void gemmParallel(size_t m, size_t n, size_t p, const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc, ThreadPool& pool)
+{
+	typedef GemmBlocking<T> Blocking;
+	const size_t MC = Blocking::MC;
+	const size_t NR = Blocking::NR;
+
+	const size_t rowTiles = (m + MC - 1)/MC;
+	const size_t minTiles = 4*pool.threadCount();
+	const size_t maxColumnTiles = (p + NR - 1)/NR;
+	size_t columnTiles = (minTiles + rowTiles - 1)/rowTiles;
+	if(columnTiles > maxColumnTiles) columnTiles = maxColumnTiles;
+	if(columnTiles == 0) columnTiles = 1;
+	const size_t tileColumns = ((p + columnTiles - 1)/columnTiles + NR - 1)/NR*NR;
+	columnTiles = (p + tileColumns - 1)/tileColumns;
+
+	pool.parallelFor(rowTiles*columnTiles, [=](size_t tile) {
+		const size_t i = (tile % rowTiles)*MC;
+		const size_t j = (tile / rowTiles)*tileColumns;
+		const size_t mc = (m - i < MC) ? m - i : MC;
+		const size_t nc = (p - j < tileColumns) ? p - j : tileColumns;
+		gemmBlocked(mc, n, nc, a + i*rsa, rsa, csa, b + j*csb, rsb, csb, c + i + j*ldc, ldc);
+	});
+}
+
+//! Returns whether the blocked kernel should be used for a product of the specified dimensions
+template<typename T>
+inline bool gemmUseBlocked(size_t m, size_t n, size_t p)
+{
+	return (m >= GemmBlocking<T>::MR) && (p >= GemmBlocking<T>::NR) && (m*n*p >= 32*32*32);
+}
+
+//! Returns the threshold of the parallel matrix product (see setParallelGemmThreshold())
+inline std::atomic<double>& parallelGemmThresholdValue()
+{
+	static std::atomic<double> threshold(2.0*256*256*256);
+	return threshold;
+}
+
+//! Returns whether the product of the specified dimensions should be computed in parallel
+template<typename T>
+inline bool gemmUseParallel(size_t m, size_t n, size_t p)
+{
+	return gemmUseBlocked<T>(m, n, p) && (2.0*double(m)*double(n)*double(p) >= parallelGemmThresholdValue().load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Matrix product of strided operands
+ *
+ * Computes c = a*b for a [m x n] with the entry (i,k) at a[i*rsa + k*csa],
+ * b [n x p] with the entry (k,j) at b[k*rsb + j*csb] and column-major c with
+ * leading dimension ldc. c must not alias a or b.
+ */
+template<typename T>
+inline void gemm(size_t m, size_t n, size_t p, const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+{
+#if !defined(LIN_ALGEBRA_NO_THREADS)
+	if(gemmUseParallel<T>(m, n, p) && ThreadPool::instance().threadCount() > 1) {
+		gemmParallel(m, n, p, a, rsa, csa, b, rsb, csb, c, ldc, ThreadPool::instance());
+		return;
+	}
+#endif
+	if(gemmUseBlocked<T>(m, n, p)) {
+		gemmBlocked(m, n, p, a, rsa, csa, b, rsb, csb, c, ldc);
+	} else if(rsa == 1 && rsb == 1) {
+		gemmSmall(m, n, p, a, csa, b, csb, c, ldc);
+	} else {
+		gemmSmallStrided(m, n, p, a, rsa, csa, b, rsb, csb, c, ldc);
+	}
+}
+
+//! Computes c = a*b for column-major a [m x n] and b [n x p]. c must not alias a or b.
+template<typename T>
+inline void gemm(size_t m, size_t n, size_t p, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc)
+{
+	gemm(m, n, p, a, 1, lda, b, 1, ldb, c, ldc);
+}
+
+template<typename T, size_t m, size_t n, size_t p>
+inline constexpr void gemmFixed(const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc, std::true_type)
+{
+	UnrolledProduct<T,m,n,p>::run(a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+template<typename T, size_t m, size_t n, size_t p>
+inline void gemmFixed(const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc, std::false_type)
+{
+	gemm(m, n, p, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+/**
+ * @brief Matrix product of operands with compile-time dimensions
+ *
+ * Computes c = a*b with the strides of gemm. Products of small operands
+ * (see IsUnrolledProduct) are expanded at compile time by UnrolledProduct
+ * (also in constant expressions), all other products are computed by gemm.
+ */
+template<typename T, size_t m, size_t n, size_t p>
+inline constexpr void gemmFixed(const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+{
+	gemmFixed<T,m,n,p>(a, rsa, csa, b, rsb, csb, c, ldc, IsUnrolledProduct<m,n,p>());
+}
+
+}
+
+/**
+ * @brief Set the threshold of the parallel matrix product
+ *
+ * Matrix products with at least the specified number of floating point
+ * operations (2*m*n*p for a [m x n]*[n x p] product) are distributed over the
+ * threads of ThreadPool::instance(). The default of 2*256^3 operations
+ * corresponds to the product of two 256 x 256 matrices. Define
+ * LIN_ALGEBRA_NO_THREADS to always compute products on the calling thread.
+ */
+inline void setParallelGemmThreshold(double flops)
+{
+	detail::parallelGemmThresholdValue().store(flops);
+}
+
+//! Returns the threshold of the parallel matrix product (see setParallelGemmThreshold())
+inline double parallelGemmThreshold()
+{
+	return detail::parallelGemmThresholdValue().load();
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+	linear_algebra_containers/gemm_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * Blocking parameters of the matrix product kernel
+ *
+ * The micro kernel computes a MR x NR tile of the result in registers. The
+ * packed KC x NR panel of the right matrix is meant to stay in the L1 cache
+ * while the packed MC x KC block of the left matrix stays in the L2 cache.
+ * NC limits the number of columns of the right matrix that are packed at once.
+ * This default is used for non floating point types where a small tile keeps
+ * the number of live temporaries low.
+ */
+template<typename T, typename Enable = void>
+struct GemmBlocking
+{
+	static constexpr size_t MR = 4;
+	static constexpr size_t NR = 4;
+	static constexpr size_t KC = 128;
+	static constexpr size_t MC = 64;
+	static constexpr size_t NC = 1024;
+};
+
+//! Blocking parameters for float and double (two 256 bit registers per tile column)
+template<typename T>
+struct GemmBlocking<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static constexpr size_t MR = (sizeof(T) <= 8) ? 64/sizeof(T) : 4;
+	static constexpr size_t NR = 6;
+	static constexpr size_t KC = 256;
+	static constexpr size_t MC = 16*MR;
+	static constexpr size_t NC = 680*NR;
+};
+
+//! Signature of the micro kernels of the matrix product
+template<typename T>
+using GemmMicroKernelFunction = void (*)(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr, bool accumulate);
+
+/**
+ * @brief Compute one register tile of the product
+ *
+ * Multiplies a packed MR x kc panel with a packed kc x NR panel. Only the
+ * upper left mr x nr part of the tile is written back to c. If accumulate is
+ * set the tile is added to the existing values of c.
+ */
+template<typename T, size_t MR, size_t NR>
+inline void gemmMicroKernel(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr, bool accumulate)
+{
+	T acc[MR*NR];
+	for(size_t i = 0; i < MR*NR; i++) acc[i] = T(0);
+
+	for(size_t k = 0; k < kc; k++) {
+		for(size_t j = 0; j < NR; j++) {
+			const T bkj = b[j];
+			for(size_t i = 0; i < MR; i++) {
+				acc[i + j*MR] += a[i]*bkj;
+			}
+		}
+		a += MR;
+		b += NR;
+	}
+
+	for(size_t j = 0; j < nr; j++) {
+		T* cj = c + j*ldc;
+		if(accumulate) {
+			for(size_t i = 0; i < mr; i++) cj[i] += acc[i + j*MR];
+		} else {
+			for(size_t i = 0; i < mr; i++) cj[i] = acc[i + j*MR];
+		}
+	}
+}
+
+}
+}
@@ -0,0 +1,180 @@
+/*
+	linear_algebra_containers/householder_qr header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "qr_kernels.h"
+#include "triangular_kernels.h"
+
+namespace lin_algebra {
+
+/**
+ * Householder QR decomposition of a matrix with at least as many rows as columns
+ *
+ * Factorizes a [m x n] matrix A (m >= n) into A = Q*R with an orthogonal
+ * [m x m] matrix Q and an upper triangular [n x n] matrix R. Q is not formed
+ * explicitly but stored as n Householder reflections below the diagonal of
+ * a copy of the matrix (R is stored on and above the diagonal). Matrices
+ * with at least 64 columns are factorized by a blocked algorithm that
+ * applies the reflections of every panel in their compact WY representation
+ * by the cache blocked matrix product (see qr_kernels.h).
+ *
+ * The decomposition solves linear least squares problems min |A*x - b|
+ * without forming the normal equations A^T*A*x = A^T*b, whose condition is
+ * the square of the condition of A (see solve() and leastSquares()).
+ *
+ * @tparam T Type of the entries.
+ * @tparam m Number of rows of the matrix.
+ * @tparam n Number of columns of the matrix.
+ * @tparam Storage Storage policy of the factorized matrix, see storage.h.
+ */
+template<typename T, size_t m, size_t n, typename Storage = DenseStorage>
+class HouseholderQR
+{
+	static_assert(m >= n, "The QR decomposition requires at least as many rows as columns");
+
+public:
+	//! Type of the factorized matrix
+	typedef Matrix<T,m,n,Storage> MatrixType;
+	//! Type of the triangular factor R
+	typedef Matrix<T,n,n,Storage> MatrixRType;
+
+private:
+	MatrixType qr_;
+	std::array<T,n> tau_;
+
+public:
+	//! Computes the decomposition of the specified matrix
+	explicit HouseholderQR(const MatrixType& matrix)
+		: qr_(matrix)
+	{
+		factorize();
+	}
+
+	//! Computes the decomposition in the entries of the specified expiring matrix
+	explicit HouseholderQR(MatrixType&& matrix)
+		: qr_(std::move(matrix))
+	{
+		factorize();
+	}
+
+	/**
+	 * @brief Returns the factorized matrix
+	 *
+	 * R is stored on and above the diagonal, the vector v of the reflection
+	 * H(k) = I - tau()[k]*v*v^T below the diagonal of column k (v(k) = 1 is not
+	 * stored). Q = H(0)*H(1)*...*H(n - 1).
+	 */
+	const MatrixType& matrixQR() const { return qr_; }
+
+	//! Returns the scaling factors of the Householder reflections (see matrixQR())
+	const std::array<T,n>& tau() const { return tau_; }
+
+	//! Returns the upper triangular factor R
+	MatrixRType matrixR() const
+	{
+		MatrixRType r;
+		for(size_t j = 0; j < n; j++) {
+			for(size_t i = 0; i <= j; i++) r(i,j) = qr_(i,j);
+		}
+		return r;
+	}
+
+	//! Returns false if R has a zero on its diagonal, i.e. the columns of the matrix are linearly dependent
+	bool hasFullRank() const
+	{
+		for(size_t i = 0; i < n; i++) {
+			if(qr_(i,i) == T(0)) return false;
+		}
+		return true;
+	}
+
+	//! Overwrites the k columns of B with Q^T*B
+	template<size_t k, typename RhsStorage>
+	void applyQTransposed(Matrix<T,m,k,RhsStorage>& rhs) const
+	{
+		typedef Matrix<T,m,k,RhsStorage> RhsType;
+		detail::qrApplyQTransposed(m, n, qr_.data(), MatrixType::leading_dimension, tau_.data(), k, rhs.data(), RhsType::leading_dimension);
+	}
+
+	/**
+	 * @brief Solve the least squares problem for the specified right-hand sides
+	 *
+	 * Returns the [n x k] matrix X that minimizes the euclidean norm of every
+	 * column of A*X - B by applying Q^T to B and a back substitution with R.
+	 * For square matrices X is the solution of A*X = B. The matrix must have
+	 * full rank.
+	 */
+	template<size_t k, typename RhsStorage>
+	Matrix<T,n,k,RhsStorage> solve(const Matrix<T,m,k,RhsStorage>& rhs) const
+	{
+		typedef Matrix<T,m,k,RhsStorage> RhsType;
+		RhsType work(rhs);
+		applyQTransposed(work);
+		detail::solveUpper(n, k, qr_.data(), MatrixType::leading_dimension, work.data(), RhsType::leading_dimension, false);
+
+		Matrix<T,n,k,RhsStorage> result;
+		for(size_t j = 0; j < k; j++) {
+			for(size_t i = 0; i < n; i++) result(i,j) = work(i,j);
+		}
+		return result;
+	}
+
+private:
+	void factorize()
+	{
+		detail::qrFactorize<T,m,n>(qr_.data(), MatrixType::leading_dimension, tau_.data());
+	}
+};
+
+/**
+ * @brief Solve a linear least squares problem
+ *
+ * Returns the [n x k] matrix X that minimizes the euclidean norm of every
+ * column of A*X - B for a [m x n] matrix A with full rank (m >= n). The
+ * problem is solved by a HouseholderQR of A, the normal equations are never
+ * formed.
+ */
+template<typename T, size_t m, size_t n, typename Storage, size_t k, typename RhsStorage>
+inline Matrix<T,n,k,RhsStorage> leastSquares(const Matrix<T,m,n,Storage>& a, const Matrix<T,m,k,RhsStorage>& b)
+{
+	return HouseholderQR<T,m,n,Storage>(a).solve(b);
+}
+
+//! Solves the least squares problem min |A*X - B| (see above) in the entries of the expiring matrix A
+template<typename T, size_t m, size_t n, typename Storage, size_t k, typename RhsStorage>
+inline Matrix<T,n,k,RhsStorage> leastSquares(Matrix<T,m,n,Storage>&& a, const Matrix<T,m,k,RhsStorage>& b)
+{
+	return HouseholderQR<T,m,n,Storage>(std::move(a)).solve(b);
+}
+
+}
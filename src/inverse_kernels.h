@@ -0,0 +1,245 @@
+/*
+	linear_algebra_containers/inverse_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace lin_algebra {
+namespace detail {
+
+//! Signature of the batched inversion kernels
+template<typename T>
+using InverseFunction = void (*)(const T* in, T* out, size_t count);
+
+/**
+ * Closed-form determinant and inverse of small square matrices
+ *
+ * The matrices are stored column-major with the specified leading dimension,
+ * i.e. the entry (i,j) is m[i + j*ld]. The inverse is computed as the
+ * adjugate divided by the determinant with fully unrolled cofactor
+ * expansions. The input is read completely before the output is written, so
+ * out may point to the same matrix as m. The result is not finite if the
+ * matrix is singular.
+ * @tparam T Type of the entries.
+ * @tparam n Dimension of the matrices (2, 3 or 4).
+ */
+template<typename T, size_t n>
+struct SmallInverse;
+
+template<typename T>
+struct SmallInverse<T,2>
+{
+	//! Number of arithmetic operations of determinant() and invert()
+	static constexpr size_t determinant_flops = 3;
+	static constexpr size_t inverse_flops = 10;
+
+	static T determinant(const T* m, size_t ld)
+	{
+		return m[0]*m[ld + 1] - m[ld]*m[1];
+	}
+
+	//! Writes the inverse of m to out and returns the determinant of m
+	static T invert(const T* m, size_t ld, T* out, size_t ldOut)
+	{
+		const T a00 = m[0], a10 = m[1], a01 = m[ld], a11 = m[ld + 1];
+		const T det = a00*a11 - a01*a10;
+		const T f = T(1)/det;
+		out[0] = a11*f;
+		out[1] = -a10*f;
+		out[ldOut] = -a01*f;
+		out[ldOut + 1] = a00*f;
+		return det;
+	}
+};
+
+template<typename T>
+struct SmallInverse<T,3>
+{
+	//! Number of arithmetic operations of determinant() and invert()
+	static constexpr size_t determinant_flops = 14;
+	static constexpr size_t inverse_flops = 42;
+
+	static T determinant(const T* m, size_t ld)
+	{
+		const T* c0 = m;
+		const T* c1 = m + ld;
+		const T* c2 = m + 2*ld;
+		return c0[0]*(c1[1]*c2[2] - c2[1]*c1[2])
+			+ c1[0]*(c2[1]*c0[2] - c0[1]*c2[2])
+			+ c2[0]*(c0[1]*c1[2] - c1[1]*c0[2]);
+	}
+
+	//! Writes the inverse of m to out and returns the determinant of m
+	static T invert(const T* m, size_t ld, T* out, size_t ldOut)
+	{
+		const T a00 = m[0], a10 = m[1], a20 = m[2];
+		const T a01 = m[ld], a11 = m[ld + 1], a21 = m[ld + 2];
+		const T a02 = m[2*ld], a12 = m[2*ld + 1], a22 = m[2*ld + 2];
+
+		// First column of the adjugate
+		const T b00 = a11*a22 - a12*a21;
+		const T b10 = a12*a20 - a10*a22;
+		const T b20 = a10*a21 - a11*a20;
+
+		const T det = a00*b00 + a01*b10 + a02*b20;
+		const T f = T(1)/det;
+
+		out[0] = b00*f;
+		out[1] = b10*f;
+		out[2] = b20*f;
+		out[ldOut] = (a02*a21 - a01*a22)*f;
+		out[ldOut + 1] = (a00*a22 - a02*a20)*f;
+		out[ldOut + 2] = (a01*a20 - a00*a21)*f;
+		out[2*ldOut] = (a01*a12 - a02*a11)*f;
+		out[2*ldOut + 1] = (a02*a10 - a00*a12)*f;
+		out[2*ldOut + 2] = (a00*a11 - a01*a10)*f;
+		return det;
+	}
+};
+
+template<typename T>
+struct SmallInverse<T,4>
+{
+	//! Number of arithmetic operations of determinant() and invert()
+	static constexpr size_t determinant_flops = 47;
+	static constexpr size_t inverse_flops = 152;
+
+	static T determinant(const T* m, size_t ld)
+	{
+		const T* c0 = m;
+		const T* c1 = m + ld;
+		const T* c2 = m + 2*ld;
+		const T* c3 = m + 3*ld;
+
+		// 2x2 minors of the upper two rows (s) and of the lower two rows (c)
+		const T s0 = c0[0]*c1[1] - c0[1]*c1[0];
+		const T s1 = c0[0]*c2[1] - c0[1]*c2[0];
+		const T s2 = c0[0]*c3[1] - c0[1]*c3[0];
+		const T s3 = c1[0]*c2[1] - c1[1]*c2[0];
+		const T s4 = c1[0]*c3[1] - c1[1]*c3[0];
+		const T s5 = c2[0]*c3[1] - c2[1]*c3[0];
+		const T k5 = c2[2]*c3[3] - c2[3]*c3[2];
+		const T k4 = c1[2]*c3[3] - c1[3]*c3[2];
+		const T k3 = c1[2]*c2[3] - c1[3]*c2[2];
+		const T k2 = c0[2]*c3[3] - c0[3]*c3[2];
+		const T k1 = c0[2]*c2[3] - c0[3]*c2[2];
+		const T k0 = c0[2]*c1[3] - c0[3]*c1[2];
+		return s0*k5 - s1*k4 + s2*k3 + s3*k2 - s4*k1 + s5*k0;
+	}
+
+	//! Writes the inverse of m to out and returns the determinant of m
+	static T invert(const T* m, size_t ld, T* out, size_t ldOut)
+	{
+		const T a00 = m[0], a10 = m[1], a20 = m[2], a30 = m[3];
+		const T a01 = m[ld], a11 = m[ld + 1], a21 = m[ld + 2], a31 = m[ld + 3];
+		const T a02 = m[2*ld], a12 = m[2*ld + 1], a22 = m[2*ld + 2], a32 = m[2*ld + 3];
+		const T a03 = m[3*ld], a13 = m[3*ld + 1], a23 = m[3*ld + 2], a33 = m[3*ld + 3];
+
+		// 2x2 minors of the upper two rows (s) and of the lower two rows (c)
+		const T s0 = a00*a11 - a10*a01;
+		const T s1 = a00*a12 - a10*a02;
+		const T s2 = a00*a13 - a10*a03;
+		const T s3 = a01*a12 - a11*a02;
+		const T s4 = a01*a13 - a11*a03;
+		const T s5 = a02*a13 - a12*a03;
+		const T k5 = a22*a33 - a32*a23;
+		const T k4 = a21*a33 - a31*a23;
+		const T k3 = a21*a32 - a31*a22;
+		const T k2 = a20*a33 - a30*a23;
+		const T k1 = a20*a32 - a30*a22;
+		const T k0 = a20*a31 - a30*a21;
+
+		const T det = s0*k5 - s1*k4 + s2*k3 + s3*k2 - s4*k1 + s5*k0;
+		const T f = T(1)/det;
+
+		T* o0 = out;
+		T* o1 = out + ldOut;
+		T* o2 = out + 2*ldOut;
+		T* o3 = out + 3*ldOut;
+		o0[0] = (a11*k5 - a12*k4 + a13*k3)*f;
+		o0[1] = (-a10*k5 + a12*k2 - a13*k1)*f;
+		o0[2] = (a10*k4 - a11*k2 + a13*k0)*f;
+		o0[3] = (-a10*k3 + a11*k1 - a12*k0)*f;
+		o1[0] = (-a01*k5 + a02*k4 - a03*k3)*f;
+		o1[1] = (a00*k5 - a02*k2 + a03*k1)*f;
+		o1[2] = (-a00*k4 + a01*k2 - a03*k0)*f;
+		o1[3] = (a00*k3 - a01*k1 + a02*k0)*f;
+		o2[0] = (a31*s5 - a32*s4 + a33*s3)*f;
+		o2[1] = (-a30*s5 + a32*s2 - a33*s1)*f;
+		o2[2] = (a30*s4 - a31*s2 + a33*s0)*f;
+		o2[3] = (-a30*s3 + a31*s1 - a32*s0)*f;
+		o3[0] = (-a21*s5 + a22*s4 - a23*s3)*f;
+		o3[1] = (a20*s5 - a22*s2 + a23*s1)*f;
+		o3[2] = (-a20*s4 + a21*s2 - a23*s0)*f;
+		o3[3] = (a20*s3 - a21*s1 + a22*s0)*f;
+		return det;
+	}
+};
+
+/**
+ * @brief Invert a 4x4 affine transformation
+ *
+ * Inverts the transformation [A t; 0 1] with an invertible 3x3 block A and
+ * translation t as [inv(A) -inv(A)*t; 0 1]. If rigid is true A must be a
+ * rotation and inv(A) is its transposed. Storage as in SmallInverse; out
+ * may point to the same matrix as m.
+ */
+template<typename T>
+inline void affineInverse4(const T* m, size_t ld, T* out, size_t ldOut, bool rigid)
+{
+	T a[9], b[9];
+	for(size_t j = 0; j < 3; j++) {
+		for(size_t i = 0; i < 3; i++) a[i + 3*j] = m[i + j*ld];
+	}
+	const T tx = m[3*ld], ty = m[3*ld + 1], tz = m[3*ld + 2];
+
+	if(rigid) {
+		for(size_t j = 0; j < 3; j++) {
+			for(size_t i = 0; i < 3; i++) b[i + 3*j] = a[j + 3*i];
+		}
+	} else {
+		SmallInverse<T,3>::invert(a, 3, b, 3);
+	}
+
+	for(size_t j = 0; j < 3; j++) {
+		for(size_t i = 0; i < 3; i++) out[i + j*ldOut] = b[i + 3*j];
+		out[3 + j*ldOut] = T(0);
+	}
+	out[3*ldOut] = -(b[0]*tx + b[3]*ty + b[6]*tz);
+	out[3*ldOut + 1] = -(b[1]*tx + b[4]*ty + b[7]*tz);
+	out[3*ldOut + 2] = -(b[2]*tx + b[5]*ty + b[8]*tz);
+	out[3*ldOut + 3] = T(1);
+}
+
+//! Inverts count n x n matrices stored one after another without padding
+template<typename T, size_t n>
+inline void invertMatrices(const T* in, T* out, size_t count)
+{
+	for(size_t i = 0; i < count; i++) SmallInverse<T,n>::invert(in + n*n*i, n, out + n*n*i, n);
+}
+
+}
+}
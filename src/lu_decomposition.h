@@ -0,0 +1,151 @@
+/*
+	linear_algebra_containers/lu_decomposition header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "matrix.h"
+#include "column_vector.h"
+#include "lu_kernels.h"
+#include "triangular_kernels.h"
+
+namespace lin_algebra {
+
+/**
+ * LU decomposition with partial pivoting of a square matrix
+ *
+ * Factorizes a [n x n] matrix A into P*A = L*U with a permutation matrix P,
+ * a unit lower triangular matrix L and an upper triangular matrix U. The
+ * factors are computed in place in a copy of the matrix (L below and U on
+ * and above the diagonal), so passing an expiring heap matrix doesn't
+ * allocate. Matrices with up to 8 rows are factorized by unrolled code,
+ * matrices with at least 64 rows by a blocked right-looking algorithm whose
+ * trailing updates are computed by the cache blocked matrix product (see
+ * lu_kernels.h). Once computed, the factorization solves A*X = B for any
+ * number of right-hand sides.
+ *
+ * @tparam T Type of the entries.
+ * @tparam n Dimension of the matrix.
+ * @tparam Storage Storage policy of the factorized matrix, see storage.h.
+ */
+template<typename T, size_t n, typename Storage = DenseStorage>
+class LUDecomposition
+{
+public:
+	//! Type of the factorized matrix
+	typedef Matrix<T,n,n,Storage> MatrixType;
+
+private:
+	MatrixType lu_;
+	std::array<size_t,n> pivots_;
+	bool singular_;
+
+public:
+	//! Computes the decomposition of the specified matrix
+	explicit LUDecomposition(const MatrixType& matrix)
+		: lu_(matrix)
+	{
+		factorize();
+	}
+
+	//! Computes the decomposition in the entries of the specified expiring matrix
+	explicit LUDecomposition(MatrixType&& matrix)
+		: lu_(std::move(matrix))
+	{
+		factorize();
+	}
+
+	/**
+	 * @brief Returns the factors L and U
+	 *
+	 * The strictly lower triangle contains L without its unit diagonal, the
+	 * upper triangle contains U.
+	 */
+	const MatrixType& matrixLU() const { return lu_; }
+
+	/**
+	 * @brief Returns the row permutation
+	 *
+	 * The factorization swapped the row i with the row pivots()[i] in the order
+	 * i = 0, ..., n - 1.
+	 */
+	const std::array<size_t,n>& pivots() const { return pivots_; }
+
+	//! Returns true if U has a zero on its diagonal, i.e. the matrix is singular
+	bool isSingular() const { return singular_; }
+
+	//! Returns the determinant of the factorized matrix
+	T determinant() const
+	{
+		T result(1);
+		for(size_t i = 0; i < n; i++) {
+			result *= lu_(i,i);
+			if(pivots_[i] != i) result = -result;
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Solve the linear system for the specified right-hand sides
+	 *
+	 * Returns the solution X of A*X = B for the k columns of B. The matrix
+	 * must not be singular.
+	 */
+	template<size_t k, typename RhsStorage>
+	Matrix<T,n,k,RhsStorage> solve(const Matrix<T,n,k,RhsStorage>& rhs) const
+	{
+		Matrix<T,n,k,RhsStorage> result(rhs);
+		solveInPlace(result);
+		return result;
+	}
+
+	//! Overwrites the right-hand sides B with the solution X of A*X = B (see solve())
+	template<size_t k, typename RhsStorage>
+	void solveInPlace(Matrix<T,n,k,RhsStorage>& rhs) const
+	{
+		typedef Matrix<T,n,k,RhsStorage> RhsType;
+		const size_t ld = MatrixType::leading_dimension;
+		detail::luSwapRows(rhs.data(), RhsType::leading_dimension, 0, k, pivots_.data(), 0, n);
+		detail::solveLower(n, k, lu_.data(), ld, rhs.data(), RhsType::leading_dimension, true);
+		detail::solveUpper(n, k, lu_.data(), ld, rhs.data(), RhsType::leading_dimension, false);
+	}
+
+	//! Returns the inverse of the factorized matrix, which must not be singular
+	MatrixType inverse() const
+	{
+		return solve(MatrixType::createIdentity());
+	}
+
+private:
+	void factorize()
+	{
+		singular_ = !detail::luFactorize<T,n>(lu_.data(), MatrixType::leading_dimension, pivots_.data());
+	}
+};
+
+}
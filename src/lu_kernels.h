@@ -0,0 +1,224 @@
+/*
+	linear_algebra_containers/lu_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "triangular_kernels.h"
+
+// Largest dimension of the matrices factorized by the unrolled LU kernel
+#ifndef LIN_ALGEBRA_UNROLL_MAX_LU
+	#define LIN_ALGEBRA_UNROLL_MAX_LU 8
+#endif
+
+// Smallest dimension of the matrices factorized by the blocked LU kernel
+#ifndef LIN_ALGEBRA_BLOCKED_LU_MIN
+	#define LIN_ALGEBRA_BLOCKED_LU_MIN 64
+#endif
+
+namespace lin_algebra {
+namespace detail {
+
+//! Evaluates to true if n x n matrices are factorized by UnrolledLU
+template<size_t n>
+struct IsUnrolledLU : std::integral_constant<bool, (n <= LIN_ALGEBRA_UNROLL_MAX_LU)> {};
+
+/**
+ * @brief LU decomposition of a panel with partial pivoting
+ *
+ * Factorizes the column-major [m x n] panel a (m >= n) into P*a = L*U with the
+ * unit lower trapezoidal L stored below and the upper triangular U stored on
+ * and above the diagonal. In step k the row with the largest absolute entry
+ * in column k is swapped with row k (inside of the panel only) and its index
+ * is stored in pivots[k]. Columns with only zeros on and below the diagonal
+ * are skipped, the function returns false if there was such a column.
+ */
+template<typename T>
+inline bool luPanel(size_t m, size_t n, T* a, size_t lda, size_t* pivots)
+{
+	using std::abs;
+	bool regular = true;
+	for(size_t k = 0; k < n; k++) {
+		T* ak = a + k*lda;
+		size_t pivot = k;
+		T largest = abs(ak[k]);
+		for(size_t i = k + 1; i < m; i++) {
+			const T value = abs(ak[i]);
+			if(value > largest) {
+				largest = value;
+				pivot = i;
+			}
+		}
+		pivots[k] = pivot;
+		if(largest == T(0)) {
+			regular = false;
+			continue;
+		}
+		if(pivot != k) {
+			for(size_t j = 0; j < n; j++) std::swap(a[k + j*lda], a[pivot + j*lda]);
+		}
+
+		const T reciprocal = T(1)/ak[k];
+		for(size_t i = k + 1; i < m; i++) ak[i] *= reciprocal;
+		for(size_t j = k + 1; j < n; j++) {
+			T* aj = a + j*lda;
+			const T akj = aj[k];
+			for(size_t i = k + 1; i < m; i++) aj[i] -= ak[i]*akj;
+		}
+	}
+	return regular;
+}
+
+//! Swaps the rows i and pivots[i] for i = begin, ..., end - 1 in the columns first, ..., last - 1 of a
+template<typename T>
+inline void luSwapRows(T* a, size_t lda, size_t first, size_t last, const size_t* pivots, size_t begin, size_t end)
+{
+	for(size_t j = first; j < last; j++) {
+		T* aj = a + j*lda;
+		for(size_t i = begin; i < end; i++) {
+			if(pivots[i] != i) std::swap(aj[i], aj[pivots[i]]);
+		}
+	}
+}
+
+/**
+ * @brief Blocked right-looking LU decomposition with partial pivoting
+ *
+ * Factorizes the column-major [n x n] matrix a in place (see luPanel) in
+ * panels of triangular_block_size columns. After factorizing a panel its row
+ * swaps are applied to the other columns, the block row of U right of the
+ * panel is computed by forward substitution and the trailing matrix is
+ * updated with a single matrix product (subtractProduct), which runs on the
+ * cache blocked gemm kernel. pivots[i] is the row swapped with row i.
+ */
+template<typename T>
+inline bool luBlocked(size_t n, T* a, size_t lda, size_t* pivots)
+{
+	bool regular = true;
+	for(size_t j = 0; j < n; j += triangular_block_size) {
+		const size_t nb = (n - j < triangular_block_size) ? n - j : triangular_block_size;
+		const size_t next = j + nb;
+		regular = luPanel(n - j, nb, a + j + j*lda, lda, pivots + j) && regular;
+		for(size_t i = j; i < next; i++) pivots[i] += j;
+
+		luSwapRows(a, lda, 0, j, pivots, j, next);
+		luSwapRows(a, lda, next, n, pivots, j, next);
+		if(next < n) {
+			solveLower(nb, n - next, a + j + j*lda, lda, a + j + next*lda, lda, true);
+			subtractProduct(n - next, nb, n - next, a + next + j*lda, 1, lda, a + j + next*lda, 1, lda, a + next + next*lda, lda);
+		}
+	}
+	return regular;
+}
+
+/**
+ * @brief LU decomposition of small matrices with compile-time dimension
+ *
+ * Computes the same factorization as luPanel for a column-major [n x n]
+ * matrix. Every step is expanded from index sequences, so the pivot search,
+ * the row swap and the update of the trailing matrix are straight-line code
+ * without loops.
+ */
+template<typename T, size_t n, size_t k = 0, bool last = (k == n)>
+struct UnrolledLU
+{
+	static bool run(T* a, size_t lda, size_t* pivots)
+	{
+		const bool regular = step(a, lda, pivots, std::make_index_sequence<n - k - 1>(), std::make_index_sequence<n>(),
+			std::make_index_sequence<(n - k - 1)*(n - k - 1)>());
+		return UnrolledLU<T,n,k + 1>::run(a, lda, pivots) && regular;
+	}
+
+private:
+	//! Indices I of the rows below the diagonal, J of all columns and E of the entries of the trailing matrix
+	template<size_t ...I, size_t ...J, size_t ...E>
+	static bool step(T* a, size_t lda, size_t* pivots, std::index_sequence<I...>, std::index_sequence<J...>, std::index_sequence<E...>)
+	{
+		using std::abs;
+		constexpr size_t rest = n - k - 1;
+		T* ak = a + k*lda;
+
+		size_t pivot = k;
+		T largest = abs(ak[k]);
+		const int search[] = { 0, ((void)(abs(ak[k + 1 + I]) > largest ? (largest = abs(ak[k + 1 + I]), pivot = k + 1 + I) : pivot), 0)... };
+		(void)search;
+		pivots[k] = pivot;
+		if(largest == T(0)) return false;
+
+		if(pivot != k) {
+			const int swap[] = { 0, ((void)std::swap(a[k + J*lda], a[pivot + J*lda]), 0)... };
+			(void)swap;
+		}
+		const T reciprocal = T(1)/ak[k];
+		const int scale[] = { 0, ((void)(ak[k + 1 + I] *= reciprocal), 0)... };
+		(void)scale;
+		const int update[] = { 0, ((void)(a[k + 1 + E % rest + (k + 1 + E / rest)*lda] -= ak[k + 1 + E % rest]*a[k + (k + 1 + E / rest)*lda]), 0)... };
+		(void)update;
+		(void)rest;
+		(void)reciprocal;
+		return true;
+	}
+};
+
+template<typename T, size_t n, size_t k>
+struct UnrolledLU<T,n,k,true>
+{
+	static bool run(T*, size_t, size_t*) { return true; }
+};
+
+template<typename T, size_t n>
+inline bool luFactorize(T* a, size_t lda, size_t* pivots, std::true_type)
+{
+	return UnrolledLU<T,n>::run(a, lda, pivots);
+}
+
+template<typename T, size_t n>
+inline bool luFactorize(T* a, size_t lda, size_t* pivots, std::false_type)
+{
+	if(n >= LIN_ALGEBRA_BLOCKED_LU_MIN) return luBlocked(n, a, lda, pivots);
+	return luPanel(n, n, a, lda, pivots);
+}
+
+/**
+ * @brief LU decomposition with partial pivoting of a matrix with compile-time dimension
+ *
+ * Factorizes the column-major [n x n] matrix a in place into P*a = L*U (see
+ * luPanel). Matrices with up to LIN_ALGEBRA_UNROLL_MAX_LU rows are factorized
+ * by UnrolledLU, matrices with at least LIN_ALGEBRA_BLOCKED_LU_MIN rows by
+ * luBlocked and all other matrices by luPanel. Returns false if the matrix is
+ * singular.
+ */
+template<typename T, size_t n>
+inline bool luFactorize(T* a, size_t lda, size_t* pivots)
+{
+	return luFactorize<T,n>(a, lda, pivots, IsUnrolledLU<n>());
+}
+
+}
+}
@@ -25,7 +25,12 @@
 
 #pragma once
 
+#include <type_traits>
+#include <utility>
+
 #include "matrixbase.h"
+#include "matrix_expression.h"
+#include "gemm.h"
 
 namespace lin_algebra {
 
@@ -49,18 +54,20 @@ namespace lin_algebra {
  * aritmethic operations.
  * @tparam m Number of Matrix::rows of the matrix.
  * @tparam n Number of columns of the matrix.
+ * @tparam Storage Storage policy specifying the memory layout of the entries,
+ * see storage.h.
  */
-template<typename T, size_t row_count_param, size_t column_count_param>
-class Matrix : public MatrixBase<T,row_count_param,column_count_param>
+template<typename T, size_t row_count_param, size_t column_count_param, typename Storage>
+class Matrix : public MatrixBase<T,row_count_param,column_count_param,Storage>
 {
 private:
-	typedef MatrixBase<T,Matrix::rows,Matrix::cols> MatrixBaseType;
+	typedef MatrixBase<T,Matrix::rows,Matrix::cols,Storage> MatrixBaseType;
 
 public:
 	//! The type of the matrix
-	typedef Matrix<T,Matrix::rows,Matrix::cols> MatrixType;
-	//! The type of the transposed matrix
-	typedef Matrix<T,Matrix::cols,Matrix::rows> TransposedMatrixType;
+	typedef Matrix<T,Matrix::rows,Matrix::cols,Storage> MatrixType;
+	//! The type of the evaluated transposed matrix
+	typedef Matrix<T,Matrix::cols,Matrix::rows,Storage> TransposedMatrixType;
 
 	/**
 	 * @brief Construct a matrix
@@ -68,23 +75,43 @@ public:
 	 * Constructs a matrix without initilization or a m*n parameter pack
 	 * for initialization depending on the arguments of the constructor.
 	 */
-	template<typename ...Ts>
-	Matrix(Ts... values)
+	template<typename ...Ts, typename = typename std::enable_if<IsEntryList<Ts...>::value>::type>
+	constexpr Matrix(Ts... values)
 		: MatrixBaseType(values...)
 	{
 	}
 
+	//! Constructs a matrix by evaluating the specified matrix expression
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,row_count_param,column_count_param>::value>::type>
+	constexpr Matrix(const E& expr)
+		: MatrixBaseType(detail::UninitializedTag())
+	{
+		this->assign(expr);
+	}
+
+	//! Assigns the result of the specified matrix expression to this matrix
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,row_count_param,column_count_param>::value>::type>
+	MatrixType& operator=(const E& expr)
+	{
+		this->assignAliased(expr);
+		return *this;
+	}
+
 	/**
 	 * @brief Create an identity matrix
 	 *
 	 * This method constructs a matrix with all entries set to zero except
-	 * for the diagonal entries which are set to one.
+	 * for the diagonal entries which are set to one. Can be used in constant
+	 * expressions.
 	 * @return An identity matrix.
 	 */
-	static MatrixType createIdentity()
+	static constexpr MatrixType createIdentity()
 	{
 		MatrixType result;
-		result.toIdentity();
+		const size_t smaller_dim = (Matrix::rows < Matrix::cols) ? Matrix::rows : Matrix::cols;
+		for(size_t i = 0; i < smaller_dim; i++) {
+			result(i,i) = T(1);
+		}
 		return result;
 	}
 
@@ -109,115 +136,418 @@ public:
 	/**
 	 * @brief Create transposed matrix
 	 *
-	 * Constructs the transposed of this matrix, i.e. creating matrix
-	 * B of dimensions [n x m] from matrix A [m x n] with A*B = I where
-	 * I is an identity matrix.
+	 * Returns the transposed of this matrix, i.e. the matrix B of dimensions
+	 * [n x m] with B(j,i) = A(i,j) for this matrix A [m x n]. The entries are
+	 * not copied, the returned expression refers to this matrix (see
+	 * TransposeExpression). Products with the transposed are computed on the
+	 * entries of this matrix and assigning it to a TransposedMatrixType uses
+	 * a cache blocked transposition.
 	 * @return The transposed of this matrix.
 	 */
-	TransposedMatrixType transposed() const
+	constexpr TransposeExpression<MatrixType> transposed() const
 	{
-		TransposedMatrixType result;
-		for(size_t i = 0; i < Matrix::rows; i++) {
-			for(size_t j = 0; j < Matrix::cols; j++) {
-				result(j,i) = this->entries_[MatrixBaseType::index(i,j)];
-			}
-		}
+		return TransposeExpression<MatrixType>(*this);
+	}
+
+	/**
+	 * @brief Calculate the determinant
+	 *
+	 * Calculates the determinant of a square matrix with 2, 3 or 4 rows using
+	 * an unrolled cofactor expansion.
+	 * @return The determinant of this matrix.
+	 */
+	T determinant() const
+	{
+		static_assert(Matrix::rows == Matrix::cols, "The determinant is only defined for square matrices");
+		static_assert(Matrix::rows >= 2 && Matrix::rows <= 4, "The determinant is only implemented for 2x2, 3x3 and 4x4 matrices");
+		typedef detail::SmallInverse<T,Matrix::rows> Kernel;
+		const detail::OperationScope<T> scope(AccountedOperation::Determinant, Kernel::determinant_flops, Matrix::rows*Matrix::cols);
+		return Kernel::determinant(this->data(), MatrixBaseType::leading_dimension);
+	}
+
+	/**
+	 * @brief Create inverse matrix
+	 *
+	 * Constructs the inverse of a square matrix with 2, 3 or 4 rows as the
+	 * adjugate divided by the determinant. The matrix must be invertible,
+	 * otherwise the entries of the result are not finite.
+	 * @return The inverse of this matrix.
+	 */
+	MatrixType inverse() const
+	{
+		static_assert(Matrix::rows == Matrix::cols, "The inverse is only defined for square matrices");
+		static_assert(Matrix::rows >= 2 && Matrix::rows <= 4, "The inverse is only implemented for 2x2, 3x3 and 4x4 matrices");
+		typedef detail::SmallInverse<T,Matrix::rows> Kernel;
+		const detail::OperationScope<T> scope(AccountedOperation::Inverse, Kernel::inverse_flops, 2*Matrix::rows*Matrix::cols);
+		MatrixType result;
+		Kernel::invert(this->data(), MatrixBaseType::leading_dimension,
+			result.data(), MatrixBaseType::leading_dimension);
+		return result;
+	}
+
+	/**
+	 * @brief Create inverse of an affine transformation
+	 *
+	 * Constructs the inverse of a 4x4 affine transformation [A t; 0 1] with
+	 * an invertible 3x3 block A. Only A has to be inverted, which is much
+	 * cheaper than the general inverse().
+	 * @return The inverse transformation [inv(A) -inv(A)*t; 0 1].
+	 */
+	MatrixType affineInverse() const
+	{
+		static_assert(Matrix::rows == 4 && Matrix::cols == 4, "The affine inverse is only defined for 4x4 matrices");
+		const detail::OperationScope<T> scope(AccountedOperation::Inverse, 60, 32);
+		MatrixType result;
+		detail::affineInverse4(this->data(), MatrixBaseType::leading_dimension, result.data(), MatrixBaseType::leading_dimension, false);
+		return result;
+	}
+
+	/**
+	 * @brief Create inverse of a rigid transformation
+	 *
+	 * Constructs the inverse of a 4x4 rigid transformation [R t; 0 1] where
+	 * R is a rotation matrix, so that inv(R) is the transposed of R.
+	 * @return The inverse transformation [R^T -R^T*t; 0 1].
+	 */
+	MatrixType rigidInverse() const
+	{
+		static_assert(Matrix::rows == 4 && Matrix::cols == 4, "The rigid inverse is only defined for 4x4 matrices");
+		const detail::OperationScope<T> scope(AccountedOperation::Inverse, 18, 32);
+		MatrixType result;
+		detail::affineInverse4(this->data(), MatrixBaseType::leading_dimension, result.data(), MatrixBaseType::leading_dimension, true);
 		return result;
 	}
 
 	//! Adds the right matrix to the left.
-	MatrixType operator+=(const MatrixType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,row_count_param,column_count_param>::value>::type>
+	MatrixType& operator+=(const E& rhs)
 	{
-		for(size_t i = 0; i < (Matrix::rows*Matrix::cols); i++) {
-			this->entries_[i] += rhs.entries_[i];
-		}
+		this->addAssign(rhs);
 		return *this;
 	}
 
 	//! Substracts the right matrix from the left.
-	MatrixType operator-=(const MatrixType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,row_count_param,column_count_param>::value>::type>
+	MatrixType& operator-=(const E& rhs)
 	{
-		for(size_t i = 0; i < (Matrix::rows*Matrix::cols); i++) {
-			this->entries_[i] -= rhs.entries_[i];
-		}
+		this->subtractAssign(rhs);
 		return *this;
 	}
 
 	//! Scales the matrix by the specified factor.
-	MatrixType operator*=(double factor)
+	template<typename S, typename = typename std::enable_if<IsScalarFor<S,MatrixType>::value>::type>
+	MatrixType& operator*=(const S& factor)
 	{
-		for(size_t i = 0; i < (Matrix::rows*Matrix::cols); i++) {
-			this->entries_[i] *= factor;
-		}
+		this->scaleAssign(factor);
 		return *this;
 	}
+};
 
-	//! Returns the matrix scaled by the specified factor.
-	friend MatrixType operator*(const MatrixType& mat, double factor)
-	{
-		MatrixType result(mat);
-		result *= factor;
-		return result;
-	}
+//! Matrix with the entries aligned to the specified number of bytes and every column padded to full SIMD registers
+template<typename T, size_t m, size_t n, size_t alignment = 16>
+using AlignedMatrix = Matrix<T,m,n,AlignedStorage<alignment,true>>;
 
-	//! Returns the matrix scaled by the specified factor.
-	friend MatrixType operator*(double factor, const MatrixType& mat)
-	{
-		MatrixType result(mat);
-		result *= factor;
-		return result;
-	}
+//! Matrix with fixed dimensions storing its entries on the heap (for large matrices, see HeapStorage)
+template<typename T, size_t m, size_t n, size_t alignment = 64>
+using HeapMatrix = Matrix<T,m,n,HeapStorage<alignment>>;
+
+/**
+ * @brief Matrix product of two matrices
+ *
+ * Returns the matrix product of two matrices. Matrix dimensions must agree.
+ * ([m x n]*[n x p] = [m x p]) Larger products are computed by a cache blocked
+ * kernel working on packed panels of the column-major storage, see gemm.h.
+ * The result uses the storage policy of the left matrix.
+ */
+template<typename T, size_t m, size_t n, size_t p, typename LhsStorage, typename RhsStorage>
+inline constexpr Matrix<T,m,p,LhsStorage> operator*(const Matrix<T,m,n,LhsStorage>& lhs, const Matrix<T,n,p,RhsStorage>& rhs)
+{
+	typedef Matrix<T,m,n,LhsStorage> LhsType;
+	typedef Matrix<T,n,p,RhsStorage> RhsType;
+	typedef Matrix<T,m,p,LhsStorage> ResultType;
+
+	detail::beginOperation<T>(AccountedOperation::MatrixProduct, 2*m*n*p, m*n + n*p + m*p);
+	ResultType result;
+	detail::gemmFixed<T,m,n,p>(lhs.data(), 1, LhsType::leading_dimension, rhs.data(), 1, RhsType::leading_dimension,
+		result.data(), ResultType::leading_dimension);
+	detail::endOperation<T>();
+	return result;
+}
 
-	//! Returns the sum of the two matrices. Matrix dimensions must agree.
-	friend MatrixType operator+(const MatrixType& lhs, const MatrixType& rhs)
+namespace detail {
+
+/**
+ * Operand of the matrix product of matrix expressions
+ *
+ * Provides a pointer to the entries of the operand and the strides of its
+ * rows and columns as expected by gemm. Unevaluated expressions are evaluated
+ * into a temporary matrix while matrices and views (see MatrixView) are used
+ * in place.
+ */
+template<typename E>
+class GemmOperand
+{
+public:
+	typedef typename E::ScalarType ScalarType;
+	//! Storage policy of the result of a product with this operand on the left
+	typedef DenseStorage StorageType;
+
+private:
+	Matrix<ScalarType,E::rows,E::cols> mat_;
+
+public:
+	constexpr explicit GemmOperand(const E& expr)
+		: mat_(expr)
 	{
-		MatrixType result(lhs);
-		result += rhs;
-		return result;
 	}
 
-	//! Returns the difference of the two matrices. Matrix dimensions must agree.
-	friend MatrixType operator-(const MatrixType& lhs, const MatrixType& rhs)
+	constexpr const ScalarType* data() const { return mat_.data(); }
+	constexpr size_t rowStride() const { return 1; }
+	constexpr size_t columnStride() const { return E::rows; }
+};
+
+template<typename T, size_t m, size_t n, typename Storage>
+class GemmOperand<Matrix<T,m,n,Storage>>
+{
+public:
+	typedef T ScalarType;
+	typedef Storage StorageType;
+
+private:
+	const Matrix<T,m,n,Storage>& mat_;
+
+public:
+	constexpr explicit GemmOperand(const Matrix<T,m,n,Storage>& mat)
+		: mat_(mat)
 	{
-		MatrixType result(lhs);
-		result -= rhs;
-		return result;
 	}
 
-	//! Returns the negated matrix.
-	friend MatrixType operator-(const MatrixType& in)
+	constexpr const T* data() const { return mat_.data(); }
+	constexpr size_t rowStride() const { return 1; }
+	constexpr size_t columnStride() const { return Matrix<T,m,n,Storage>::leading_dimension; }
+};
+
+//! Transposed operands are used in place by swapping the strides of their operand
+template<typename E>
+class GemmOperand<TransposeExpression<E>>
+{
+public:
+	typedef typename E::ScalarType ScalarType;
+	typedef typename GemmOperand<E>::StorageType StorageType;
+
+private:
+	const GemmOperand<E> operand_;
+
+public:
+	constexpr explicit GemmOperand(const TransposeExpression<E>& expr)
+		: operand_(expr.operand())
 	{
-		return T(-1)*MatrixType(in);
 	}
+
+	constexpr const ScalarType* data() const { return operand_.data(); }
+	constexpr size_t rowStride() const { return operand_.columnStride(); }
+	constexpr size_t columnStride() const { return operand_.rowStride(); }
 };
 
-//! Returns the matrix product of two matrices. Matrix dimensions must agree. ([m x n]*[n x p] = [m x p])
-template<typename T, size_t m, size_t n, size_t p>
-inline Matrix<T,m,p> operator*(const Matrix<T,m,n>& lhs, const Matrix<T,n,p>& rhs)
+template<typename L, typename R>
+inline constexpr typename L::ScalarType innerProduct(const L& lhs, const R& rhs, std::true_type)
 {
-	Matrix<T,m,p> result;
-	result.zeros();
+	return UnrolledInnerProduct<typename L::ScalarType,L::cols>::run(lhs, rhs);
+}
 
-	for(size_t i = 0; i < m; i++) {
-		for(size_t j = 0; j < p; j++) {
-			for(size_t k = 0; k < n; k++) {
-				result(i,j) += lhs(i,k) * rhs(k,j);
-			}
-		}
+template<typename L, typename R>
+inline typename L::ScalarType innerProduct(const L& lhs, const R& rhs, std::false_type)
+{
+	typename L::ScalarType result(0);
+	for(size_t i = 0; i < L::cols; i++) {
+		result += lhs(0,i) * rhs(i,0);
 	}
+	return result;
+}
 
+//! Returns the sum of lhs(0,i)*rhs(i,0) of a row and a column vector expression (unrolled for short vectors)
+template<typename L, typename R>
+inline constexpr typename L::ScalarType innerProduct(const L& lhs, const R& rhs)
+{
+	typedef typename L::ScalarType T;
+	beginOperation<T>(AccountedOperation::InnerProduct, 2*L::cols, 2*L::cols);
+	const T result = innerProduct(lhs, rhs, IsUnrolledSize<L::cols>());
+	endOperation<T>();
 	return result;
 }
 
-//! Simplified product when the matrix product is the same as a scalar product. ([1 x m]*[m x 1] = [1])
-template<typename T, size_t m>
-inline T operator*(const Matrix<T,1,m>& lhs, const Matrix<T,m,1>& rhs)
+//! Product of a row vector and a column vector expression ([1 x m]*[m x 1] = [1])
+template<typename L, typename R>
+inline constexpr typename L::ScalarType product(const L& lhs, const R& rhs, std::true_type)
 {
-	T result(0);
-	for(size_t i = 0; i < m; i++) {
-		result += lhs(0,i) * rhs(i,0);
-	}
+	return innerProduct(lhs, rhs);
+}
+
+//! Product of two matrix expressions computed by gemm on the entries of the operands
+template<typename L, typename R>
+inline constexpr auto product(const L& lhs, const R& rhs, std::false_type)
+{
+	typedef typename L::ScalarType T;
+	typedef Matrix<T,L::rows,R::cols,typename GemmOperand<L>::StorageType> ResultType;
+
+	// The operations of evaluating expression operands are part of the product
+	beginOperation<T>(AccountedOperation::MatrixProduct,
+		2*L::rows*L::cols*R::cols + ExpressionCost<L>::flops*L::rows*L::cols + ExpressionCost<R>::flops*R::rows*R::cols,
+		ExpressionCost<L>::operands*L::rows*L::cols + ExpressionCost<R>::operands*R::rows*R::cols + L::rows*R::cols);
+	const GemmOperand<L> a(lhs);
+	const GemmOperand<R> b(rhs);
+	ResultType result;
+	gemmFixed<T,L::rows,L::cols,R::cols>(a.data(), a.rowStride(), a.columnStride(), b.data(), b.rowStride(), b.columnStride(),
+		result.data(), ResultType::leading_dimension);
+	endOperation<T>();
 	return result;
 }
 
 }
+
+/**
+ * @brief Matrix product of matrix expressions
+ *
+ * Returns the matrix product of two matrix expressions of which at least one
+ * is not a matrix. Operands that are unevaluated expressions are evaluated
+ * first, matrix views are multiplied in place without copying their entries.
+ * Matrix dimensions must agree.
+ */
+template<typename L, typename R, typename = typename std::enable_if<IsMatrixExpression<L>::value && IsMatrixExpression<R>::value
+	&& (IsExpressionNode<L>::value || IsExpressionNode<R>::value)>::type>
+inline constexpr auto operator*(const L& lhs, const R& rhs)
+{
+	static_assert(L::cols == R::rows, "Matrix dimensions must agree");
+	static_assert(std::is_same<typename L::ScalarType, typename R::ScalarType>::value, "Scalar types must agree");
+	return detail::product(lhs, rhs, std::integral_constant<bool, L::rows == 1 && R::cols == 1>());
+}
+
+/**
+ * @brief Invert an array of matrices
+ *
+ * Stores the inverses of count 2x2, 3x3 or 4x4 matrices from in in out (see
+ * Matrix::inverse()). For float and double 4x4 matrices are inverted with the
+ * SIMD kernel selected for the CPU, which processes a full register of
+ * matrices at once. 2x2 and 3x3 matrices are inverted one after another like
+ * Matrix::inverse(). in and out may point to the same array.
+ */
+template<typename T, size_t n>
+inline void invertMatrices(const Matrix<T,n,n>* in, Matrix<T,n,n>* out, size_t count)
+{
+	static_assert(n >= 2 && n <= 4, "The inverse is only implemented for 2x2, 3x3 and 4x4 matrices");
+	static_assert(sizeof(Matrix<T,n,n>) == n*n*sizeof(T), "Matrices must be stored without padding");
+	detail::InverseKernelSelect<T,n>::get()(reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+}
+
+//! Simplified product when the matrix product is the same as a scalar product. ([1 x m]*[m x 1] = [1])
+template<typename T, size_t m, typename LhsStorage, typename RhsStorage>
+inline constexpr T operator*(const Matrix<T,1,m,LhsStorage>& lhs, const Matrix<T,m,1,RhsStorage>& rhs)
+{
+	return detail::innerProduct(lhs, rhs);
+}
+
+namespace detail {
+
+/**
+ * @brief Evaluates to true if the arithmetic operators reuse the storage of expiring operands
+ *
+ * Copying matrices with heap storage or with entries that are not trivially
+ * copyable (e.g. multiprecision numbers or intervals) is expensive. If one
+ * operand of a sum, difference, negation or scaling of such matrices is an
+ * rvalue, the result is computed in its entries and the operand is moved into
+ * the result. All other operands are captured by the expression templates,
+ * which evaluate a whole expression in a single pass.
+ */
+template<typename T, typename Storage = DenseStorage>
+struct ReusesOperandStorage
+	: std::integral_constant<bool, IsHeapStorage<Storage>::value || !std::is_trivially_copyable<T>::value> {};
+
+//! Evaluates to true if the rvalue operand of a binary operator with an operand of type E can be reused (see ReusesOperandStorage)
+template<typename T, size_t m, size_t n, typename Storage, typename E>
+struct IsReusableOperandFor
+	: std::integral_constant<bool, ReusesOperandStorage<T,Storage>::value && IsMatrixExpressionOf<E,T,m,n>::value> {};
+
+}
+
+//! Returns the sum of the two matrices computed in the entries of the expiring left matrix
+template<typename T, size_t m, size_t n, typename Storage, typename E,
+	typename = typename std::enable_if<detail::IsReusableOperandFor<T,m,n,Storage,E>::value>::type>
+inline Matrix<T,m,n,Storage> operator+(Matrix<T,m,n,Storage>&& lhs, const E& rhs)
+{
+	lhs += rhs;
+	return std::move(lhs);
+}
+
+//! Returns the sum of the two matrices computed in the entries of the expiring right matrix
+template<typename E, typename T, size_t m, size_t n, typename Storage,
+	typename = typename std::enable_if<detail::IsReusableOperandFor<T,m,n,Storage,E>::value>::type>
+inline Matrix<T,m,n,Storage> operator+(const E& lhs, Matrix<T,m,n,Storage>&& rhs)
+{
+	rhs = MatrixBinaryExpression<E,Matrix<T,m,n,Storage>,detail::SumOp>(lhs, rhs);
+	return std::move(rhs);
+}
+
+//! Returns the sum of the two matrices computed in the entries of the left matrix (both matrices are expiring)
+template<typename T, size_t m, size_t n, typename LhsStorage, typename RhsStorage,
+	typename = typename std::enable_if<detail::ReusesOperandStorage<T,LhsStorage>::value>::type>
+inline Matrix<T,m,n,LhsStorage> operator+(Matrix<T,m,n,LhsStorage>&& lhs, Matrix<T,m,n,RhsStorage>&& rhs)
+{
+	lhs += rhs;
+	return std::move(lhs);
+}
+
+//! Returns the difference of the two matrices computed in the entries of the expiring left matrix
+template<typename T, size_t m, size_t n, typename Storage, typename E,
+	typename = typename std::enable_if<detail::IsReusableOperandFor<T,m,n,Storage,E>::value>::type>
+inline Matrix<T,m,n,Storage> operator-(Matrix<T,m,n,Storage>&& lhs, const E& rhs)
+{
+	lhs -= rhs;
+	return std::move(lhs);
+}
+
+//! Returns the difference of the two matrices computed in the entries of the expiring right matrix
+template<typename E, typename T, size_t m, size_t n, typename Storage,
+	typename = typename std::enable_if<detail::IsReusableOperandFor<T,m,n,Storage,E>::value>::type>
+inline Matrix<T,m,n,Storage> operator-(const E& lhs, Matrix<T,m,n,Storage>&& rhs)
+{
+	rhs = MatrixBinaryExpression<E,Matrix<T,m,n,Storage>,detail::DifferenceOp>(lhs, rhs);
+	return std::move(rhs);
+}
+
+//! Returns the difference of the two matrices computed in the entries of the left matrix (both matrices are expiring)
+template<typename T, size_t m, size_t n, typename LhsStorage, typename RhsStorage,
+	typename = typename std::enable_if<detail::ReusesOperandStorage<T,LhsStorage>::value>::type>
+inline Matrix<T,m,n,LhsStorage> operator-(Matrix<T,m,n,LhsStorage>&& lhs, Matrix<T,m,n,RhsStorage>&& rhs)
+{
+	lhs -= rhs;
+	return std::move(lhs);
+}
+
+//! Returns the negated matrix computed in the entries of the expiring matrix
+template<typename T, size_t m, size_t n, typename Storage,
+	typename = typename std::enable_if<detail::ReusesOperandStorage<T,Storage>::value>::type>
+inline Matrix<T,m,n,Storage> operator-(Matrix<T,m,n,Storage>&& mat)
+{
+	mat = MatrixUnaryExpression<Matrix<T,m,n,Storage>,detail::NegationOp>(mat, detail::NegationOp());
+	return std::move(mat);
+}
+
+//! Returns the expiring matrix scaled by the specified factor
+template<typename T, size_t m, size_t n, typename Storage, typename S,
+	typename = typename std::enable_if<detail::ReusesOperandStorage<T,Storage>::value && IsScalarFor<S,Matrix<T,m,n,Storage>>::value>::type>
+inline Matrix<T,m,n,Storage> operator*(Matrix<T,m,n,Storage>&& mat, const S& factor)
+{
+	mat *= factor;
+	return std::move(mat);
+}
+
+//! Returns the expiring matrix scaled by the specified factor
+template<typename S, typename T, size_t m, size_t n, typename Storage,
+	typename = typename std::enable_if<detail::ReusesOperandStorage<T,Storage>::value && IsScalarFor<S,Matrix<T,m,n,Storage>>::value>::type>
+inline Matrix<T,m,n,Storage> operator*(const S& factor, Matrix<T,m,n,Storage>&& mat)
+{
+	mat *= factor;
+	return std::move(mat);
+}
+
+}
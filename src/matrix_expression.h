@@ -0,0 +1,453 @@
+/*
+	linear_algebra_containers/matrix_expression header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "storage.h"
+
+namespace lin_algebra {
+
+template<typename T, size_t row_count_param, size_t column_count_param, typename Storage = DenseStorage>
+class Matrix;
+
+template<typename T>
+class DynamicMatrix;
+
+template<typename E>
+class TransposeExpression;
+
+namespace detail {
+template<typename E>
+class GemmOperand;
+}
+
+//! Tag base class of all types that can be used as operands of matrix expressions
+struct MatrixExpressionTag {};
+
+//! Tag base class of unevaluated expression nodes
+struct MatrixExpressionNodeTag : MatrixExpressionTag {};
+
+//! Evaluates to true if E is a matrix or an unevaluated matrix expression
+template<typename E>
+struct IsMatrixExpression : std::is_base_of<MatrixExpressionTag, typename std::decay<E>::type> {};
+
+//! Evaluates to true if E is an unevaluated expression node (i.e. not a matrix storing its entries)
+template<typename E>
+struct IsExpressionNode : std::is_base_of<MatrixExpressionNodeTag, typename std::decay<E>::type> {};
+
+namespace detail {
+
+template<bool is_expression, typename E, typename T, size_t rows, size_t cols>
+struct IsMatrixExpressionOfImpl : std::false_type {};
+
+template<typename E, typename T, size_t rows, size_t cols>
+struct IsMatrixExpressionOfImpl<true,E,T,rows,cols>
+	: std::integral_constant<bool, (E::rows == rows) && (E::cols == cols) && std::is_same<typename E::ScalarType,T>::value> {};
+
+template<bool is_candidate, typename S, typename E>
+struct IsScalarForImpl : std::false_type {};
+
+template<typename S, typename E>
+struct IsScalarForImpl<true,S,E>
+	: std::integral_constant<bool, std::is_arithmetic<S>::value || std::is_same<S, typename E::ScalarType>::value> {};
+
+}
+
+//! Evaluates to true if E is a matrix expression with the specified scalar type and dimensions
+template<typename E, typename T, size_t rows, size_t cols>
+struct IsMatrixExpressionOf
+	: detail::IsMatrixExpressionOfImpl<IsMatrixExpression<E>::value, typename std::decay<E>::type, T, rows, cols> {};
+
+//! Evaluates to true if the parameter pack is a list of matrix entries and not a single matrix expression
+template<typename ...Ts>
+struct IsEntryList : std::true_type {};
+
+template<typename T>
+struct IsEntryList<T> : std::integral_constant<bool, !IsMatrixExpression<T>::value> {};
+
+//! Evaluates to true if S can be used as scalar factor for expressions of type E
+template<typename S, typename E>
+struct IsScalarFor
+	: detail::IsScalarForImpl<IsMatrixExpression<E>::value && !IsMatrixExpression<S>::value, S, typename std::decay<E>::type> {};
+
+/**
+ * @brief Type used to store an operand inside of an expression node
+ *
+ * Matrices are captured by reference while expression nodes are lightweight
+ * and are captured by value so that nested expressions can be returned from
+ * functions.
+ */
+template<typename E>
+struct ExpressionOperand
+{
+	typedef typename std::conditional<IsExpressionNode<E>::value, const E, const E&>::type type;
+};
+
+/**
+ * Base class of matrix expression nodes
+ *
+ * The arithmetic operators of the matrix classes don't compute their result
+ * immediately. Instead they return lightweight expression nodes that store
+ * their operands. The entries of the expression are computed on assignment
+ * to a matrix, so that an expression like a + 2*b - c is evaluated in a single
+ * loop without any temporary matrices. Every node provides the ScalarType,
+ * rows and cols members and the [] and () operators of the matrix classes.
+ * Expressions can be converted implicitly to the corresponding matrix type.
+ *
+ * @tparam Derived The type of the expression node (CRTP).
+ */
+template<typename Derived>
+class MatrixExpression : public MatrixExpressionNodeTag
+{
+public:
+	//! Returns a reference to the actual expression node
+	constexpr const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+	//! Evaluates the expression into a matrix
+	constexpr auto eval() const
+	{
+		return Matrix<typename Derived::ScalarType,Derived::rows,Derived::cols>(derived());
+	}
+
+	//! Returns the transposed of the expression
+	constexpr TransposeExpression<Derived> transposed() const
+	{
+		return TransposeExpression<Derived>(derived());
+	}
+
+	//! Returns the squared euclidean norm of a column vector expression
+	auto normSquared() const
+	{
+		static_assert(Derived::cols == 1, "The norm is only defined for column vectors");
+		typename Derived::ScalarType norm(0);
+		for(size_t i = 0; i < Derived::rows; i++) {
+			const typename Derived::ScalarType v = derived()[i];
+			norm += v*v;
+		}
+		return norm;
+	}
+
+	//! Returns the euclidean norm of a column vector expression
+	auto norm() const
+	{
+		using std::sqrt;
+		return sqrt(normSquared());
+	}
+
+	//! Returns the normalized evaluated column vector expression
+	auto normalized() const
+	{
+		return eval().normalized();
+	}
+
+	//! Returns the x value of a 3d vector expression
+	constexpr auto x() const { return derived()[0]; }
+	//! Returns the y value of a 3d vector expression
+	constexpr auto y() const { return derived()[1]; }
+	//! Returns the z value of a 3d vector expression
+	constexpr auto z() const { return derived()[2]; }
+};
+
+namespace detail {
+
+//! Elementwise sum
+struct SumOp
+{
+	template<typename T>
+	static constexpr T apply(const T& lhs, const T& rhs) { return lhs + rhs; }
+};
+
+//! Elementwise difference
+struct DifferenceOp
+{
+	template<typename T>
+	static constexpr T apply(const T& lhs, const T& rhs) { return lhs - rhs; }
+};
+
+//! Elementwise negation
+struct NegationOp
+{
+	template<typename T>
+	constexpr T apply(const T& value) const { return -value; }
+};
+
+//! Multiplication of all entries with a scalar factor
+template<typename S>
+struct ScalingOp
+{
+	S factor;
+
+	template<typename T>
+	constexpr T apply(const T& value) const { return T(value*factor); }
+};
+
+}
+
+/**
+ * Expression node for elementwise binary operations
+ *
+ * @tparam L Type of the left operand.
+ * @tparam R Type of the right operand.
+ * @tparam Op Operation with a static apply(lhs, rhs) function.
+ */
+template<typename L, typename R, typename Op>
+class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L,R,Op>>
+{
+	static_assert((L::rows == R::rows) && (L::cols == R::cols), "Matrix dimensions must agree");
+	static_assert(std::is_same<typename L::ScalarType, typename R::ScalarType>::value, "Scalar types must agree");
+
+private:
+	typename ExpressionOperand<L>::type lhs_;
+	typename ExpressionOperand<R>::type rhs_;
+
+public:
+	//! Type of the entries
+	typedef typename L::ScalarType ScalarType;
+	//! Number of rows of the expression
+	static constexpr size_t rows = L::rows;
+	//! Number of columns of the expression
+	static constexpr size_t cols = L::cols;
+
+	constexpr MatrixBinaryExpression(const L& lhs, const R& rhs)
+		: lhs_(lhs), rhs_(rhs) {}
+
+	//! Returns the i-th entry of the expression (column major)
+	constexpr ScalarType operator[](size_t i) const { return Op::apply(ScalarType(lhs_[i]), ScalarType(rhs_[i])); }
+	//! Returns the entry at the specified coordinates
+	constexpr ScalarType operator()(size_t row, size_t column) const { return Op::apply(ScalarType(lhs_(row,column)), ScalarType(rhs_(row,column))); }
+};
+
+/**
+ * Expression node for elementwise unary operations
+ *
+ * @tparam E Type of the operand.
+ * @tparam Op Operation with an apply(value) member function.
+ */
+template<typename E, typename Op>
+class MatrixUnaryExpression : public MatrixExpression<MatrixUnaryExpression<E,Op>>
+{
+private:
+	typename ExpressionOperand<E>::type operand_;
+	Op op_;
+
+public:
+	//! Type of the entries
+	typedef typename E::ScalarType ScalarType;
+	//! Number of rows of the expression
+	static constexpr size_t rows = E::rows;
+	//! Number of columns of the expression
+	static constexpr size_t cols = E::cols;
+
+	constexpr MatrixUnaryExpression(const E& operand, const Op& op)
+		: operand_(operand), op_(op) {}
+
+	//! Returns the i-th entry of the expression (column major)
+	constexpr ScalarType operator[](size_t i) const { return op_.apply(ScalarType(operand_[i])); }
+	//! Returns the entry at the specified coordinates
+	constexpr ScalarType operator()(size_t row, size_t column) const { return op_.apply(ScalarType(operand_(row,column))); }
+};
+
+/**
+ * Expression node of the transposed of a matrix expression
+ *
+ * Returned by the transposed() methods instead of a copy of the entries. The
+ * node reads the entries of its operand at swapped coordinates. The matrix
+ * product recognises the node and runs directly on the entries of the operand
+ * with swapped strides, i.e. a.transposed()*b doesn't form the transposed of a
+ * and x.transposed()*y of two column vectors is a plain dot product. Assigning
+ * the node to a matrix uses the cache blocked transposition kernel.
+ *
+ * @tparam E Type of the operand.
+ */
+template<typename E>
+class TransposeExpression : public MatrixExpression<TransposeExpression<E>>
+{
+private:
+	typename ExpressionOperand<E>::type operand_;
+
+public:
+	//! Type of the entries
+	typedef typename E::ScalarType ScalarType;
+	//! Number of rows of the expression
+	static constexpr size_t rows = E::cols;
+	//! Number of columns of the expression
+	static constexpr size_t cols = E::rows;
+
+	constexpr explicit TransposeExpression(const E& operand)
+		: operand_(operand) {}
+
+	//! Returns the transposed operand
+	constexpr const E& operand() const { return operand_; }
+	//! Returns the transposed of the transposed, i.e. the operand
+	constexpr const E& transposed() const { return operand_; }
+
+	//! Returns the i-th entry of the expression (column major)
+	constexpr ScalarType operator[](size_t i) const { return ScalarType(operand_(i / rows, i % rows)); }
+	//! Returns the entry at the specified coordinates
+	constexpr ScalarType operator()(size_t row, size_t column) const { return ScalarType(operand_(column, row)); }
+};
+
+namespace detail {
+
+/**
+ * @brief Evaluates to true if the expression contains a transposition
+ *
+ * Elementwise expressions read their operands only at the coordinates of the
+ * entry that is computed and can be assigned to a matrix that is one of their
+ * operands. A transposition reads other coordinates and the expression has to
+ * be evaluated before it's assigned to one of its operands.
+ */
+template<typename E>
+struct ContainsTranspose : std::false_type {};
+
+template<typename E>
+struct ContainsTranspose<TransposeExpression<E>> : std::true_type {};
+
+template<typename L, typename R, typename Op>
+struct ContainsTranspose<MatrixBinaryExpression<L,R,Op>>
+	: std::integral_constant<bool, ContainsTranspose<L>::value || ContainsTranspose<R>::value> {};
+
+template<typename E, typename Op>
+struct ContainsTranspose<MatrixUnaryExpression<E,Op>> : ContainsTranspose<E> {};
+
+/**
+ * @brief Cost of evaluating an entry of an expression (for the FLOP accounting)
+ *
+ * flops is the number of arithmetic operations per entry and operands the
+ * number of matrices read by the expression.
+ */
+template<typename E>
+struct ExpressionCost
+{
+	static constexpr size_t flops = 0;
+	static constexpr size_t operands = 1;
+};
+
+template<typename L, typename R, typename Op>
+struct ExpressionCost<MatrixBinaryExpression<L,R,Op>>
+{
+	static constexpr size_t flops = 1 + ExpressionCost<L>::flops + ExpressionCost<R>::flops;
+	static constexpr size_t operands = ExpressionCost<L>::operands + ExpressionCost<R>::operands;
+};
+
+template<typename E, typename Op>
+struct ExpressionCost<MatrixUnaryExpression<E,Op>>
+{
+	static constexpr size_t flops = 1 + ExpressionCost<E>::flops;
+	static constexpr size_t operands = ExpressionCost<E>::operands;
+};
+
+template<typename E>
+struct ExpressionCost<TransposeExpression<E>> : ExpressionCost<E> {};
+
+//! Returns the expression itself if it can be assigned to its operands
+template<typename E, typename std::enable_if<!ContainsTranspose<E>::value, int>::type = 0>
+inline const E& aliasFree(const E& expr)
+{
+	return expr;
+}
+
+//! Returns the evaluated expression if it contains a transposition
+template<typename E, typename std::enable_if<ContainsTranspose<E>::value, int>::type = 0>
+inline auto aliasFree(const E& expr)
+{
+	return expr.eval();
+}
+
+//! Compares the entries of two expressions of the same dimensions
+template<typename L, typename R>
+inline bool equalEntries(const L& lhs, const R& rhs)
+{
+	static_assert((L::rows == R::rows) && (L::cols == R::cols), "Matrix dimensions must agree");
+	for(size_t j = 0; j < L::cols; j++) {
+		for(size_t i = 0; i < L::rows; i++) {
+			if(!(lhs(i,j) == rhs(i,j))) return false;
+		}
+	}
+	return true;
+}
+
+}
+
+//! Evaluates to true if both types are matrix expressions and at least one of them is an expression node
+template<typename L, typename R>
+struct IsNodeComparison
+	: std::integral_constant<bool, IsMatrixExpression<L>::value && IsMatrixExpression<R>::value
+		&& (IsExpressionNode<L>::value || IsExpressionNode<R>::value)> {};
+
+//! Compares the entries of two matrix expressions. Matrix dimensions must agree.
+template<typename L, typename R, typename = typename std::enable_if<IsNodeComparison<L,R>::value>::type>
+inline bool operator==(const L& lhs, const R& rhs)
+{
+	return detail::equalEntries(lhs, rhs);
+}
+
+//! Compares the entries of two matrix expressions. Matrix dimensions must agree.
+template<typename L, typename R, typename = typename std::enable_if<IsNodeComparison<L,R>::value>::type>
+inline bool operator!=(const L& lhs, const R& rhs)
+{
+	return !detail::equalEntries(lhs, rhs);
+}
+
+//! Returns the sum of the two matrices. Matrix dimensions must agree.
+template<typename L, typename R, typename = typename std::enable_if<IsMatrixExpression<L>::value && IsMatrixExpression<R>::value>::type>
+inline constexpr MatrixBinaryExpression<L,R,detail::SumOp> operator+(const L& lhs, const R& rhs)
+{
+	return MatrixBinaryExpression<L,R,detail::SumOp>(lhs, rhs);
+}
+
+//! Returns the difference of the two matrices. Matrix dimensions must agree.
+template<typename L, typename R, typename = typename std::enable_if<IsMatrixExpression<L>::value && IsMatrixExpression<R>::value>::type>
+inline constexpr MatrixBinaryExpression<L,R,detail::DifferenceOp> operator-(const L& lhs, const R& rhs)
+{
+	return MatrixBinaryExpression<L,R,detail::DifferenceOp>(lhs, rhs);
+}
+
+//! Returns the negated matrix.
+template<typename E, typename = typename std::enable_if<IsMatrixExpression<E>::value>::type>
+inline constexpr MatrixUnaryExpression<E,detail::NegationOp> operator-(const E& in)
+{
+	return MatrixUnaryExpression<E,detail::NegationOp>(in, detail::NegationOp());
+}
+
+//! Returns the matrix scaled by the specified factor.
+template<typename E, typename S, typename = typename std::enable_if<IsScalarFor<S,E>::value>::type>
+inline constexpr MatrixUnaryExpression<E,detail::ScalingOp<S>> operator*(const E& mat, const S& factor)
+{
+	return MatrixUnaryExpression<E,detail::ScalingOp<S>>(mat, detail::ScalingOp<S>{factor});
+}
+
+//! Returns the matrix scaled by the specified factor.
+template<typename S, typename E, typename = typename std::enable_if<IsScalarFor<S,E>::value>::type>
+inline constexpr MatrixUnaryExpression<E,detail::ScalingOp<S>> operator*(const S& factor, const E& mat)
+{
+	return MatrixUnaryExpression<E,detail::ScalingOp<S>>(mat, detail::ScalingOp<S>{factor});
+}
+
+}
@@ -0,0 +1,261 @@
+/*
+	linear_algebra_containers/matrix_view header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "matrix_expression.h"
+#include "matrix.h"
+#include "column_vector.h"
+#include "vector3.h"
+
+namespace lin_algebra {
+
+/**
+ * Matrix view of entries stored in external memory
+ *
+ * A view doesn't own any entries. It wraps a pointer to m x n entries, e.g.
+ * inside of a network frame, a memory mapped file or a staging buffer, so that
+ * the matrix and vector operations can be used on them without copying them
+ * into a Matrix first. The entry (row, column) of the view is stored at
+ * data()[row*rowStride() + column*columnStride()]. By default the entries are
+ * stored column-major without gaps like the entries of a Matrix, other
+ * strides describe padded columns, row-major storage or vectors interleaved
+ * with other data.
+ *
+ * Views are matrix expressions: they can be used as operands of all
+ * arithmetic operators and are converted to matrices implicitly. Products
+ * with views work directly on the strided entries (see gemm.h) and the
+ * transposed of a view is a view with swapped strides. Copies of a view refer
+ * to the same entries, while assignments to a view write to the viewed
+ * entries. The expression assigned to a view must not depend on the entries of
+ * the view through another view (e.g. its transposed), evaluate it first in
+ * this case. Views of constant entries (ConstMatrixView) are read-only.
+ * @tparam T Type of the entries, const qualified for read-only views.
+ * @tparam row_count_param Number of rows of the view.
+ * @tparam column_count_param Number of columns of the view.
+ */
+template<typename T, size_t row_count_param, size_t column_count_param>
+class MatrixView : public MatrixExpression<MatrixView<T,row_count_param,column_count_param>>
+{
+public:
+	//! Type of the matrix entries
+	typedef typename std::remove_const<T>::type ScalarType;
+	//! Number of rows of this view type
+	static constexpr size_t rows = row_count_param;
+	//! Number of columns of this view type
+	static constexpr size_t cols = column_count_param;
+	//! Type of the transposed view
+	typedef MatrixView<T,column_count_param,row_count_param> TransposedViewType;
+	//! Type of a read-only view of column vectors with the same number of rows
+	typedef MatrixView<const ScalarType,row_count_param,1> ConstVectorViewType;
+
+private:
+	T* data_;
+	size_t rowStride_;
+	size_t columnStride_;
+
+	template<typename E>
+	void assign(const E& expr)
+	{
+		static_assert(!std::is_const<T>::value, "Views of constant entries are read-only");
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) (*this)(i,j) = expr(i,j);
+		}
+	}
+
+public:
+	//! Constructs a view of m*n entries stored column-major without gaps
+	explicit MatrixView(T* data)
+		: data_(data), rowStride_(1), columnStride_(rows)
+	{
+	}
+
+	//! Constructs a view of the entries with the entry (row, column) stored at data[row*rowStride + column*columnStride]
+	MatrixView(T* data, size_t rowStride, size_t columnStride)
+		: data_(data), rowStride_(rowStride), columnStride_(columnStride)
+	{
+	}
+
+	//! Constructs a view of the entries of the specified matrix
+	template<typename Storage>
+	MatrixView(Matrix<ScalarType,row_count_param,column_count_param,Storage>& mat)
+		: data_(mat.data()), rowStride_(1), columnStride_(Matrix<ScalarType,row_count_param,column_count_param,Storage>::leading_dimension)
+	{
+	}
+
+	//! Constructs a read-only view of the entries of the specified matrix
+	template<typename Storage, typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+	MatrixView(const Matrix<ScalarType,row_count_param,column_count_param,Storage>& mat)
+		: data_(mat.data()), rowStride_(1), columnStride_(Matrix<ScalarType,row_count_param,column_count_param,Storage>::leading_dimension)
+	{
+	}
+
+	//! Converts a view to a read-only view of the same entries
+	template<typename U, typename = typename std::enable_if<std::is_same<const U,T>::value && !std::is_same<U,T>::value>::type>
+	MatrixView(const MatrixView<U,row_count_param,column_count_param>& view)
+		: data_(view.data()), rowStride_(view.rowStride()), columnStride_(view.columnStride())
+	{
+	}
+
+	//! Constructs a view of the same entries as the specified view
+	MatrixView(const MatrixView&) = default;
+
+	//! Assigns the entries of the specified view to the entries of this view
+	MatrixView& operator=(const MatrixView& other)
+	{
+		assign(other);
+		return *this;
+	}
+
+	//! Assigns the result of the specified matrix expression to the entries of this view
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,ScalarType,row_count_param,column_count_param>::value>::type>
+	MatrixView& operator=(const E& expr)
+	{
+		assign(expr);
+		return *this;
+	}
+
+	//! Returns a reference to the entry at the specified coordinates
+	T& operator()(size_t row, size_t column) const { return data_[row*rowStride_ + column*columnStride_]; }
+	//! Returns a reference to the i-th entry of the view (column major)
+	T& operator[](size_t i) const { return (*this)(i % rows, i / rows); }
+
+	//! Returns a pointer to the first entry
+	T* data() const { return data_; }
+	//! Returns the distance between two consecutive entries of a column
+	size_t rowStride() const { return rowStride_; }
+	//! Returns the distance between two consecutive entries of a row
+	size_t columnStride() const { return columnStride_; }
+
+	//! Sets all entries to the specified value
+	const MatrixView& fill(const ScalarType& value) const
+	{
+		static_assert(!std::is_const<T>::value, "Views of constant entries are read-only");
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) (*this)(i,j) = value;
+		}
+		return *this;
+	}
+
+	//! Sets all entries to zero
+	const MatrixView& zeros() const { return fill(ScalarType(0)); }
+
+	//! Returns a view of the transposed of the viewed matrix (the same entries with swapped strides)
+	TransposedViewType transposed() const
+	{
+		return TransposedViewType(data_, columnStride_, rowStride_);
+	}
+
+	//! Calculates the inner product of two column vectors, matrices are viewed without copying
+	static ScalarType dotProduct(const ConstVectorViewType& v1, const ConstVectorViewType& v2)
+	{
+		static_assert(column_count_param == 1, "The inner product is only defined for column vectors");
+		ScalarType result(0);
+		for(size_t i = 0; i < rows; i++) result += v1[i]*v2[i];
+		return result;
+	}
+
+	//! Normalizes the viewed column vector by dividing all entries by its length
+	const MatrixView& normalize() const
+	{
+		(*this) *= (1/this->norm());
+		return *this;
+	}
+
+	//! Adds the right matrix to the viewed entries
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,ScalarType,row_count_param,column_count_param>::value>::type>
+	const MatrixView& operator+=(const E& rhs) const
+	{
+		static_assert(!std::is_const<T>::value, "Views of constant entries are read-only");
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) (*this)(i,j) += rhs(i,j);
+		}
+		return *this;
+	}
+
+	//! Substracts the right matrix from the viewed entries
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,ScalarType,row_count_param,column_count_param>::value>::type>
+	const MatrixView& operator-=(const E& rhs) const
+	{
+		static_assert(!std::is_const<T>::value, "Views of constant entries are read-only");
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) (*this)(i,j) -= rhs(i,j);
+		}
+		return *this;
+	}
+
+	//! Scales the viewed entries by the specified factor
+	const MatrixView& operator*=(const ScalarType& factor) const
+	{
+		static_assert(!std::is_const<T>::value, "Views of constant entries are read-only");
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) (*this)(i,j) *= factor;
+		}
+		return *this;
+	}
+};
+
+//! View of read-only entries, see MatrixView
+template<typename T, size_t m, size_t n>
+using ConstMatrixView = MatrixView<const T,m,n>;
+
+//! View of a column vector, see MatrixView
+template<typename T, size_t dim>
+using VectorView = MatrixView<T,dim,1>;
+
+//! View of a read-only column vector, see MatrixView
+template<typename T, size_t dim>
+using ConstVectorView = MatrixView<const T,dim,1>;
+
+namespace detail {
+
+//! Operand of the matrix product: views are multiplied in place with their strides
+template<typename T, size_t m, size_t n>
+class GemmOperand<MatrixView<T,m,n>>
+{
+public:
+	typedef typename MatrixView<T,m,n>::ScalarType ScalarType;
+	typedef DenseStorage StorageType;
+
+private:
+	const MatrixView<T,m,n> view_;
+
+public:
+	explicit GemmOperand(const MatrixView<T,m,n>& view)
+		: view_(view)
+	{
+	}
+
+	const ScalarType* data() const { return view_.data(); }
+	size_t rowStride() const { return view_.rowStride(); }
+	size_t columnStride() const { return view_.columnStride(); }
+};
+
+}
+
+}
@@ -25,7 +25,16 @@
 
 #pragma once
 
-#include <array>
+#include <functional>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+#include "matrix_expression.h"
+#include "storage.h"
+#include "cpu_dispatch.h"
+#include "transpose_kernels.h"
+#include "flop_accounting.h"
 
 namespace lin_algebra {
 
@@ -37,60 +46,273 @@ namespace lin_algebra {
 * This class specifies only methods that don't return matrix types so that
 * subclassing and partial specialization allows to return specialized types
 * (i.e. vec+vec=vec, mat*vec=vec to allow (mat*vec).norm()=scalar etc.).
+* Matrices are leaves of the expression templates in matrix_expression.h.
+* The memory layout of the entries is specified by the storage policy, see
+* storage.h.
 */
-template<typename T, size_t row_count_param, size_t column_count_param>
-class MatrixBase
+template<typename T, size_t row_count_param, size_t column_count_param, typename Storage = DenseStorage>
+class MatrixBase : public MatrixExpressionTag
 {
+private:
+	typedef detail::StorageLayout<T,row_count_param,column_count_param,Storage> Layout;
+
 public:
+	//! Type of the matrix entries
+	typedef T ScalarType;
+	//! Storage policy of this matrix type
+	typedef Storage StorageType;
 	//! Number of rows of this matrix type
 	static constexpr size_t rows = row_count_param;
 	//! Number of columns of this matrix type
 	static constexpr size_t cols = column_count_param;
+	//! Distance between the first entries of two consecutive columns in the underlying array
+	static constexpr size_t leading_dimension = Layout::leading_dimension;
+	//! Number of entries of the underlying array (including the padding of the columns)
+	static constexpr size_t storage_size = Layout::size;
 
 protected:
-	//! Array storing the matrix entries
-	std::array<T,rows*cols> entries_;
+	//! Array storing the matrix entries (inside of the matrix object or on the heap, see storage.h)
+	typename Layout::ArrayType entries_;
+
+private:
+	//! Elementwise kernels selected for the scalar type and the size of the underlying array
+	typedef detail::Elementwise<T,storage_size> ElementwiseKernels;
+	//! Evaluates to true if the columns are stored without padding
+	typedef std::integral_constant<bool, leading_dimension == rows> IsContiguous;
+	//! Evaluates to true if matrices constructed without initialization leave their entries uninitialized
+	typedef std::integral_constant<bool, IsContiguous::value && !detail::IsUnrolledSize<storage_size>::value> IsUninitialized;
+
+	// Dynamic matrices take over and hand over the entries of heap matrices
+	template<typename>
+	friend class DynamicMatrix;
 
 public:
 	//! Constructs a matrix (either unintialized if called without arguments or initialized with the specified values)
 	template<typename ...Ts>
-	MatrixBase(Ts... values)
-		: entries_{values...}
+	constexpr MatrixBase(Ts... values)
+		: MatrixBase(IsContiguous(), values...)
+	{
+	}
+
+	/**
+	 * @brief Constructs a matrix without initializing the entries
+	 *
+	 * The padding of padded columns is set to zero. Matrices processed by the
+	 * unrolled kernels (see IsUnrolledSize) are value-initialized, so that
+	 * they can be evaluated from expressions in constant expressions. The
+	 * compiler removes these stores when all entries are assigned afterwards.
+	 */
+	explicit constexpr MatrixBase(detail::UninitializedTag tag)
+		: MatrixBase(tag, IsUninitialized())
+	{
+	}
+
+	//! Constructs a matrix with heap storage taking ownership of the specified entries (see HeapArray)
+	MatrixBase(detail::AdoptTag tag, T* values)
+		: entries_(tag, values)
+	{
+	}
+
+private:
+	MatrixBase(detail::UninitializedTag tag, std::true_type)
+		: entries_(tag)
+	{
+	}
+
+	// The kernels process the padding together with the entries, so it must not be left uninitialized
+	constexpr MatrixBase(detail::UninitializedTag, std::false_type)
+		: entries_(detail::EntryListTag())
+	{
+	}
+
+	template<typename ...Ts>
+	constexpr MatrixBase(std::true_type, Ts... values)
+		: entries_(detail::EntryListTag(), values...)
 	{
 	}
 
-	//! Returns the element index of the specified coordinates
-	static constexpr size_t index(size_t row, size_t column) { return row + column*rows; }
+	template<typename ...Ts>
+	constexpr MatrixBase(std::false_type, Ts... values)
+		: entries_(detail::EntryListTag())
+	{
+		static_assert(sizeof...(Ts) <= rows*cols, "Too many initializers for the matrix");
+		const T list[] = {T(values)..., T(0)};
+		for(size_t i = 0; i < sizeof...(Ts); i++) entries_[MatrixBase::storageIndex(i)] = list[i];
+	}
+
+public:
+	//! Returns the element index of the specified coordinates in the underlying array
+	static constexpr size_t index(size_t row, size_t column) { return row + column*leading_dimension; }
+	//! Returns the index in the underlying array of the i-th entry (column major)
+	static constexpr size_t storageIndex(size_t i) { return (leading_dimension == rows) ? i : i % rows + (i/rows)*leading_dimension; }
 
 	//! Returns a reference to the entry at the specified coordinates
-	T& operator()(size_t row, size_t column) { return entries_[MatrixBase::index(row,column)]; }
+	constexpr T& operator()(size_t row, size_t column) { return entries_[MatrixBase::index(row,column)]; }
 	//! Returns a const reference to the entry at the specified coordinates
-	const T& operator()(size_t row, size_t column) const { return entries_[MatrixBase::index(row,column)]; }
+	constexpr const T& operator()(size_t row, size_t column) const { return entries_[MatrixBase::index(row,column)]; }
 
-	//! Returns a reference to the i-th element stored in the matrix (column major)
-	T& operator[](size_t i) { return entries_[i]; }
-	//! Returns a const-reference to the i-th element stored in the matrix (column major)
-	const T& operator[](size_t i) const { return entries_[i]; }
+	//! Returns a reference to the i-th element stored in the matrix (column major, padding is skipped)
+	constexpr T& operator[](size_t i) { return entries_[MatrixBase::storageIndex(i)]; }
+	//! Returns a const-reference to the i-th element stored in the matrix (column major, padding is skipped)
+	constexpr const T& operator[](size_t i) const { return entries_[MatrixBase::storageIndex(i)]; }
 
-	//! Returns a pointer to the underlying array (column major)
-	T* data() { return entries_.data(); }
-	//! Returns a const-pointer to the underlying array (column major)
-	const T* data() const { return entries_.data(); }
+	/**
+	 * @brief Returns a pointer to the underlying array
+	 *
+	 * The entries are stored in column-major order. The entry (row, column) is
+	 * stored at data()[index(row, column)]. Without padding (the default) the
+	 * array is contiguous and data()[i] is the same as (*this)[i]. With padded
+	 * columns every column starts leading_dimension entries after the previous
+	 * one and the array has storage_size entries.
+	 */
+	constexpr T* data() { return entries_.data(); }
+	//! Returns a const-pointer to the underlying array (see data())
+	constexpr const T* data() const { return entries_.data(); }
 
 	//! Sets all entries to the specified value
-	MatrixBase& fill(const T& val) { for(auto& v : entries_) v = val; return *this; }
+	MatrixBase& fill(const T& val)
+	{
+		entries_.allocateIfEmpty();
+		ElementwiseKernels::fill(entries_.data(), val, storage_size);
+		return *this;
+	}
 	//! Sets all entries to zero
 	MatrixBase& zeros() { this->fill(T(0)); return *this; }
 
+protected:
+	//! Assigns the entries of the specified expression to this matrix
+	template<typename E>
+	constexpr void assign(const E& expr)
+	{
+		typedef detail::ExpressionCost<E> Cost;
+		detail::beginOperation<T>(AccountedOperation::Elementwise, Cost::flops*rows*cols, (Cost::operands + 1)*rows*cols);
+		entries_.allocateIfEmpty();
+		assign(expr, IsContiguous());
+		detail::endOperation<T>();
+	}
+	//! Assigns the transposed of an expression (unrolled for small matrices, otherwise with the cache blocked transposition kernel)
+	template<typename E>
+	constexpr void assign(const TransposeExpression<E>& expr)
+	{
+		detail::beginOperation<T>(AccountedOperation::Transpose, 0, 2*rows*cols);
+		entries_.allocateIfEmpty();
+		assignTransposed(expr, detail::IsUnrolledSize<rows*cols>());
+		detail::endOperation<T>();
+	}
+	//! Assigns an expression that may read the entries of this matrix at other coordinates
+	template<typename E>
+	void assignAliased(const E& expr) { assign(detail::aliasFree(expr)); }
+	template<typename E>
+	void assignAliased(const TransposeExpression<E>& expr) { assign(expr); }
+	//! Adds the entries of the specified expression to this matrix (a moved-from heap matrix is zero)
+	template<typename E>
+	void addAssign(const E& expr)
+	{
+		typedef detail::ExpressionCost<E> Cost;
+		const detail::OperationScope<T> scope(AccountedOperation::Elementwise, (Cost::flops + 1)*rows*cols, (Cost::operands + 2)*rows*cols);
+		const auto& operand = detail::aliasFree(expr);
+		entries_.allocateIfEmpty();
+		addAssign(operand, std::is_base_of<MatrixBase,typename std::decay<decltype(operand)>::type>());
+	}
+	//! Subtracts the entries of the specified expression from this matrix
+	template<typename E>
+	void subtractAssign(const E& expr)
+	{
+		typedef detail::ExpressionCost<E> Cost;
+		const detail::OperationScope<T> scope(AccountedOperation::Elementwise, (Cost::flops + 1)*rows*cols, (Cost::operands + 2)*rows*cols);
+		const auto& operand = detail::aliasFree(expr);
+		entries_.allocateIfEmpty();
+		subtractAssign(operand, std::is_base_of<MatrixBase,typename std::decay<decltype(operand)>::type>());
+	}
+	//! Multiplies all entries of this matrix by the specified factor
+	template<typename S>
+	void scaleAssign(const S& factor)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::Elementwise, rows*cols, 2*rows*cols);
+		entries_.allocateIfEmpty();
+		ElementwiseKernels::scale(entries_.data(), factor, storage_size);
+	}
+
+private:
+	template<typename E>
+	constexpr void assign(const E& expr, std::true_type) { for(size_t i = 0; i < rows*cols; i++) entries_[i] = expr[i]; }
+	template<typename E>
+	constexpr void assign(const E& expr, std::false_type)
+	{
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) entries_[MatrixBase::index(i,j)] = expr(i,j);
+		}
+	}
+
+	//! Reads all entries of the transposed before they are assigned, so the operand may refer to this matrix (e.g. a = a.transposed())
+	template<typename E>
+	constexpr void assignTransposed(const TransposeExpression<E>& expr, std::true_type)
+	{
+		assignTransposed(expr, std::make_index_sequence<rows*cols>());
+	}
+	template<typename E, size_t ...I>
+	constexpr void assignTransposed(const TransposeExpression<E>& expr, std::index_sequence<I...>)
+	{
+		const T values[] = {T(expr[I])...};
+		for(size_t i = 0; i < rows*cols; i++) (*this)[i] = values[i];
+	}
+	template<typename E>
+	void assignTransposed(const TransposeExpression<E>& expr, std::false_type)
+	{
+		const detail::GemmOperand<E> operand(expr.operand());
+		const T* source = operand.data();
+		const T* sourceEnd = source + (E::rows - 1)*operand.rowStride() + (E::cols - 1)*operand.columnStride() + 1;
+		const std::less<const T*> before;
+		if(before(source, entries_.data() + storage_size) && before(entries_.data(), sourceEnd)) {
+			// The operand refers to the entries of this matrix (e.g. a = a.transposed())
+			typedef Matrix<T,E::rows,E::cols,Storage> CopyType;
+			const CopyType copy(expr.operand());
+			detail::transposeBlocked(E::rows, E::cols, copy.data(), size_t(1), size_t(CopyType::leading_dimension), entries_.data(), leading_dimension);
+		} else {
+			detail::transposeBlocked(E::rows, E::cols, source, operand.rowStride(), operand.columnStride(), entries_.data(), leading_dimension);
+		}
+	}
+
+	template<typename E>
+	void addAssign(const E& expr, std::false_type)
+	{
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) entries_[MatrixBase::index(i,j)] += expr(i,j);
+		}
+	}
+	void addAssign(const MatrixBase& mat, std::true_type) { ElementwiseKernels::add(entries_.data(), mat.entries_.data(), storage_size); }
+
+	template<typename E>
+	void subtractAssign(const E& expr, std::false_type)
+	{
+		for(size_t j = 0; j < cols; j++) {
+			for(size_t i = 0; i < rows; i++) entries_[MatrixBase::index(i,j)] -= expr(i,j);
+		}
+	}
+	void subtractAssign(const MatrixBase& mat, std::true_type) { ElementwiseKernels::subtract(entries_.data(), mat.entries_.data(), storage_size); }
+
+	//! Compares the entries of the matrices (without the padding)
+	static bool equal(const MatrixBase& lhs, const MatrixBase& rhs)
+	{
+		if(IsContiguous::value) return ElementwiseKernels::equal(lhs.entries_.data(), rhs.entries_.data(), rows*cols);
+
+		typedef detail::Elementwise<T,rows> ColumnKernels;
+		for(size_t j = 0; j < cols; j++) {
+			if(!ColumnKernels::equal(lhs.entries_.data() + j*leading_dimension, rhs.entries_.data() + j*leading_dimension, rows)) return false;
+		}
+		return true;
+	}
+
+public:
 	//! Compares the matrices elementwise for equality
-	friend bool operator==(const MatrixBase& lhs, const MatrixBase& rhs) { return lhs.entries_ == rhs.entries_; }
+	friend bool operator==(const MatrixBase& lhs, const MatrixBase& rhs) { return MatrixBase::equal(lhs, rhs); }
 	//! Compares the matrices elementwise for inequality
 	friend bool operator!=(const MatrixBase& lhs, const MatrixBase& rhs) { return !(lhs == rhs); }
 };
 
 //! Prints the matrix to the specified stream
-template<typename T, size_t m, size_t n>
-inline std::ostream& operator<<(std::ostream& os, const MatrixBase<T,m,n>& mat)
+template<typename T, size_t m, size_t n, typename Storage>
+inline std::ostream& operator<<(std::ostream& os, const MatrixBase<T,m,n,Storage>& mat)
 {
 	os << "[";
 	for(size_t i = 0; i < m; i++) {
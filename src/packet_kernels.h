@@ -0,0 +1,1020 @@
+/*
+	linear_algebra_containers/packet_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// This header has no include guard. It is included by cpu_dispatch.h once
+// for the instruction sets enabled at compile time and once per instruction
+// set of the runtime dispatch inside of a region with the matching target
+// options, so that the kernels are compiled for each instruction set
+// independent of the compiler flags. LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE
+// specifies the namespace of the kernels of the current pass.
+
+#ifndef LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE
+	#error "packet_kernels.h must be included from cpu_dispatch.h"
+#endif
+
+namespace lin_algebra {
+namespace detail {
+namespace LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE {
+
+/**
+ * Elementwise kernels on contiguous arrays
+ *
+ * The packet loop handles all full packets and a scalar loop handles the
+ * remaining size % Packet::size entries.
+ */
+template<typename T, typename Isa>
+struct PacketElementwiseKernel
+{
+	typedef simd::Packet<T,Isa> P;
+
+	//! dst[i] += src[i]
+	static void add(T* dst, const T* src, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) P::store(dst + i, P::add(P::load(dst + i), P::load(src + i)));
+		for(; i < n; i++) dst[i] += src[i];
+	}
+
+	//! dst[i] -= src[i]
+	static void subtract(T* dst, const T* src, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) P::store(dst + i, P::sub(P::load(dst + i), P::load(src + i)));
+		for(; i < n; i++) dst[i] -= src[i];
+	}
+
+	//! dst[i] *= factor
+	template<typename S>
+	static void scale(T* dst, const S& factor, size_t n)
+	{
+		// The packets multiply in T which only gives the same result as the
+		// scalar code if the factor is exactly representable in T
+		const T f = T(factor);
+		if(S(f) != factor) {
+			ScalarElementwiseKernel<T>::scale(dst, factor, n);
+			return;
+		}
+
+		const typename P::type fp = P::set1(f);
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) P::store(dst + i, P::mul(P::load(dst + i), fp));
+		for(; i < n; i++) dst[i] *= f;
+	}
+
+	//! dst[i] = value
+	static void fill(T* dst, const T& value, size_t n)
+	{
+		const typename P::type vp = P::set1(value);
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) P::store(dst + i, vp);
+		for(; i < n; i++) dst[i] = value;
+	}
+
+	//! Returns the sum of lhs[i]*rhs[i] (accumulated in one partial sum per lane)
+	static T dot(const T* lhs, const T* rhs, size_t n)
+	{
+		typename P::type acc = P::zero();
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) acc = P::fmadd(P::load(lhs + i), P::load(rhs + i), acc);
+		T result = P::sum(acc);
+		for(; i < n; i++) result += lhs[i]*rhs[i];
+		return result;
+	}
+
+	//! Returns whether lhs[i] == rhs[i] for all i
+	static bool equal(const T* lhs, const T* rhs, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			if(!P::equal(P::load(lhs + i), P::load(rhs + i))) return false;
+		}
+		for(; i < n; i++) {
+			if(!(lhs[i] == rhs[i])) return false;
+		}
+		return true;
+	}
+};
+
+/**
+ * Elementwise kernels on arrays with a small compile-time size
+ *
+ * Same as PacketElementwiseKernel for arrays of exactly size entries (the
+ * runtime size argument is ignored) with the packet loop and the remainder
+ * loop expanded from index sequences (see UnrolledElementwiseKernel).
+ */
+template<typename T, typename Isa, size_t size,
+	typename Packets = std::make_index_sequence<size / simd::Packet<T,Isa>::size>,
+	typename Remainder = std::make_index_sequence<size % simd::Packet<T,Isa>::size>>
+struct UnrolledPacketElementwiseKernel;
+
+template<typename T, typename Isa, size_t size, size_t ...J, size_t ...R>
+struct UnrolledPacketElementwiseKernel<T,Isa,size,std::index_sequence<J...>,std::index_sequence<R...>>
+{
+	typedef simd::Packet<T,Isa> P;
+	static constexpr size_t packed = size - size % P::size;
+
+	//! dst[i] += src[i]
+	static void add(T* dst, const T* src, size_t = size)
+	{
+		const int packets[] = { 0, ((void)P::store(dst + J*P::size, P::add(P::load(dst + J*P::size), P::load(src + J*P::size))), 0)... };
+		const int remainder[] = { 0, ((void)(dst[packed + R] += src[packed + R]), 0)... };
+		(void)packets;
+		(void)remainder;
+	}
+
+	//! dst[i] -= src[i]
+	static void subtract(T* dst, const T* src, size_t = size)
+	{
+		const int packets[] = { 0, ((void)P::store(dst + J*P::size, P::sub(P::load(dst + J*P::size), P::load(src + J*P::size))), 0)... };
+		const int remainder[] = { 0, ((void)(dst[packed + R] -= src[packed + R]), 0)... };
+		(void)packets;
+		(void)remainder;
+	}
+
+	//! dst[i] *= factor
+	template<typename S>
+	static void scale(T* dst, const S& factor, size_t = size)
+	{
+		// See PacketElementwiseKernel::scale
+		const T f = T(factor);
+		if(S(f) != factor) {
+			UnrolledElementwiseKernel<T,size>::scale(dst, factor);
+			return;
+		}
+
+		const typename P::type fp = P::set1(f);
+		const int packets[] = { 0, ((void)P::store(dst + J*P::size, P::mul(P::load(dst + J*P::size), fp)), 0)... };
+		const int remainder[] = { 0, ((void)(dst[packed + R] *= f), 0)... };
+		(void)packets;
+		(void)remainder;
+	}
+
+	//! dst[i] = value
+	static void fill(T* dst, const T& value, size_t = size)
+	{
+		const typename P::type vp = P::set1(value);
+		const int packets[] = { 0, ((void)P::store(dst + J*P::size, vp), 0)... };
+		const int remainder[] = { 0, ((void)(dst[packed + R] = value), 0)... };
+		(void)packets;
+		(void)remainder;
+	}
+
+	//! Returns the sum of lhs[i]*rhs[i] (accumulated in one partial sum per lane)
+	static T dot(const T* lhs, const T* rhs, size_t = size)
+	{
+		typename P::type acc = P::zero();
+		const int packets[] = { 0, ((void)(acc = P::fmadd(P::load(lhs + J*P::size), P::load(rhs + J*P::size), acc)), 0)... };
+		T result = P::sum(acc);
+		const int remainder[] = { 0, ((void)(result += lhs[packed + R]*rhs[packed + R]), 0)... };
+		(void)packets;
+		(void)remainder;
+		return result;
+	}
+
+	//! Returns whether lhs[i] == rhs[i] for all i
+	static bool equal(const T* lhs, const T* rhs, size_t = size)
+	{
+		bool result = true;
+		const int packets[] = { 0, ((void)(result = result && P::equal(P::load(lhs + J*P::size), P::load(rhs + J*P::size))), 0)... };
+		const int remainder[] = { 0, ((void)(result = result && (lhs[packed + R] == rhs[packed + R])), 0)... };
+		(void)packets;
+		(void)remainder;
+		return result;
+	}
+};
+
+/**
+ * @brief Compute one register tile of the product with SIMD packets
+ *
+ * Same as gemmMicroKernel but keeps the MR x NR tile in MR/Packet::size x NR
+ * packet accumulators and uses fused multiply-adds where available.
+ */
+template<typename T, typename Isa>
+struct PacketGemmMicroKernel
+{
+	typedef simd::Packet<T,Isa> P;
+	typedef typename P::type PacketType;
+
+	static constexpr size_t MR = GemmBlocking<T>::MR;
+	static constexpr size_t NR = GemmBlocking<T>::NR;
+	static constexpr size_t MP = MR/P::size;
+	static_assert(MR % P::size == 0, "Register tile must consist of full packets");
+
+	static void run(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr, bool accumulate)
+	{
+		PacketType acc[MP*NR];
+		for(size_t i = 0; i < MP*NR; i++) acc[i] = P::zero();
+
+		for(size_t k = 0; k < kc; k++) {
+			PacketType ak[MP];
+			for(size_t i = 0; i < MP; i++) ak[i] = P::load(a + i*P::size);
+			for(size_t j = 0; j < NR; j++) {
+				const PacketType bkj = P::set1(b[j]);
+				for(size_t i = 0; i < MP; i++) {
+					acc[i + j*MP] = P::fmadd(ak[i], bkj, acc[i + j*MP]);
+				}
+			}
+			a += MR;
+			b += NR;
+		}
+
+		if(mr == MR && nr == NR) {
+			for(size_t j = 0; j < NR; j++) {
+				for(size_t i = 0; i < MP; i++) {
+					T* cij = c + i*P::size + j*ldc;
+					P::store(cij, accumulate ? P::add(P::load(cij), acc[i + j*MP]) : acc[i + j*MP]);
+				}
+			}
+		} else {
+			T tile[MR*NR];
+			for(size_t j = 0; j < NR; j++) {
+				for(size_t i = 0; i < MP; i++) P::store(tile + i*P::size + j*MR, acc[i + j*MP]);
+			}
+			for(size_t j = 0; j < nr; j++) {
+				T* cj = c + j*ldc;
+				if(accumulate) {
+					for(size_t i = 0; i < mr; i++) cj[i] += tile[i + j*MR];
+				} else {
+					for(size_t i = 0; i < mr; i++) cj[i] = tile[i + j*MR];
+				}
+			}
+		}
+	}
+};
+
+/**
+ * @brief Transform an array of 3d vectors with SIMD packets
+ *
+ * Same as transform3 but processes Packet::size vectors at once. Each block
+ * of vectors is split into x, y and z lanes in a small buffer that stays in
+ * the L1 cache, transformed with packet arithmetic and interleaved again.
+ */
+template<typename T, typename Isa>
+struct PacketTransform3
+{
+	typedef simd::Packet<T,Isa> P;
+	typedef typename P::type PacketType;
+
+	static void run(const T* mat, const T* in, T* out, size_t count)
+	{
+		const PacketType m00 = P::set1(mat[0]), m10 = P::set1(mat[1]), m20 = P::set1(mat[2]);
+		const PacketType m01 = P::set1(mat[3]), m11 = P::set1(mat[4]), m21 = P::set1(mat[5]);
+		const PacketType m02 = P::set1(mat[6]), m12 = P::set1(mat[7]), m22 = P::set1(mat[8]);
+
+		T x[P::size], y[P::size], z[P::size];
+
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			const T* src = in + 3*i;
+			for(size_t l = 0; l < P::size; l++) {
+				x[l] = src[3*l];
+				y[l] = src[3*l + 1];
+				z[l] = src[3*l + 2];
+			}
+
+			const PacketType px = P::load(x);
+			const PacketType py = P::load(y);
+			const PacketType pz = P::load(z);
+			P::store(x, P::fmadd(m02, pz, P::fmadd(m01, py, P::mul(m00, px))));
+			P::store(y, P::fmadd(m12, pz, P::fmadd(m11, py, P::mul(m10, px))));
+			P::store(z, P::fmadd(m22, pz, P::fmadd(m21, py, P::mul(m20, px))));
+
+			T* dst = out + 3*i;
+			for(size_t l = 0; l < P::size; l++) {
+				dst[3*l] = x[l];
+				dst[3*l + 1] = y[l];
+				dst[3*l + 2] = z[l];
+			}
+		}
+
+		transform3(mat, in + 3*i, out + 3*i, count - i);
+	}
+
+	//! Rotates count vectors by a stream of count quaternions, see quaternionRotate3
+	static void rotate(const T* quats, const T* in, T* out, size_t count)
+	{
+		const PacketType two = P::set1(T(2));
+
+		T w[P::size], qx[P::size], qy[P::size], qz[P::size];
+		T x[P::size], y[P::size], z[P::size];
+
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			const T* q = quats + 4*i;
+			const T* src = in + 3*i;
+			for(size_t l = 0; l < P::size; l++) {
+				w[l] = q[4*l];
+				qx[l] = q[4*l + 1];
+				qy[l] = q[4*l + 2];
+				qz[l] = q[4*l + 3];
+				x[l] = src[3*l];
+				y[l] = src[3*l + 1];
+				z[l] = src[3*l + 2];
+			}
+
+			const PacketType pw = P::load(w), pqx = P::load(qx), pqy = P::load(qy), pqz = P::load(qz);
+			const PacketType px = P::load(x), py = P::load(y), pz = P::load(z);
+			const PacketType tx = P::mul(two, P::sub(P::mul(pqy, pz), P::mul(pqz, py)));
+			const PacketType ty = P::mul(two, P::sub(P::mul(pqz, px), P::mul(pqx, pz)));
+			const PacketType tz = P::mul(two, P::sub(P::mul(pqx, py), P::mul(pqy, px)));
+			P::store(x, P::add(P::fmadd(pw, tx, px), P::sub(P::mul(pqy, tz), P::mul(pqz, ty))));
+			P::store(y, P::add(P::fmadd(pw, ty, py), P::sub(P::mul(pqz, tx), P::mul(pqx, tz))));
+			P::store(z, P::add(P::fmadd(pw, tz, pz), P::sub(P::mul(pqx, ty), P::mul(pqy, tx))));
+
+			T* dst = out + 3*i;
+			for(size_t l = 0; l < P::size; l++) {
+				dst[3*l] = x[l];
+				dst[3*l + 1] = y[l];
+				dst[3*l + 2] = z[l];
+			}
+		}
+
+		quaternionRotate3(quats + 4*i, in + 3*i, out + 3*i, count - i);
+	}
+};
+
+
+/**
+ * @brief Kernels on arrays of 3d vectors in structure-of-arrays layout with SIMD packets
+ *
+ * Same as ScalarSoaKernel but processes Packet::size vectors at once. The
+ * packet code uses the same operations in the same order (no fused
+ * multiply-adds), so the results are identical to the scalar kernels.
+ */
+template<typename T, typename Isa>
+struct PacketSoaKernel
+{
+	typedef simd::Packet<T,Isa> P;
+	typedef typename P::type PacketType;
+
+	static void dot3(const T* const* a, const T* const* b, T* out, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		for(size_t i = 0; i < packed; i += P::size) {
+			const PacketType xx = P::mul(P::load(a[0] + i), P::load(b[0] + i));
+			const PacketType yy = P::mul(P::load(a[1] + i), P::load(b[1] + i));
+			const PacketType zz = P::mul(P::load(a[2] + i), P::load(b[2] + i));
+			P::store(out + i, P::add(P::add(xx, yy), zz));
+		}
+
+		const T* aRest[3] = { a[0] + packed, a[1] + packed, a[2] + packed };
+		const T* bRest[3] = { b[0] + packed, b[1] + packed, b[2] + packed };
+		ScalarSoaKernel<T>::dot3(aRest, bRest, out + packed, n - packed);
+	}
+
+	static void cross3(const T* const* a, const T* const* b, T* const* out, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		for(size_t i = 0; i < packed; i += P::size) {
+			const PacketType ax = P::load(a[0] + i), ay = P::load(a[1] + i), az = P::load(a[2] + i);
+			const PacketType bx = P::load(b[0] + i), by = P::load(b[1] + i), bz = P::load(b[2] + i);
+			P::store(out[0] + i, P::sub(P::mul(ay, bz), P::mul(az, by)));
+			P::store(out[1] + i, P::sub(P::mul(az, bx), P::mul(ax, bz)));
+			P::store(out[2] + i, P::sub(P::mul(ax, by), P::mul(ay, bx)));
+		}
+
+		const T* aRest[3] = { a[0] + packed, a[1] + packed, a[2] + packed };
+		const T* bRest[3] = { b[0] + packed, b[1] + packed, b[2] + packed };
+		T* outRest[3] = { out[0] + packed, out[1] + packed, out[2] + packed };
+		ScalarSoaKernel<T>::cross3(aRest, bRest, outRest, n - packed);
+	}
+
+	static void normSquared3(const T* const* a, T* out, size_t n)
+	{
+		const size_t packed = n - n % P::size;
+		for(size_t i = 0; i < packed; i += P::size) {
+			const PacketType x = P::load(a[0] + i), y = P::load(a[1] + i), z = P::load(a[2] + i);
+			P::store(out + i, P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z)));
+		}
+
+		const T* aRest[3] = { a[0] + packed, a[1] + packed, a[2] + packed };
+		ScalarSoaKernel<T>::normSquared3(aRest, out + packed, n - packed);
+	}
+
+	static void normalize3(const T* const* a, T* const* out, size_t n)
+	{
+		const PacketType one = P::set1(T(1));
+		const size_t packed = n - n % P::size;
+		for(size_t i = 0; i < packed; i += P::size) {
+			const PacketType x = P::load(a[0] + i), y = P::load(a[1] + i), z = P::load(a[2] + i);
+			const PacketType factor = P::div(one, P::sqrt(P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z))));
+			P::store(out[0] + i, P::mul(x, factor));
+			P::store(out[1] + i, P::mul(y, factor));
+			P::store(out[2] + i, P::mul(z, factor));
+		}
+
+		const T* aRest[3] = { a[0] + packed, a[1] + packed, a[2] + packed };
+		T* outRest[3] = { out[0] + packed, out[1] + packed, out[2] + packed };
+		ScalarSoaKernel<T>::normalize3(aRest, outRest, n - packed);
+	}
+};
+
+
+/**
+ * @brief Conversions between quaternions and rotation matrices with SIMD packets
+ *
+ * Same as quaternionToMatrix and matrixToQuaternion but processes Packet::size
+ * rotations at once. For the conversion to quaternions the pivot of
+ * Shepperd's method is selected per lane while the square roots and
+ * divisions are computed with packets.
+ */
+template<typename T, typename Isa>
+struct PacketRotationKernel
+{
+	typedef simd::Packet<T,Isa> P;
+	typedef typename P::type PacketType;
+
+	static void toMatrix(const T* quats, T* mats, size_t count)
+	{
+		const PacketType one = P::set1(T(1));
+		const PacketType two = P::set1(T(2));
+
+		T lanes[9][P::size];
+
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			const T* q = quats + 4*i;
+			for(size_t l = 0; l < P::size; l++) {
+				for(size_t k = 0; k < 4; k++) lanes[k][l] = q[4*l + k];
+			}
+
+			const PacketType w = P::load(lanes[0]), x = P::load(lanes[1]), y = P::load(lanes[2]), z = P::load(lanes[3]);
+			const PacketType xx = P::mul(x, x), yy = P::mul(y, y), zz = P::mul(z, z);
+			const PacketType xy = P::mul(x, y), xz = P::mul(x, z), yz = P::mul(y, z);
+			const PacketType wx = P::mul(w, x), wy = P::mul(w, y), wz = P::mul(w, z);
+			P::store(lanes[0], P::sub(one, P::mul(two, P::add(yy, zz))));
+			P::store(lanes[1], P::mul(two, P::add(xy, wz)));
+			P::store(lanes[2], P::mul(two, P::sub(xz, wy)));
+			P::store(lanes[3], P::mul(two, P::sub(xy, wz)));
+			P::store(lanes[4], P::sub(one, P::mul(two, P::add(xx, zz))));
+			P::store(lanes[5], P::mul(two, P::add(yz, wx)));
+			P::store(lanes[6], P::mul(two, P::add(xz, wy)));
+			P::store(lanes[7], P::mul(two, P::sub(yz, wx)));
+			P::store(lanes[8], P::sub(one, P::mul(two, P::add(xx, yy))));
+
+			T* m = mats + 9*i;
+			for(size_t l = 0; l < P::size; l++) {
+				for(size_t k = 0; k < 9; k++) m[9*l + k] = lanes[k][l];
+			}
+		}
+
+		quaternionToMatrix(quats + 4*i, mats + 9*i, count - i);
+	}
+
+	static void fromMatrix(const T* mats, T* quats, size_t count)
+	{
+		const PacketType half = P::set1(T(0.5));
+
+		int component[P::size];
+		T radicand[P::size], root[P::size], factor[P::size];
+
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			const T* m = mats + 9*i;
+			for(size_t l = 0; l < P::size; l++) {
+				const ShepperdPivot<T> pivot(m + 9*l);
+				component[l] = pivot.component;
+				radicand[l] = pivot.radicand;
+			}
+
+			const PacketType r = P::sqrt(P::load(radicand));
+			P::store(root, r);
+			P::store(factor, P::div(half, r));
+
+			T* q = quats + 4*i;
+			for(size_t l = 0; l < P::size; l++) shepperdAssemble(component[l], root[l], factor[l], m + 9*l, q + 4*l);
+		}
+
+		matrixToQuaternion(mats + 9*i, quats + 4*i, count - i);
+	}
+};
+
+/**
+ * @brief Batched inversion of small matrices with SIMD packets
+ *
+ * Same as invertMatrices but inverts Packet::size 4x4 matrices at once. The
+ * entries of the matrices are transposed into one packet per entry, so the
+ * cofactor expansions of SmallInverse are evaluated for all lanes with the
+ * same instructions. The transposition only pays off for the 4x4 cofactor
+ * expansion, smaller matrices use the scalar loop.
+ */
+template<typename T, typename Isa>
+struct PacketInverseKernel
+{
+	typedef simd::Packet<T,Isa> P;
+	typedef typename P::type PacketType;
+
+	//! Loads entry k of the packed matrices of size entries into a packet
+	static void gather(const T* in, size_t size, T (*lanes)[P::size])
+	{
+		for(size_t l = 0; l < P::size; l++) {
+			for(size_t k = 0; k < size; k++) lanes[k][l] = in[size*l + k];
+		}
+	}
+
+	//! Stores the packets of lanes as packed matrices of size entries
+	static void scatter(const T (*lanes)[P::size], size_t size, T* out)
+	{
+		for(size_t l = 0; l < P::size; l++) {
+			for(size_t k = 0; k < size; k++) out[size*l + k] = lanes[k][l];
+		}
+	}
+
+	//! Returns a*b - c*d
+	static PacketType cross(PacketType a, PacketType b, PacketType c, PacketType d)
+	{
+		return P::sub(P::mul(a, b), P::mul(c, d));
+	}
+
+	//! Returns a*x - b*y + c*z
+	static PacketType cofactor(PacketType a, PacketType x, PacketType b, PacketType y, PacketType c, PacketType z)
+	{
+		return P::add(P::sub(P::mul(a, x), P::mul(b, y)), P::mul(c, z));
+	}
+
+	//! 2x2 and 3x3 matrices are inverted with the scalar loop, transposing them into packets costs more than it saves
+	static void invert2(const T* in, T* out, size_t count) { invertMatrices<T,2>(in, out, count); }
+	static void invert3(const T* in, T* out, size_t count) { invertMatrices<T,3>(in, out, count); }
+
+	static void invert4(const T* in, T* out, size_t count)
+	{
+		const PacketType one = P::set1(T(1));
+		T lanes[16][P::size];
+
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			gather(in + 16*i, 16, lanes);
+			const PacketType a00 = P::load(lanes[0]), a10 = P::load(lanes[1]), a20 = P::load(lanes[2]), a30 = P::load(lanes[3]);
+			const PacketType a01 = P::load(lanes[4]), a11 = P::load(lanes[5]), a21 = P::load(lanes[6]), a31 = P::load(lanes[7]);
+			const PacketType a02 = P::load(lanes[8]), a12 = P::load(lanes[9]), a22 = P::load(lanes[10]), a32 = P::load(lanes[11]);
+			const PacketType a03 = P::load(lanes[12]), a13 = P::load(lanes[13]), a23 = P::load(lanes[14]), a33 = P::load(lanes[15]);
+
+			const PacketType s0 = cross(a00, a11, a10, a01);
+			const PacketType s1 = cross(a00, a12, a10, a02);
+			const PacketType s2 = cross(a00, a13, a10, a03);
+			const PacketType s3 = cross(a01, a12, a11, a02);
+			const PacketType s4 = cross(a01, a13, a11, a03);
+			const PacketType s5 = cross(a02, a13, a12, a03);
+			const PacketType k5 = cross(a22, a33, a32, a23);
+			const PacketType k4 = cross(a21, a33, a31, a23);
+			const PacketType k3 = cross(a21, a32, a31, a22);
+			const PacketType k2 = cross(a20, a33, a30, a23);
+			const PacketType k1 = cross(a20, a32, a30, a22);
+			const PacketType k0 = cross(a20, a31, a30, a21);
+
+			const PacketType det = P::add(P::sub(P::add(P::add(P::sub(P::mul(s0, k5), P::mul(s1, k4)), P::mul(s2, k3)),
+				P::mul(s3, k2)), P::mul(s4, k1)), P::mul(s5, k0));
+			const PacketType f = P::div(one, det);
+
+			const PacketType zero = P::zero();
+			P::store(lanes[0], P::mul(cofactor(a11, k5, a12, k4, a13, k3), f));
+			P::store(lanes[1], P::mul(P::sub(zero, cofactor(a10, k5, a12, k2, a13, k1)), f));
+			P::store(lanes[2], P::mul(cofactor(a10, k4, a11, k2, a13, k0), f));
+			P::store(lanes[3], P::mul(P::sub(zero, cofactor(a10, k3, a11, k1, a12, k0)), f));
+			P::store(lanes[4], P::mul(P::sub(zero, cofactor(a01, k5, a02, k4, a03, k3)), f));
+			P::store(lanes[5], P::mul(cofactor(a00, k5, a02, k2, a03, k1), f));
+			P::store(lanes[6], P::mul(P::sub(zero, cofactor(a00, k4, a01, k2, a03, k0)), f));
+			P::store(lanes[7], P::mul(cofactor(a00, k3, a01, k1, a02, k0), f));
+			P::store(lanes[8], P::mul(cofactor(a31, s5, a32, s4, a33, s3), f));
+			P::store(lanes[9], P::mul(P::sub(zero, cofactor(a30, s5, a32, s2, a33, s1)), f));
+			P::store(lanes[10], P::mul(cofactor(a30, s4, a31, s2, a33, s0), f));
+			P::store(lanes[11], P::mul(P::sub(zero, cofactor(a30, s3, a31, s1, a32, s0)), f));
+			P::store(lanes[12], P::mul(P::sub(zero, cofactor(a21, s5, a22, s4, a23, s3)), f));
+			P::store(lanes[13], P::mul(cofactor(a20, s5, a22, s2, a23, s1), f));
+			P::store(lanes[14], P::mul(P::sub(zero, cofactor(a20, s4, a21, s2, a23, s0)), f));
+			P::store(lanes[15], P::mul(cofactor(a20, s3, a21, s1, a22, s0), f));
+			scatter(lanes, 16, out + 16*i);
+		}
+
+		invertMatrices<T,4>(in + 16*i, out + 16*i, count - i);
+	}
+};
+
+//! Multiplies the quaternions q from the right with the rotations (ch, sh*e_k) about the axis k
+template<int k, typename P>
+inline void multiplyAxisRotation(typename P::type* q, typename P::type ch, typename P::type sh)
+{
+	const int a = (k + 1) % 3, b = (k + 2) % 3;
+	const typename P::type w = q[0], va = q[1 + a], vb = q[1 + b], vk = q[1 + k];
+	q[0] = P::sub(P::mul(ch, w), P::mul(sh, vk));
+	q[1 + a] = P::add(P::mul(ch, va), P::mul(sh, vb));
+	q[1 + b] = P::sub(P::mul(ch, vb), P::mul(sh, va));
+	q[1 + k] = P::add(P::mul(ch, vk), P::mul(sh, w));
+}
+
+/**
+ * @brief Eigen decomposition of symmetric 3x3 matrices without branches
+ *
+ * Diagonalizes P::size symmetric matrices at once with JacobiSweeps<T>
+ * sweeps of the Jacobi eigenvalue algorithm. P is a simd::Packet or
+ * simd::ScalarPacket (single matrices and the remainder of a batch), every
+ * lane computes the same operations in the same order as the scalar code.
+ * A sweep conjugates the matrix with rotations about the z, x and y axis
+ * that annihilate s01, s12 and s20. The angles are the approximate Givens
+ * angles of McAdams et al. ("Computing the Singular Value Decomposition of
+ * 3x3 matrices with minimal branching and elementary floating point
+ * operations", 2011): tan(theta/2) = s_ab/(2*(s_aa - s_bb)), replaced by
+ * theta = pi/4 by a lanewise selection where the approximation is too
+ * coarse, which only takes one square root per rotation. The rotations are
+ * accumulated in a quaternion. Finally the eigenvalues are sorted in
+ * descending order by conditional rotations by pi/2 (which swap two
+ * eigenvectors) and the quaternion is normalized.
+ */
+template<typename T, typename P>
+struct JacobiEigen3
+{
+	typedef typename P::type PacketType;
+
+	/**
+	 * @brief Diagonalize the symmetric matrices
+	 *
+	 * d is the diagonal (s00, s11, s22), o the off-diagonal entries
+	 * (s12, s20, s01), i.e. o[k] couples the two axes other than k. Overwrites
+	 * d with the eigenvalues and stores the rotation in q (q0, q1, q2, q3).
+	 */
+	static void decompose(PacketType* d, PacketType* o, PacketType* q)
+	{
+		q[0] = P::set1(T(1));
+		q[1] = P::zero();
+		q[2] = P::zero();
+		q[3] = P::zero();
+		for(int sweep = 0; sweep < JacobiSweeps<T>::value; sweep++) {
+			rotate<2>(d, o, q);
+			rotate<0>(d, o, q);
+			rotate<1>(d, o, q);
+		}
+		swapIfLess<2>(d, q);
+		swapIfLess<0>(d, q);
+		swapIfLess<2>(d, q);
+
+		const PacketType one = P::set1(T(1));
+		const PacketType norm = P::sqrt(P::add(P::add(P::mul(q[0], q[0]), P::mul(q[1], q[1])), P::add(P::mul(q[2], q[2]), P::mul(q[3], q[3]))));
+		const PacketType f = P::div(one, norm);
+		for(int k = 0; k < 4; k++) q[k] = P::mul(q[k], f);
+	}
+
+	//! Decomposes count matrices in structure-of-arrays layout (see SymmetricEigen3Function)
+	static void run(const T* const* tensors, T* const* eigenvalues, T* const* rotations, size_t count)
+	{
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			PacketType d[3] = { P::load(tensors[0] + i), P::load(tensors[1] + i), P::load(tensors[2] + i) };
+			PacketType o[3] = { P::load(tensors[5] + i), P::load(tensors[4] + i), P::load(tensors[3] + i) };
+			PacketType q[4];
+			decompose(d, o, q);
+			for(int k = 0; k < 3; k++) P::store(eigenvalues[k] + i, d[k]);
+			for(int k = 0; k < 4; k++) P::store(rotations[k] + i, q[k]);
+		}
+
+		if(P::size > 1 && i < count) {
+			const T* tensorsRest[6] = { tensors[0] + i, tensors[1] + i, tensors[2] + i, tensors[3] + i, tensors[4] + i, tensors[5] + i };
+			T* eigenvaluesRest[3] = { eigenvalues[0] + i, eigenvalues[1] + i, eigenvalues[2] + i };
+			T* rotationsRest[4] = { rotations[0] + i, rotations[1] + i, rotations[2] + i, rotations[3] + i };
+			JacobiEigen3<T,simd::ScalarPacket<T>>::run(tensorsRest, eigenvaluesRest, rotationsRest, count - i);
+		}
+	}
+
+	/**
+	 * @brief Computes the approximate Jacobi rotation of a symmetric 2x2 matrix
+	 *
+	 * Stores the cosine and sine of the rotation angle that (approximately)
+	 * annihilates the off-diagonal entry o of the matrix with the diagonal
+	 * entries da and db in c and s, and the cosine and sine of the half angle
+	 * in ch and sh. c and s are computed from the squares of the unnormalized
+	 * half angle, so the square root for ch and sh is not on the critical path
+	 * of the conjugation.
+	 */
+	static void rotation(PacketType da, PacketType db, PacketType o, PacketType& c, PacketType& s, PacketType& ch, PacketType& sh)
+	{
+		const PacketType one = P::set1(T(1));
+		const PacketType two = P::set1(T(2));
+		const PacketType gamma = P::set1(T(5.82842712474619009760));	// (1 + sqrt(2))^2
+		const PacketType cosPi8 = P::set1(T(0.92387953251128675613));
+		const PacketType sinPi8 = P::set1(T(0.38268343236508977173));
+		const PacketType sqrtHalf = P::set1(T(0.70710678118654752440));
+
+		// The half angle is given by (x, y), the approximation is used if it is smaller than pi/8
+		// and the squares don't underflow (e.g. for the columns of B in JacobiSvd3 that only
+		// contain rounding errors)
+		const PacketType x = P::mul(two, P::sub(da, db));
+		const PacketType y = o;
+		const PacketType xx = P::mul(x, x), yy = P::mul(y, y);
+		const PacketType gammaYy = P::add(P::mul(gamma, yy), P::set1(std::numeric_limits<T>::min()));
+		const PacketType inverse = P::div(one, P::add(xx, yy));
+		c = P::selectLess(gammaYy, xx, P::mul(P::sub(xx, yy), inverse), sqrtHalf);
+		s = P::selectLess(gammaYy, xx, P::mul(P::mul(two, P::mul(x, y)), inverse), sqrtHalf);
+
+		const PacketType omega = P::sqrt(inverse);
+		ch = P::selectLess(gammaYy, xx, P::mul(omega, x), cosPi8);
+		sh = P::selectLess(gammaYy, xx, P::mul(omega, y), sinPi8);
+	}
+
+private:
+	//! Conjugates the matrix with the rotation about axis k that (approximately) annihilates the entry coupling the axes a and b
+	template<int k>
+	static void rotate(PacketType* d, PacketType* o, PacketType* q)
+	{
+		const int a = (k + 1) % 3, b = (k + 2) % 3;
+		const PacketType two = P::set1(T(2));
+		PacketType c, s, ch, sh;
+		rotation(d[a], d[b], o[k], c, s, ch, sh);
+
+		const PacketType cc = P::mul(c, c), ss = P::mul(s, s), cs = P::mul(c, s);
+		const PacketType da = d[a], db = d[b], ok = o[k], oa = o[a], ob = o[b];
+		const PacketType twoCsO = P::mul(P::mul(two, cs), ok);
+		d[a] = P::add(P::add(P::mul(cc, da), twoCsO), P::mul(ss, db));
+		d[b] = P::add(P::sub(P::mul(ss, da), twoCsO), P::mul(cc, db));
+		o[k] = P::add(P::mul(P::sub(cc, ss), ok), P::mul(cs, P::sub(db, da)));
+		o[b] = P::add(P::mul(c, ob), P::mul(s, oa));
+		o[a] = P::sub(P::mul(c, oa), P::mul(s, ob));
+		multiplyAxisRotation<k,P>(q, ch, sh);
+	}
+
+	//! Swaps the eigenvalues of the axes a and b other than k and rotates q by pi/2 about axis k where d[a] < d[b]
+	template<int k>
+	static void swapIfLess(PacketType* d, PacketType* q)
+	{
+		const int a = (k + 1) % 3, b = (k + 2) % 3;
+		const PacketType h = P::set1(T(0.70710678118654752440));
+		const PacketType da = d[a], db = d[b];
+		const PacketType w = q[0], va = q[1 + a], vb = q[1 + b], vk = q[1 + k];
+		d[a] = P::selectLess(da, db, db, da);
+		d[b] = P::selectLess(da, db, da, db);
+		q[0] = P::selectLess(da, db, P::mul(h, P::sub(w, vk)), w);
+		q[1 + a] = P::selectLess(da, db, P::mul(h, P::add(va, vb)), va);
+		q[1 + b] = P::selectLess(da, db, P::mul(h, P::sub(vb, va)), vb);
+		q[1 + k] = P::selectLess(da, db, P::mul(h, P::add(vk, w)), vk);
+	}
+};
+
+//! Batched eigen decomposition of symmetric 3x3 matrices with SIMD packets (see JacobiEigen3)
+template<typename T, typename Isa>
+struct PacketSymmetricEigenKernel : JacobiEigen3<T,simd::Packet<T,Isa>> {};
+
+/**
+ * @brief Singular value decomposition of 3x3 matrices without branches
+ *
+ * Decomposes P::size matrices A = U*diag(sigma)*V^T at once with the
+ * algorithm of McAdams et al. (see JacobiEigen3): V are the eigenvectors of
+ * A^T*A computed by JacobiEigen3, so the columns of B = A*V are orthogonal
+ * and sorted by decreasing norm. As the sweeps converge relative to the
+ * largest eigenvalue, the columns of B belonging to small singular values
+ * are orthogonalized by one more sweep of rotations computed from the
+ * columns of B (one-sided Jacobi), which are also accumulated in V. This
+ * sweep reduces the error of rank deficient matrices from the square root
+ * of the rounding error to the rounding error. The QR decomposition B = U*R by three
+ * Givens rotations, which are accumulated in a quaternion, yields U and the
+ * diagonal of R (whose off-diagonal entries vanish up to rounding) as the
+ * singular values. U and V are rotations, so sigma[2] is negative if A is a
+ * reflection (det(A) < 0). The Givens rotations take the half angle of
+ * McAdams et al. that avoids cancellation, selected lanewise by the sign of
+ * the pivot.
+ */
+template<typename T, typename P>
+struct JacobiSvd3
+{
+	typedef typename P::type PacketType;
+
+	/**
+	 * @brief Decompose the matrices
+	 *
+	 * a are the nine entries of the column-major matrices. Stores the
+	 * rotations U and V as quaternions (q0, q1, q2, q3) in u and v and the
+	 * singular values in sigma.
+	 */
+	static void decompose(const PacketType* a, PacketType* u, PacketType* sigma, PacketType* v)
+	{
+		// A^T*A with the off-diagonal entries (s12, s20, s01)
+		PacketType d[3] = { dot(a, 0, 0), dot(a, 1, 1), dot(a, 2, 2) };
+		PacketType o[3] = { dot(a, 1, 2), dot(a, 2, 0), dot(a, 0, 1) };
+		JacobiEigen3<T,P>::decompose(d, o, v);
+
+		PacketType rv[9];
+		rotationMatrix(v, rv);
+		PacketType b[9];
+		for(int j = 0; j < 3; j++) {
+			for(int i = 0; i < 3; i++) {
+				b[i + 3*j] = P::add(P::add(P::mul(a[i], rv[3*j]), P::mul(a[i + 3], rv[1 + 3*j])), P::mul(a[i + 6], rv[2 + 3*j]));
+			}
+		}
+
+		// One-sided Jacobi sweep on the columns of B, whose dot products don't carry the
+		// rounding error of A^T*A relative to its largest eigenvalue
+		orthogonalize<2>(b, v);
+		orthogonalize<0>(b, v);
+		orthogonalize<1>(b, v);
+
+		u[0] = P::set1(T(1));
+		u[1] = P::zero();
+		u[2] = P::zero();
+		u[3] = P::zero();
+		givens<2,0,1>(b, u);
+		givens<1,0,2>(b, u);
+		givens<0,1,2>(b, u);
+		sigma[0] = b[0];
+		sigma[1] = b[4];
+		sigma[2] = b[8];
+	}
+
+	/**
+	 * @brief Polar decomposition of the matrices
+	 *
+	 * Computes A = R*S with the rotation R = U*V^T, stored as quaternion in r,
+	 * and the symmetric S = V*diag(sigma)*V^T, stored as its entries
+	 * (s00, s11, s22, s01, s02, s12) in s.
+	 */
+	static void polar(const PacketType* a, PacketType* r, PacketType* s)
+	{
+		PacketType u[4], sigma[3], v[4];
+		decompose(a, u, sigma, v);
+
+		// u*conj(v)
+		r[0] = P::add(P::add(P::mul(u[0], v[0]), P::mul(u[1], v[1])), P::add(P::mul(u[2], v[2]), P::mul(u[3], v[3])));
+		for(int k = 1; k < 4; k++) {
+			const int i = 1 + k % 3, j = 1 + (k + 1) % 3;
+			r[k] = P::sub(P::sub(P::mul(u[k], v[0]), P::mul(u[0], v[k])), P::sub(P::mul(u[i], v[j]), P::mul(u[j], v[i])));
+		}
+
+		PacketType rv[9];
+		rotationMatrix(v, rv);
+		const int rows[6] = { 0, 1, 2, 0, 0, 1 }, columns[6] = { 0, 1, 2, 1, 2, 2 };
+		for(int e = 0; e < 6; e++) {
+			const int i = rows[e], j = columns[e];
+			s[e] = P::add(P::add(P::mul(P::mul(rv[i], rv[j]), sigma[0]), P::mul(P::mul(rv[i + 3], rv[j + 3]), sigma[1])),
+				P::mul(P::mul(rv[i + 6], rv[j + 6]), sigma[2]));
+		}
+	}
+
+	//! Decomposes count matrices in structure-of-arrays layout (see Svd3Function)
+	static void run(const T* const* matrices, T* const* u, T* const* sigma, T* const* v, size_t count)
+	{
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			PacketType a[9];
+			for(int k = 0; k < 9; k++) a[k] = P::load(matrices[k] + i);
+			PacketType pu[4], ps[3], pv[4];
+			decompose(a, pu, ps, pv);
+			for(int k = 0; k < 4; k++) P::store(u[k] + i, pu[k]);
+			for(int k = 0; k < 3; k++) P::store(sigma[k] + i, ps[k]);
+			for(int k = 0; k < 4; k++) P::store(v[k] + i, pv[k]);
+		}
+
+		if(P::size > 1 && i < count) {
+			const T* matricesRest[9];
+			for(int k = 0; k < 9; k++) matricesRest[k] = matrices[k] + i;
+			T* uRest[4] = { u[0] + i, u[1] + i, u[2] + i, u[3] + i };
+			T* sigmaRest[3] = { sigma[0] + i, sigma[1] + i, sigma[2] + i };
+			T* vRest[4] = { v[0] + i, v[1] + i, v[2] + i, v[3] + i };
+			JacobiSvd3<T,simd::ScalarPacket<T>>::run(matricesRest, uRest, sigmaRest, vRest, count - i);
+		}
+	}
+
+	//! Computes the polar decompositions of count matrices in structure-of-arrays layout (see Polar3Function)
+	static void runPolar(const T* const* matrices, T* const* rotations, T* const* stretches, size_t count)
+	{
+		const size_t packed = count - count % P::size;
+		size_t i = 0;
+		for(; i < packed; i += P::size) {
+			PacketType a[9];
+			for(int k = 0; k < 9; k++) a[k] = P::load(matrices[k] + i);
+			PacketType r[4], s[6];
+			polar(a, r, s);
+			for(int k = 0; k < 4; k++) P::store(rotations[k] + i, r[k]);
+			for(int k = 0; k < 6; k++) P::store(stretches[k] + i, s[k]);
+		}
+
+		if(P::size > 1 && i < count) {
+			const T* matricesRest[9];
+			for(int k = 0; k < 9; k++) matricesRest[k] = matrices[k] + i;
+			T* rotationsRest[4] = { rotations[0] + i, rotations[1] + i, rotations[2] + i, rotations[3] + i };
+			T* stretchesRest[6];
+			for(int k = 0; k < 6; k++) stretchesRest[k] = stretches[k] + i;
+			JacobiSvd3<T,simd::ScalarPacket<T>>::runPolar(matricesRest, rotationsRest, stretchesRest, count - i);
+		}
+	}
+
+private:
+	//! Dot product of the columns i and j of the column-major matrices a
+	static PacketType dot(const PacketType* a, int i, int j)
+	{
+		return P::add(P::add(P::mul(a[3*i], a[3*j]), P::mul(a[3*i + 1], a[3*j + 1])), P::mul(a[3*i + 2], a[3*j + 2]));
+	}
+
+	//! Rotates the columns a and b other than k of the column-major b to (approximately) orthogonal columns and multiplies v with the rotation
+	template<int k>
+	static void orthogonalize(PacketType* b, PacketType* v)
+	{
+		const int ca = (k + 1) % 3, cb = (k + 2) % 3;
+		PacketType c, s, ch, sh;
+		JacobiEigen3<T,P>::rotation(dot(b, ca, ca), dot(b, cb, cb), dot(b, ca, cb), c, s, ch, sh);
+		for(int i = 0; i < 3; i++) {
+			const PacketType ba = b[i + 3*ca], bb = b[i + 3*cb];
+			b[i + 3*ca] = P::add(P::mul(c, ba), P::mul(s, bb));
+			b[i + 3*cb] = P::sub(P::mul(c, bb), P::mul(s, ba));
+		}
+		multiplyAxisRotation<k,P>(v, ch, sh);
+	}
+
+	//! Stores the column-major rotation matrices of the normalized quaternions q in m
+	static void rotationMatrix(const PacketType* q, PacketType* m)
+	{
+		const PacketType one = P::set1(T(1));
+		const PacketType two = P::set1(T(2));
+		const PacketType w = q[0], x = q[1], y = q[2], z = q[3];
+		const PacketType xx = P::mul(x, x), yy = P::mul(y, y), zz = P::mul(z, z);
+		const PacketType xy = P::mul(x, y), xz = P::mul(x, z), yz = P::mul(y, z);
+		const PacketType wx = P::mul(w, x), wy = P::mul(w, y), wz = P::mul(w, z);
+		m[0] = P::sub(one, P::mul(two, P::add(yy, zz)));
+		m[1] = P::mul(two, P::add(xy, wz));
+		m[2] = P::mul(two, P::sub(xz, wy));
+		m[3] = P::mul(two, P::sub(xy, wz));
+		m[4] = P::sub(one, P::mul(two, P::add(xx, zz)));
+		m[5] = P::mul(two, P::add(yz, wx));
+		m[6] = P::mul(two, P::add(xz, wy));
+		m[7] = P::mul(two, P::sub(yz, wx));
+		m[8] = P::sub(one, P::mul(two, P::add(xx, yy)));
+	}
+
+	/**
+	 * @brief Annihilates the entry (row, pivot) of the column-major b by the rotation about the axis k
+	 *
+	 * Overwrites the rows of b in the plane of the rotation G with the rows of
+	 * G^T*b and multiplies u from the right with G.
+	 */
+	template<int k, int pivot, int row>
+	static void givens(PacketType* b, PacketType* u)
+	{
+		const int ra = (k + 1) % 3, rb = (k + 2) % 3;
+		const PacketType zero = P::zero();
+		const PacketType one = P::set1(T(1));
+		const PacketType two = P::set1(T(2));
+		const PacketType epsilon = P::set1(std::sqrt(std::numeric_limits<T>::min()));
+
+		// Rotation by theta = atan2(a2, a1) onto the positive pivot
+		const PacketType a1 = b[pivot + 3*pivot];
+		const PacketType a2 = (row == rb) ? b[row + 3*pivot] : P::sub(zero, b[row + 3*pivot]);
+		const PacketType rho = P::sqrt(P::add(P::mul(a1, a1), P::mul(a2, a2)));
+		const PacketType absA1 = P::selectLess(a1, zero, P::sub(zero, a1), a1);
+		const PacketType sum = P::add(absA1, P::selectLess(rho, epsilon, epsilon, rho));
+
+		// Half angle, for negative pivots tan(theta/2) = (rho - a1)/a2 avoids the cancellation
+		const PacketType ch = P::selectLess(a1, zero, a2, sum);
+		const PacketType sh = P::selectLess(a1, zero, sum, a2);
+		const PacketType chch = P::mul(ch, ch), shsh = P::mul(sh, sh);
+		const PacketType inverse = P::div(one, P::add(chch, shsh));
+		const PacketType c = P::mul(P::sub(chch, shsh), inverse);
+		const PacketType s = P::mul(P::mul(two, P::mul(ch, sh)), inverse);
+		for(int j = 0; j < 3; j++) {
+			const PacketType ba = b[ra + 3*j], bb = b[rb + 3*j];
+			b[ra + 3*j] = P::add(P::mul(c, ba), P::mul(s, bb));
+			b[rb + 3*j] = P::sub(P::mul(c, bb), P::mul(s, ba));
+		}
+
+		const PacketType omega = P::sqrt(inverse);
+		multiplyAxisRotation<k,P>(u, P::mul(omega, ch), P::mul(omega, sh));
+	}
+};
+
+//! Batched singular value and polar decomposition of 3x3 matrices with SIMD packets (see JacobiSvd3)
+template<typename T, typename Isa>
+struct PacketSvdKernel : JacobiSvd3<T,simd::Packet<T,Isa>> {};
+}
+}
+}
+
+#undef LIN_ALGEBRA_PACKET_KERNELS_NAMESPACE
@@ -0,0 +1,255 @@
+/*
+	linear_algebra_containers/qr_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "cpu_dispatch.h"
+#include "gemm.h"
+#include "triangular_kernels.h"
+
+// Smallest number of columns of the matrices factorized by the blocked QR kernel
+#ifndef LIN_ALGEBRA_BLOCKED_QR_MIN
+	#define LIN_ALGEBRA_BLOCKED_QR_MIN 64
+#endif
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * @brief Generate a Householder reflection
+ *
+ * Computes the reflection H = I - tau*v*v^T with v(0) = 1 that maps the
+ * column x of length m onto a multiple beta of the first unit vector. x(0) is
+ * overwritten with beta and the entries below with v(1), ..., v(m - 1).
+ * beta has the opposite sign of x(0), so there is no cancellation. Returns
+ * tau, which is zero (H = I) if the entries below x(0) are zero.
+ */
+template<typename T>
+inline T householderReflection(size_t m, T* x)
+{
+	using std::sqrt;
+	const T squaredNorm = (m > 1) ? DynamicElementwise<T>::dot(x + 1, x + 1, m - 1) : T(0);
+	if(squaredNorm == T(0)) return T(0);
+
+	const T alpha = x[0];
+	const T norm = sqrt(alpha*alpha + squaredNorm);
+	const T beta = (alpha < T(0)) ? norm : -norm;
+	const T reciprocal = T(1)/(alpha - beta);
+	for(size_t i = 1; i < m; i++) x[i] *= reciprocal;
+	x[0] = beta;
+	return (beta - alpha)/beta;
+}
+
+//! Applies H = I - tau*v*v^T (v stored below v(0) = 1 as by householderReflection) to the p columns of the [m x p] matrix c
+template<typename T>
+inline void householderApply(size_t m, size_t p, const T* v, T tau, T* c, size_t ldc)
+{
+	if(tau == T(0)) return;
+	for(size_t j = 0; j < p; j++) {
+		T* cj = c + j*ldc;
+		const T w = tau*(cj[0] + DynamicElementwise<T>::dot(v + 1, cj + 1, m - 1));
+		cj[0] -= w;
+		for(size_t i = 1; i < m; i++) cj[i] -= v[i]*w;
+	}
+}
+
+/**
+ * @brief Householder QR decomposition of a panel
+ *
+ * Factorizes the column-major [m x n] matrix a (m >= n) into a = Q*R with
+ * Q = H(0)*H(1)*...*H(n - 1). R is stored on and above the diagonal, the
+ * vector v of H(k) = I - tau[k]*v*v^T below the diagonal of column k (its
+ * leading one is not stored). Every reflection is applied to the remaining
+ * columns one column at a time (unit stride).
+ */
+template<typename T>
+inline void qrPanel(size_t m, size_t n, T* a, size_t lda, T* tau)
+{
+	for(size_t k = 0; k < n; k++) {
+		T* ak = a + k + k*lda;
+		tau[k] = householderReflection(m - k, ak);
+		householderApply(m - k, n - k - 1, ak, tau[k], ak + lda, lda);
+	}
+}
+
+/**
+ * @brief Triangular factor of the compact WY representation
+ *
+ * Computes the upper triangular [nb x nb] matrix t with
+ * H(0)*H(1)*...*H(nb - 1) = I - V*t*V^T, where the columns of the unit lower
+ * trapezoidal [m x nb] matrix V are the vectors of the reflections stored
+ * below the diagonal of v (see qrPanel).
+ */
+template<typename T>
+inline void qrTriangularFactor(size_t m, size_t nb, const T* v, size_t ldv, const T* tau, T* t, size_t ldt)
+{
+	for(size_t i = 0; i < nb; i++) {
+		T* ti = t + i*ldt;
+		const T* vi = v + i*ldv;
+		// ti = -tau[i]*V^T*v(i) for the columns left of column i
+		for(size_t j = 0; j < i; j++) {
+			const T* vj = v + j*ldv;
+			ti[j] = -tau[i]*(vj[i] + DynamicElementwise<T>::dot(vj + i + 1, vi + i + 1, m - i - 1));
+		}
+		// ti = t*ti with the already computed upper triangle left of column i
+		for(size_t j = 0; j < i; j++) {
+			T sum(0);
+			for(size_t l = j; l < i; l++) sum += t[j + l*ldt]*ti[l];
+			ti[j] = sum;
+		}
+		ti[i] = tau[i];
+	}
+}
+
+/**
+ * @brief Apply a transposed block reflection
+ *
+ * Overwrites the column-major [m x p] matrix c with (I - V*t*V^T)^T*c for the
+ * unit lower trapezoidal [m x nb] matrix V stored below the diagonal of v and
+ * the upper triangular t (see qrTriangularFactor). The products with the
+ * rectangular part of V below its triangle are computed by the cache blocked
+ * gemm kernel, so the update of c mostly runs at matrix product speed.
+ */
+template<typename T>
+inline void qrApplyBlockTransposed(size_t m, size_t nb, size_t p, const T* v, size_t ldv, const T* t, size_t ldt, T* c, size_t ldc)
+{
+	if(p == 0) return;
+	thread_local std::vector<T> scratch;
+	if(scratch.size() < nb*p) scratch.resize(nb*p);
+	T* w = scratch.data();
+
+	// w = V^T*c
+	if(m > nb) {
+		gemm(nb, m - nb, p, v + nb, ldv, 1, c + nb, 1, ldc, w, nb);
+	} else {
+		for(size_t i = 0; i < nb*p; i++) w[i] = T(0);
+	}
+	for(size_t col = 0; col < p; col++) {
+		const T* cc = c + col*ldc;
+		T* wc = w + col*nb;
+		for(size_t j = 0; j < nb; j++) {
+			const T* vj = v + j*ldv;
+			T sum = cc[j];
+			for(size_t r = j + 1; r < nb; r++) sum += vj[r]*cc[r];
+			wc[j] += sum;
+		}
+	}
+
+	// w = t^T*w from the bottom to the top
+	for(size_t col = 0; col < p; col++) {
+		T* wc = w + col*nb;
+		for(size_t i = nb; i-- > 0;) {
+			const T* ti = t + i*ldt;
+			T sum(0);
+			for(size_t l = 0; l <= i; l++) sum += ti[l]*wc[l];
+			wc[i] = sum;
+		}
+	}
+
+	// c -= V*w
+	subtractProduct(m - nb, nb, p, v + nb, 1, ldv, w, 1, nb, c + nb, ldc);
+	for(size_t col = 0; col < p; col++) {
+		T* cc = c + col*ldc;
+		const T* wc = w + col*nb;
+		for(size_t r = 0; r < nb; r++) {
+			T sum = wc[r];
+			for(size_t j = 0; j < r; j++) sum += v[r + j*ldv]*wc[j];
+			cc[r] -= sum;
+		}
+	}
+}
+
+/**
+ * @brief Blocked Householder QR decomposition
+ *
+ * Computes the same factorization as qrPanel in panels of
+ * triangular_block_size columns. The reflections of a factorized panel are
+ * accumulated into their compact WY representation I - V*T*V^T and applied
+ * to the columns right of the panel at once (see qrApplyBlockTransposed).
+ */
+template<typename T>
+inline void qrBlocked(size_t m, size_t n, T* a, size_t lda, T* tau)
+{
+	T t[triangular_block_size*triangular_block_size];
+	for(size_t j = 0; j < n; j += triangular_block_size) {
+		const size_t nb = (n - j < triangular_block_size) ? n - j : triangular_block_size;
+		const size_t next = j + nb;
+		T* panel = a + j + j*lda;
+		qrPanel(m - j, nb, panel, lda, tau + j);
+		if(next < n) {
+			qrTriangularFactor(m - j, nb, panel, lda, tau + j, t, nb);
+			qrApplyBlockTransposed(m - j, nb, n - next, panel, lda, t, nb, a + j + next*lda, lda);
+		}
+	}
+}
+
+/**
+ * @brief Householder QR decomposition of a matrix with compile-time dimensions
+ *
+ * Factorizes the column-major [m x n] matrix a (m >= n) in place (see
+ * qrPanel). Matrices with at least LIN_ALGEBRA_BLOCKED_QR_MIN columns are
+ * factorized by qrBlocked.
+ */
+template<typename T, size_t m, size_t n>
+inline void qrFactorize(T* a, size_t lda, T* tau)
+{
+	if(n >= LIN_ALGEBRA_BLOCKED_QR_MIN) {
+		qrBlocked(m, n, a, lda, tau);
+	} else {
+		qrPanel(m, n, a, lda, tau);
+	}
+}
+
+/**
+ * @brief Multiply by the transposed of Q
+ *
+ * Overwrites the column-major [m x p] matrix b with Q^T*b, where Q is stored
+ * as the n reflections of the factorized matrix a (see qrPanel). At least
+ * triangular_block_size columns are updated with the compact WY
+ * representation of blocks of reflections, fewer columns (e.g. the
+ * right-hand side of a least squares problem) one reflection at a time.
+ */
+template<typename T>
+inline void qrApplyQTransposed(size_t m, size_t n, const T* a, size_t lda, const T* tau, size_t p, T* b, size_t ldb)
+{
+	if(n >= LIN_ALGEBRA_BLOCKED_QR_MIN && p >= triangular_block_size) {
+		T t[triangular_block_size*triangular_block_size];
+		for(size_t j = 0; j < n; j += triangular_block_size) {
+			const size_t nb = (n - j < triangular_block_size) ? n - j : triangular_block_size;
+			qrTriangularFactor(m - j, nb, a + j + j*lda, lda, tau + j, t, nb);
+			qrApplyBlockTransposed(m - j, nb, p, a + j + j*lda, lda, t, nb, b + j, ldb);
+		}
+		return;
+	}
+	for(size_t k = 0; k < n; k++) householderApply(m - k, p, a + k + k*lda, tau[k], b + k, ldb);
+}
+
+}
+}
@@ -26,8 +26,10 @@
 #pragma once
 
 #include "vector3.h"
+#include "rotation_kernels.h"
 
 #include <cmath>
+#include <type_traits>
 #include <utility>
 #include <tuple>
 
@@ -40,7 +42,8 @@ namespace lin_algebra {
  * a standard quaternion: q = q0 + q1*i + q2*j + q3*k as a combination
  * of a scalar (q0) and a vector (q1, q2, q3).
  * Currently there are some operations implemented to help with rotation
- * operations of 3 dimensional vectors.
+ * operations of 3 dimensional vectors. Construction, the accessors, the
+ * conjugate and the arithmetic operators can be used in constant expressions.
  *
  * @tparam T Type used for the entries of the quaternion.
  */
@@ -51,20 +54,42 @@ protected:
 	T _q0;				// Scalar component of the quaternion
 	Vector3<T> _qv;		// Vector component of the quaternion (q1, q2, q3)
 
+private:
+	//! Evaluates to true if Q is an rvalue quaternion whose components are reused by the operators (see detail::ReusesOperandStorage)
+	template<typename Q>
+	struct IsReusableOperand
+		: std::integral_constant<bool, std::is_same<Q,Quaternion>::value && detail::ReusesOperandStorage<T>::value> {};
+
+	// Arithmetic operations of the quaternion functions tallied by the FLOP accounting (see beginOperation)
+	static constexpr size_t product_flops = 29;
+	static constexpr size_t componentwise_flops = 4;	// Sums, differences and scalings
+	static constexpr size_t conjugate_flops = 3;
+	static constexpr size_t norm_squared_flops = 8;
+	static constexpr size_t norm_flops = norm_squared_flops + 1;
+	static constexpr size_t normalize_flops = norm_flops + 5;
+	static constexpr size_t inverse_flops = norm_squared_flops + 1 + conjugate_flops + componentwise_flops;
+	static constexpr size_t log_flops = norm_flops + 7 + 7;	// Norm of the vector, angle and scaling
+	static constexpr size_t exp_flops = 7 + 7 + componentwise_flops;
+	static constexpr size_t pow_flops = componentwise_flops + log_flops + exp_flops;
+	static constexpr size_t composition_flops = componentwise_flops + exp_flops + product_flops;
+	static constexpr size_t difference_flops = inverse_flops + product_flops + log_flops + componentwise_flops;
+	static constexpr size_t slerp_flops = difference_flops + componentwise_flops + composition_flops;
+	static constexpr size_t transform_flops = 47;
+	static constexpr size_t to_matrix_flops = 30;
+
 public:
 	// TODO: Different rotation orders
-	// TODO: toMatrix
 	// TODO: toEulerAngles
 
 	//! Constructs an identity quaternion q(1 + 0*i + 0*j + 0*k).
-	Quaternion() : _q0(1), _qv(0,0,0) {}
+	constexpr Quaternion() : _q0(1), _qv(0,0,0) {}
 
 	//! Constructs a quaternion q(q0 + q1*i + q2*j + q3*k).
-	Quaternion(T q0, T q1, T q2, T q3)
+	constexpr Quaternion(T q0, T q1, T q2, T q3)
 		: _q0(q0), _qv(q1,q2,q3) {}
 
 	//! Constructs a quaternion q(q0, qv).
-	Quaternion(T q0, Vector3<T> qv)
+	constexpr Quaternion(T q0, Vector3<T> qv)
 		: _q0(q0), _qv(qv) {}
 
 	//! Creates a quaternion for the rotation about the specified angle around the specified axis. Axis must be normalized.
@@ -85,6 +110,60 @@ public:
 		return Quaternion(cos(angle/2), axisX*s, axisY*s, axisZ*s);
 	}
 
+	/**
+	 * @brief Create a quaternion from a rotation matrix
+	 *
+	 * Uses Shepperd's method, which computes the largest component of the
+	 * quaternion first and is therefore accurate for all rotation angles.
+	 * The largest component of the returned quaternion is positive.
+	 * @param mat An orthonormal matrix with determinant 1.
+	 * @return The normalized quaternion of the rotation.
+	 */
+	static Quaternion fromMatrix(const Matrix<T,3,3>& mat)
+	{
+		T q[4];
+		detail::matrixToQuaternion(mat.data(), q, 1);
+		return Quaternion(q[0], q[1], q[2], q[3]);
+	}
+
+	/**
+	 * @brief Create quaternions from an array of rotation matrices
+	 *
+	 * Converts count matrices from in to quaternions (see fromMatrix) and
+	 * stores them in out. For float and double the conversion uses the SIMD
+	 * kernel selected for the CPU.
+	 */
+	static void fromMatrices(const Matrix<T,3,3>* in, Quaternion* out, size_t count)
+	{
+		static_assert(sizeof(Matrix<T,3,3>) == 9*sizeof(T), "Matrices must be stored without padding");
+		static_assert(sizeof(Quaternion) == 4*sizeof(T), "Quaternions must be stored without padding");
+		detail::RotationKernelSelect<T>::fromMatrix()(reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+	}
+
+	//! Returns the rotation matrix of the quaternion. Quaternion must be normalized!
+	Matrix<T,3,3> toMatrix() const
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionToMatrix, to_matrix_flops, 13);
+		const T q[4] = { _q0, _qv.x(), _qv.y(), _qv.z() };
+		Matrix<T,3,3> mat;
+		detail::quaternionToMatrix(q, mat.data(), 1);
+		return mat;
+	}
+
+	/**
+	 * @brief Convert an array of quaternions to rotation matrices
+	 *
+	 * Converts count quaternions from in to rotation matrices (see toMatrix)
+	 * and stores them in out. For float and double the conversion uses the
+	 * SIMD kernel selected for the CPU. Quaternions must be normalized!
+	 */
+	static void toMatrices(const Quaternion* in, Matrix<T,3,3>* out, size_t count)
+	{
+		static_assert(sizeof(Matrix<T,3,3>) == 9*sizeof(T), "Matrices must be stored without padding");
+		static_assert(sizeof(Quaternion) == 4*sizeof(T), "Quaternions must be stored without padding");
+		detail::RotationKernelSelect<T>::toMatrix()(reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+	}
+
 	//! Calculates the normalized axis/angle representation of the quaternion. Quaternion must be normalized.
 	void getAxisAndAngle(Vector3<T>* axisOut, T* angleOut)
 	{
@@ -110,26 +189,32 @@ public:
 	}
 
 	//! Returns the conjugate of this quaternion.
-	Quaternion conjugated() const
+	constexpr Quaternion conjugated() const
 	{
-		return Quaternion(_q0,-_qv);
+		detail::beginOperation<T>(AccountedOperation::QuaternionArithmetic, conjugate_flops, 8);
+		const Quaternion result(_q0,-_qv);
+		detail::endOperation<T>();
+		return result;
 	}
 
 	//! Sets this quaternion to its conjugate.
 	void conjugate()
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, conjugate_flops, 6);
 		_qv = -_qv;
 	}
 
 	//! Returns the dot product of two quaternions.
 	static T dotProduct(const Quaternion& p, const Quaternion& q)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::InnerProduct, norm_squared_flops, 8);
 		return p._q0*q._q0 + Vector3<T>::dotProduct(p._qv,q._qv);
 	}
 
 	//! Returns the squared 2 norm of the quaternion.
 	T normSquared() const
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, norm_squared_flops, 4);
 		// return q0*q0 + qv.normSquared();
 		return dotProduct(*this,*this);
 	}
@@ -138,12 +223,14 @@ public:
 	T norm() const
 	{
 		using std::sqrt;
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, norm_flops, 4);
 		return sqrt(this->normSquared());
 	}
 
 	//! Returns the normalized unit from this quaterion.
 	Quaternion normalized() const
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionNormalize, normalize_flops, 8);
 		T l = norm();
 		return Quaternion(_q0/l, (1/l)*_qv);
 	}
@@ -151,7 +238,8 @@ public:
 	//! Normalizes this quaternion.
 	void normalize()
 	{
-		double l = norm();
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionNormalize, normalize_flops, 8);
+		T l = norm();
 		_q0 = _q0/l;
 		_qv *= (1/l);
 	}
@@ -159,50 +247,53 @@ public:
 	//! Returns the inverse of the quaternion
 	Quaternion inverse() const
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionInverse, inverse_flops, 8);
 		return (1/this->normSquared())*(this->conjugated());
 	}
 
 	//! Inverts this quaternion
-	Quaternion invert()
+	Quaternion& invert()
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionInverse, inverse_flops, 8);
 		conjugate();
-		double l2 = normSquared();
+		T l2 = normSquared();
 		_q0 /= l2;
 		_qv *= (1/l2);
+		return *this;
 	}
 
 	//! Returns the scalar/real component of the quaternion
-	T scalar() const
+	constexpr T scalar() const
 	{
 		return _q0;
 	}
 
 	//! Returns the vector component of the quaternion
-	Vector3<T> vector() const
+	constexpr Vector3<T> vector() const
 	{
 		return _qv;
 	}
 
 	//! Returns the scalar component of the quaternion
-	T q0() const
+	constexpr T q0() const
 	{
 		return _q0;
 	}
 
 	//! Returns the i coefficient of the quaternion
-	T q1() const
+	constexpr T q1() const
 	{
 		return _qv.x();
 	}
 
 	//! Returns the j coefficient of the quaternion
-	T q2() const
+	constexpr T q2() const
 	{
 		return _qv.y();
 	}
 
 	//! Returns the k coefficient of the quaternion
-	T q3() const
+	constexpr T q3() const
 	{
 		return _qv.z();
 	}
@@ -210,12 +301,64 @@ public:
 	//! Returns the transformation of the specified vector by this quaternion. Quaternion must be normalized!
 	Vector3<T> transform(const Vector3<T>& v) const
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionTransform, transform_flops, 10);
 		return 2*_qv*(_qv.transposed()*v)-v*(_qv.normSquared())+(_q0*_q0)*v+2*_q0*(Vector3<T>::crossProduct(_qv,v));
 	}
 
+	/**
+	 * @brief Transform an array of vectors by this quaternion
+	 *
+	 * Transforms count vectors from in and stores them in out. The quaternion
+	 * is converted to a rotation matrix once, so that every vector only
+	 * requires a matrix-vector product. in and out may point to the same array.
+	 * Quaternion must be normalized!
+	 */
+	void transform(const Vector3<T>* in, Vector3<T>* out, size_t count) const
+	{
+		static_assert(sizeof(Vector3<T>) == 3*sizeof(T), "Vectors must be stored without padding");
+		transformTriplets(reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+	}
+
+	//! Returns the transformation of the columns of the specified [3 x N] matrix by this quaternion. Quaternion must be normalized!
+	template<size_t N>
+	Matrix<T,3,N> transform(const Matrix<T,3,N>& points) const
+	{
+		Matrix<T,3,N> result;
+		transformTriplets(points.data(), result.data(), N);
+		return result;
+	}
+
+	/**
+	 * @brief Transform an array of vectors by an array of quaternions
+	 *
+	 * Transforms every vector in[i] by the quaternion rotations[i] and stores
+	 * the result in out[i]. Converting every quaternion to a matrix does not
+	 * pay off for a single vector, so the vectors are rotated directly with
+	 * the SIMD kernel selected for the CPU. in and out may point to the same
+	 * array. Quaternions must be normalized!
+	 */
+	static void transform(const Quaternion* rotations, const Vector3<T>* in, Vector3<T>* out, size_t count)
+	{
+		static_assert(sizeof(Quaternion) == 4*sizeof(T), "Quaternions must be stored without padding");
+		static_assert(sizeof(Vector3<T>) == 3*sizeof(T), "Vectors must be stored without padding");
+		detail::QuaternionRotate3Select<T>::get()(reinterpret_cast<const T*>(rotations),
+			reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+	}
+
+	//! Returns the columns of the specified [3 x N] matrix transformed by the corresponding quaternions. Quaternions must be normalized!
+	template<size_t N>
+	static Matrix<T,3,N> transform(const Quaternion* rotations, const Matrix<T,3,N>& points)
+	{
+		static_assert(sizeof(Quaternion) == 4*sizeof(T), "Quaternions must be stored without padding");
+		Matrix<T,3,N> result;
+		detail::QuaternionRotate3Select<T>::get()(reinterpret_cast<const T*>(rotations), points.data(), result.data(), N);
+		return result;
+	}
+
 	//! Returns the logarithm of the quaternion
 	static Quaternion log(const Quaternion& p)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionLog, log_flops, 8);
 		using std::log;
 		using std::acos;
 
@@ -229,6 +372,7 @@ public:
 	//! Returns the exponential value of the quaternion
 	static Quaternion exp(const Quaternion& p)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionExp, exp_flops, 8);
 		using std::exp;
 		using std::cos;
 		using std::sin;
@@ -241,49 +385,196 @@ public:
 	//! Returns the quaternion to the power of t
 	static Quaternion pow(const Quaternion& p, T t)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionPow, pow_flops, 9);
 		return exp(t*log(p));
 	}
 
 	//! SO(3) group addition operator
 	static Quaternion composition(const Quaternion& p, const Quaternion& q)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionComposition, composition_flops, 12);
 		return p*exp(0.5*q);
 	}
 
 	//! SO(3) group difference operator
 	static Quaternion difference(const Quaternion& p, const Quaternion& q)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionDifference, difference_flops, 12);
 		return 2*log(q.inverse()*p);
 	}
 
 	//! Linear interpolation between two quaternions
 	static Quaternion slerp(const Quaternion& p, const Quaternion& q, T t)
 	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionSlerp, slerp_flops, 13);
 		return composition(p,t*(difference(q,p)));
 	}
 
+	//! Composes this quaternion with the specified quaternion (this = this*q)
+	Quaternion& operator*=(const Quaternion& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionProduct, product_flops, 12);
+		T q0 = _q0*q._q0 - _qv.transposed()*q._qv;
+		_qv = _q0*q._qv + q._q0*_qv + Vector3<T>::crossProduct(_qv, q._qv);
+		_q0 = std::move(q0);
+		return *this;
+	}
+
+	//! Scales this quaternion by the specified factor
+	Quaternion& operator*=(const T& n)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, componentwise_flops, 9);
+		_q0 *= n;
+		_qv *= n;
+		return *this;
+	}
+
+	//! Adds the specified quaternion componentwise
+	Quaternion& operator+=(const Quaternion& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		_q0 += q._q0;
+		_qv += q._qv;
+		return *this;
+	}
+
+	//! Subtracts the specified quaternion componentwise
+	Quaternion& operator-=(const Quaternion& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		_q0 -= q._q0;
+		_qv -= q._qv;
+		return *this;
+	}
+
 	//! Composition operator for quaternions
-	friend Quaternion operator*(const Quaternion& p, const Quaternion& q)
+	friend constexpr Quaternion operator*(const Quaternion& p, const Quaternion& q)
 	{
-		return Quaternion(p._q0*q._q0 - p._qv.transposed()*q._qv, p._q0*q._qv + q._q0*p._qv + Vector3<T>::crossProduct(p._qv, q._qv));
+		detail::beginOperation<T>(AccountedOperation::QuaternionProduct, product_flops, 12);
+		const Quaternion result(p._q0*q._q0 - p._qv.transposed()*q._qv, p._q0*q._qv + q._q0*p._qv + Vector3<T>::crossProduct(p._qv, q._qv));
+		detail::endOperation<T>();
+		return result;
 	}
 
 	//! Scales a quaternion
-	friend Quaternion operator*(const T& n, const Quaternion& p)
+	friend constexpr Quaternion operator*(const T& n, const Quaternion& p)
 	{
-		return Quaternion(n*p._q0, n*p._qv);
+		detail::beginOperation<T>(AccountedOperation::QuaternionArithmetic, componentwise_flops, 9);
+		const Quaternion result(n*p._q0, n*p._qv);
+		detail::endOperation<T>();
+		return result;
 	}
 
 	//! Componentwise sum of two quaternions
-	friend Quaternion operator+(const Quaternion& p, const Quaternion& q)
+	friend constexpr Quaternion operator+(const Quaternion& p, const Quaternion& q)
 	{
-		return Quaternion(p._q0 + q._q0, p._qv + q._qv);
+		detail::beginOperation<T>(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		const Quaternion result(p._q0 + q._q0, p._qv + q._qv);
+		detail::endOperation<T>();
+		return result;
 	}
 
 	//! Componentwise difference of two quaternions
-	friend Quaternion operator-(const Quaternion& p, const Quaternion& q)
+	friend constexpr Quaternion operator-(const Quaternion& p, const Quaternion& q)
+	{
+		detail::beginOperation<T>(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		const Quaternion result(p._q0 - q._q0, p._qv - q._qv);
+		detail::endOperation<T>();
+		return result;
+	}
+
+	/**
+	 * @brief Composition operator for an expiring right quaternion
+	 *
+	 * The operators for rvalue quaternions compute their result in the
+	 * components of the expiring operand and move it into the result
+	 * instead of constructing a new quaternion. They are only enabled if
+	 * copying T is expensive, see detail::ReusesOperandStorage.
+	 */
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator*(const Quaternion& p, Q&& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionProduct, product_flops, 12);
+		T q0 = p._q0*q._q0 - p._qv.transposed()*q._qv;
+		q._qv = p._q0*q._qv + q._q0*p._qv + Vector3<T>::crossProduct(p._qv, q._qv);
+		q._q0 = std::move(q0);
+		return std::move(q);
+	}
+
+	//! Composition operator for an expiring left quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator*(Q&& p, const Quaternion& q)
+	{
+		p *= q;
+		return std::move(p);
+	}
+
+	//! Composition operator for two expiring quaternions
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator*(Q&& p, Q&& q)
+	{
+		p *= q;
+		return std::move(p);
+	}
+
+	//! Scales an expiring quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator*(const T& n, Q&& p)
 	{
-		return Quaternion(p._q0 - q.q0, p._qv - q.qv);
+		p *= n;
+		return std::move(p);
+	}
+
+	//! Componentwise sum with an expiring left quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator+(Q&& p, const Quaternion& q)
+	{
+		p += q;
+		return std::move(p);
+	}
+
+	//! Componentwise sum with an expiring right quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator+(const Quaternion& p, Q&& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		q._q0 = p._q0 + q._q0;
+		q._qv = p._qv + q._qv;
+		return std::move(q);
+	}
+
+	//! Componentwise sum of two expiring quaternions
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator+(Q&& p, Q&& q)
+	{
+		p += q;
+		return std::move(p);
+	}
+
+	//! Componentwise difference with an expiring left quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator-(Q&& p, const Quaternion& q)
+	{
+		p -= q;
+		return std::move(p);
+	}
+
+	//! Componentwise difference with an expiring right quaternion
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator-(const Quaternion& p, Q&& q)
+	{
+		const detail::OperationScope<T> scope(AccountedOperation::QuaternionArithmetic, componentwise_flops, 12);
+		q._q0 = p._q0 - q._q0;
+		q._qv = p._qv - q._qv;
+		return std::move(q);
+	}
+
+	//! Componentwise difference of two expiring quaternions
+	template<typename Q, typename = typename std::enable_if<IsReusableOperand<Q>::value>::type>
+	friend Quaternion operator-(Q&& p, Q&& q)
+	{
+		p -= q;
+		return std::move(p);
 	}
 
 	//! Returns whether two quaternions have the same components
@@ -297,6 +588,14 @@ public:
 	{
 		return !(lhs == rhs);
 	}
+
+private:
+	//! Transforms count vectors stored as consecutive (x,y,z) triplets using the rotation matrix of this quaternion
+	void transformTriplets(const T* in, T* out, size_t count) const
+	{
+		const Matrix<T,3,3> rotation = toMatrix();
+		detail::Transform3Select<T>::get()(rotation.data(), in, out, count);
+	}
 };
 
 //! Prints the quaternion to the specified stream
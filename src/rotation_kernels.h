@@ -0,0 +1,162 @@
+/*
+	linear_algebra_containers/rotation_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace lin_algebra {
+namespace detail {
+
+//! Signature of the batched quaternion to rotation matrix conversion kernels
+template<typename T>
+using QuaternionToMatrixFunction = void (*)(const T* quats, T* mats, size_t count);
+
+//! Signature of the batched rotation matrix to quaternion conversion kernels
+template<typename T>
+using MatrixToQuaternionFunction = void (*)(const T* mats, T* quats, size_t count);
+
+/**
+ * @brief Convert an array of quaternions to rotation matrices
+ *
+ * Converts count normalized quaternions that are stored as (q0,q1,q2,q3)
+ * quadruples to column-major 3x3 rotation matrices stored one after another.
+ */
+template<typename T>
+inline void quaternionToMatrix(const T* quats, T* mats, size_t count)
+{
+	for(size_t i = 0; i < count; i++) {
+		const T w = quats[4*i], x = quats[4*i + 1], y = quats[4*i + 2], z = quats[4*i + 3];
+		const T xx = x*x, yy = y*y, zz = z*z;
+		const T xy = x*y, xz = x*z, yz = y*z;
+		const T wx = w*x, wy = w*y, wz = w*z;
+
+		T* m = mats + 9*i;
+		m[0] = T(1) - T(2)*(yy + zz);
+		m[1] = T(2)*(xy + wz);
+		m[2] = T(2)*(xz - wy);
+		m[3] = T(2)*(xy - wz);
+		m[4] = T(1) - T(2)*(xx + zz);
+		m[5] = T(2)*(yz + wx);
+		m[6] = T(2)*(xz + wy);
+		m[7] = T(2)*(yz - wx);
+		m[8] = T(1) - T(2)*(xx + yy);
+	}
+}
+
+/**
+ * Pivot of Shepperd's method for the conversion of a rotation matrix
+ *
+ * Shepperd's method computes the largest component of the quaternion from
+ * the diagonal of the matrix (the argument of the square root is at least 1
+ * in that case) and the remaining components from sums and differences of
+ * the off-diagonal entries divided by it. This avoids the cancellation of
+ * the naive conversion for rotations by angles close to pi.
+ */
+template<typename T>
+struct ShepperdPivot
+{
+	//! Index of the largest quaternion component (0 for q0, 1 for q1, ...)
+	int component;
+	//! Four times the square of the largest component
+	T radicand;
+
+	//! Selects the pivot of the column-major rotation matrix m
+	explicit ShepperdPivot(const T* m)
+	{
+		const T trace = m[0] + m[4] + m[8];
+		component = 0;
+		T largest = trace;
+		for(int k = 0; k < 3; k++) {
+			if(m[4*k] > largest) {
+				component = k + 1;
+				largest = m[4*k];
+			}
+		}
+		radicand = (component == 0) ? T(1) + trace : T(1) + T(2)*largest - trace;
+	}
+};
+
+/**
+ * @brief Assemble a quaternion from the results of Shepperd's method
+ *
+ * r is the square root of the radicand of the pivot, f = 1/(2*r) and m the
+ * column-major rotation matrix. Writes the quaternion to q as (q0,q1,q2,q3).
+ */
+template<typename T>
+inline void shepperdAssemble(int component, T r, T f, const T* m, T* q)
+{
+	const T half = T(0.5)*r;
+	switch(component) {
+	case 0:
+		q[0] = half;
+		q[1] = (m[5] - m[7])*f;
+		q[2] = (m[6] - m[2])*f;
+		q[3] = (m[1] - m[3])*f;
+		break;
+	case 1:
+		q[0] = (m[5] - m[7])*f;
+		q[1] = half;
+		q[2] = (m[3] + m[1])*f;
+		q[3] = (m[6] + m[2])*f;
+		break;
+	case 2:
+		q[0] = (m[6] - m[2])*f;
+		q[1] = (m[3] + m[1])*f;
+		q[2] = half;
+		q[3] = (m[7] + m[5])*f;
+		break;
+	default:
+		q[0] = (m[1] - m[3])*f;
+		q[1] = (m[6] + m[2])*f;
+		q[2] = (m[7] + m[5])*f;
+		q[3] = half;
+		break;
+	}
+}
+
+/**
+ * @brief Convert an array of rotation matrices to quaternions
+ *
+ * Converts count column-major 3x3 rotation matrices stored one after another
+ * to normalized quaternions stored as (q0,q1,q2,q3) quadruples using
+ * Shepperd's method (see ShepperdPivot). The largest component of every
+ * quaternion is positive.
+ */
+template<typename T>
+inline void matrixToQuaternion(const T* mats, T* quats, size_t count)
+{
+	using std::sqrt;
+	for(size_t i = 0; i < count; i++) {
+		const T* m = mats + 9*i;
+		const ShepperdPivot<T> pivot(m);
+		const T r = sqrt(pivot.radicand);
+		shepperdAssemble(pivot.component, r, T(0.5)/r, m, quats + 4*i);
+	}
+}
+
+}
+}
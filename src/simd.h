@@ -0,0 +1,366 @@
+/*
+	linear_algebra_containers/simd header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Instruction sets enabled at compile time. Define LIN_ALGEBRA_NO_SIMD to
+// use the scalar kernels only.
+#if !defined(LIN_ALGEBRA_NO_SIMD)
+	#if defined(__AVX512F__)
+		#define LIN_ALGEBRA_SIMD_AVX512
+	#endif
+	#if defined(__AVX2__) && defined(__FMA__)
+		#define LIN_ALGEBRA_SIMD_AVX2
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define LIN_ALGEBRA_SIMD_SSE2
+	#endif
+#endif
+
+// Runtime dispatch compiles kernels for instruction sets that are not enabled
+// at compile time and selects them at startup (see cpu_dispatch.h). It is
+// available on x86-64 with GCC, Clang and MSVC. Define
+// LIN_ALGEBRA_NO_RUNTIME_DISPATCH to use the compile-time selection only.
+#if !defined(LIN_ALGEBRA_NO_SIMD) && !defined(LIN_ALGEBRA_NO_RUNTIME_DISPATCH) \
+	&& (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+	#define LIN_ALGEBRA_RUNTIME_DISPATCH
+#endif
+
+#if defined(LIN_ALGEBRA_SIMD_SSE2) || defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+#include <immintrin.h>
+#endif
+
+// Function attributes for code using instruction sets that are not enabled
+// at compile time. MSVC allows all intrinsics without additional flags.
+#if defined(__GNUC__) && !defined(LIN_ALGEBRA_SIMD_AVX2)
+	#define LIN_ALGEBRA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+	#define LIN_ALGEBRA_TARGET_AVX2
+#endif
+#if defined(__GNUC__) && !defined(LIN_ALGEBRA_SIMD_AVX512)
+	#define LIN_ALGEBRA_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+	#define LIN_ALGEBRA_TARGET_AVX512
+#endif
+
+namespace lin_algebra {
+namespace simd {
+
+//! Instruction set tag for plain scalar code
+struct Scalar {};
+//! Instruction set tag for 128 bit SSE2 registers
+struct Sse2 {};
+//! Instruction set tag for 256 bit AVX2 registers (with FMA)
+struct Avx2 {};
+//! Instruction set tag for 512 bit AVX-512 registers
+struct Avx512 {};
+
+//! Evaluates to true if the instruction set is enabled at compile time
+template<typename Isa>
+struct IsaEnabled : std::false_type {};
+
+template<>
+struct IsaEnabled<Scalar> : std::true_type {};
+#if defined(LIN_ALGEBRA_SIMD_SSE2)
+template<>
+struct IsaEnabled<Sse2> : std::true_type {};
+#endif
+#if defined(LIN_ALGEBRA_SIMD_AVX2)
+template<>
+struct IsaEnabled<Avx2> : std::true_type {};
+#endif
+#if defined(LIN_ALGEBRA_SIMD_AVX512)
+template<>
+struct IsaEnabled<Avx512> : std::true_type {};
+#endif
+
+/**
+ * Packet of SIMD register operations
+ *
+ * Specializations exist for float and double and every instruction set that
+ * is enabled at compile time or available for runtime dispatch. A packet
+ * provides loads and stores from unaligned memory, broadcasting of a scalar,
+ * elementwise arithmetic (including division and square root), a comparison
+ * for equality of all lanes, a lanewise selection (selectLess returns x where
+ * a < b and y elsewhere) and a horizontal sum of the lanes. Packets of
+ * instruction sets that are only available for runtime dispatch may only be
+ * used from functions compiled with the matching target options (see
+ * cpu_dispatch.h).
+ */
+template<typename T, typename Isa>
+struct Packet
+{
+	static constexpr bool supported = false;
+	static constexpr size_t size = 1;
+};
+
+#if defined(LIN_ALGEBRA_SIMD_SSE2) || defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<>
+struct Packet<float,Sse2>
+{
+	typedef __m128 type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 4;
+
+	static type load(const float* p) { return _mm_loadu_ps(p); }
+	static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+	static type set1(float v) { return _mm_set1_ps(v); }
+	static type add(type a, type b) { return _mm_add_ps(a, b); }
+	static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+	static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+	static bool equal(type a, type b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xF; }
+	static type zero() { return _mm_setzero_ps(); }
+	static type fmadd(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static type div(type a, type b) { return _mm_div_ps(a, b); }
+	static type sqrt(type v) { return _mm_sqrt_ps(v); }
+	static type selectLess(type a, type b, type x, type y)
+	{
+		const type mask = _mm_cmplt_ps(a, b);
+		return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+	}
+	static float sum(type v)
+	{
+		const type h = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+	}
+};
+
+template<>
+struct Packet<double,Sse2>
+{
+	typedef __m128d type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 2;
+
+	static type load(const double* p) { return _mm_loadu_pd(p); }
+	static void store(double* p, type v) { _mm_storeu_pd(p, v); }
+	static type set1(double v) { return _mm_set1_pd(v); }
+	static type add(type a, type b) { return _mm_add_pd(a, b); }
+	static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+	static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+	static bool equal(type a, type b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)) == 0x3; }
+	static type zero() { return _mm_setzero_pd(); }
+	static type fmadd(type a, type b, type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	static type div(type a, type b) { return _mm_div_pd(a, b); }
+	static type sqrt(type v) { return _mm_sqrt_pd(v); }
+	static type selectLess(type a, type b, type x, type y)
+	{
+		const type mask = _mm_cmplt_pd(a, b);
+		return _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, y));
+	}
+	static double sum(type v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+};
+#endif
+
+#if defined(LIN_ALGEBRA_SIMD_AVX2) || defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<>
+struct Packet<float,Avx2>
+{
+	typedef __m256 type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 8;
+
+	LIN_ALGEBRA_TARGET_AVX2 static type load(const float* p) { return _mm256_loadu_ps(p); }
+	LIN_ALGEBRA_TARGET_AVX2 static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type set1(float v) { return _mm256_set1_ps(v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type add(type a, type b) { return _mm256_add_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static bool equal(type a, type b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)) == 0xFF; }
+	LIN_ALGEBRA_TARGET_AVX2 static type zero() { return _mm256_setzero_ps(); }
+	LIN_ALGEBRA_TARGET_AVX2 static type fmadd(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+	LIN_ALGEBRA_TARGET_AVX2 static type div(type a, type b) { return _mm256_div_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type sqrt(type v) { return _mm256_sqrt_ps(v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type selectLess(type a, type b, type x, type y) { return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+	LIN_ALGEBRA_TARGET_AVX2 static float sum(type v) { return Packet<float,Sse2>::sum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1))); }
+};
+
+template<>
+struct Packet<double,Avx2>
+{
+	typedef __m256d type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 4;
+
+	LIN_ALGEBRA_TARGET_AVX2 static type load(const double* p) { return _mm256_loadu_pd(p); }
+	LIN_ALGEBRA_TARGET_AVX2 static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type set1(double v) { return _mm256_set1_pd(v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type add(type a, type b) { return _mm256_add_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static bool equal(type a, type b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)) == 0xF; }
+	LIN_ALGEBRA_TARGET_AVX2 static type zero() { return _mm256_setzero_pd(); }
+	LIN_ALGEBRA_TARGET_AVX2 static type fmadd(type a, type b, type c) { return _mm256_fmadd_pd(a, b, c); }
+	LIN_ALGEBRA_TARGET_AVX2 static type div(type a, type b) { return _mm256_div_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX2 static type sqrt(type v) { return _mm256_sqrt_pd(v); }
+	LIN_ALGEBRA_TARGET_AVX2 static type selectLess(type a, type b, type x, type y) { return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+	LIN_ALGEBRA_TARGET_AVX2 static double sum(type v) { return Packet<double,Sse2>::sum(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1))); }
+};
+#endif
+
+#if defined(LIN_ALGEBRA_SIMD_AVX512) || defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<>
+struct Packet<float,Avx512>
+{
+	typedef __m512 type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 16;
+
+	LIN_ALGEBRA_TARGET_AVX512 static type load(const float* p) { return _mm512_loadu_ps(p); }
+	LIN_ALGEBRA_TARGET_AVX512 static void store(float* p, type v) { _mm512_storeu_ps(p, v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type set1(float v) { return _mm512_set1_ps(v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type add(type a, type b) { return _mm512_add_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type sub(type a, type b) { return _mm512_sub_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static bool equal(type a, type b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ) == 0xFFFF; }
+	LIN_ALGEBRA_TARGET_AVX512 static type zero() { return _mm512_setzero_ps(); }
+	LIN_ALGEBRA_TARGET_AVX512 static type fmadd(type a, type b, type c) { return _mm512_fmadd_ps(a, b, c); }
+	LIN_ALGEBRA_TARGET_AVX512 static type div(type a, type b) { return _mm512_div_ps(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type sqrt(type v) { return _mm512_maskz_sqrt_ps(0xFFFF, v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type selectLess(type a, type b, type x, type y) { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x); }
+	LIN_ALGEBRA_TARGET_AVX512 static float sum(type v)
+	{
+		// Sum of the two halves via memory (the 512 bit extract intrinsics of GCC 12 warn about uninitialized values)
+		float lanes[16];
+		_mm512_storeu_ps(lanes, v);
+		return Packet<float,Avx2>::sum(_mm256_add_ps(_mm256_loadu_ps(lanes), _mm256_loadu_ps(lanes + 8)));
+	}
+};
+
+template<>
+struct Packet<double,Avx512>
+{
+	typedef __m512d type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 8;
+
+	LIN_ALGEBRA_TARGET_AVX512 static type load(const double* p) { return _mm512_loadu_pd(p); }
+	LIN_ALGEBRA_TARGET_AVX512 static void store(double* p, type v) { _mm512_storeu_pd(p, v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type set1(double v) { return _mm512_set1_pd(v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type add(type a, type b) { return _mm512_add_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type sub(type a, type b) { return _mm512_sub_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static bool equal(type a, type b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ) == 0xFF; }
+	LIN_ALGEBRA_TARGET_AVX512 static type zero() { return _mm512_setzero_pd(); }
+	LIN_ALGEBRA_TARGET_AVX512 static type fmadd(type a, type b, type c) { return _mm512_fmadd_pd(a, b, c); }
+	LIN_ALGEBRA_TARGET_AVX512 static type div(type a, type b) { return _mm512_div_pd(a, b); }
+	LIN_ALGEBRA_TARGET_AVX512 static type sqrt(type v) { return _mm512_maskz_sqrt_pd(0xFF, v); }
+	LIN_ALGEBRA_TARGET_AVX512 static type selectLess(type a, type b, type x, type y) { return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), y, x); }
+	LIN_ALGEBRA_TARGET_AVX512 static double sum(type v)
+	{
+		double lanes[8];
+		_mm512_storeu_pd(lanes, v);
+		return Packet<double,Avx2>::sum(_mm256_add_pd(_mm256_loadu_pd(lanes), _mm256_loadu_pd(lanes + 4)));
+	}
+};
+#endif
+
+/**
+ * Packet interface for single values
+ *
+ * Provides the operations of Packet for one value of any type T, so that
+ * kernels written for packets can also be instantiated for a single value
+ * (e.g. for the remainder of a batch or for types without packets).
+ */
+template<typename T>
+struct ScalarPacket
+{
+	typedef T type;
+	static constexpr bool supported = true;
+	static constexpr size_t size = 1;
+
+	static type load(const T* p) { return *p; }
+	static void store(T* p, const type& v) { *p = v; }
+	static type set1(const T& v) { return v; }
+	static type add(const type& a, const type& b) { return a + b; }
+	static type sub(const type& a, const type& b) { return a - b; }
+	static type mul(const type& a, const type& b) { return a*b; }
+	static bool equal(const type& a, const type& b) { return a == b; }
+	static type zero() { return T(0); }
+	static type fmadd(const type& a, const type& b, const type& c) { return a*b + c; }
+	static type div(const type& a, const type& b) { return a/b; }
+	static type sqrt(const type& v)
+	{
+		using std::sqrt;
+		return sqrt(v);
+	}
+	static type selectLess(const type& a, const type& b, const type& x, const type& y) { return (a < b) ? x : y; }
+	static T sum(const type& v) { return v; }
+};
+
+//! Evaluates to true if the instruction set is enabled and has packets for T that are not wider than size
+template<typename T, typename Isa, size_t size>
+struct IsaFits : std::integral_constant<bool, IsaEnabled<Isa>::value && Packet<T,Isa>::supported && (Packet<T,Isa>::size <= size)> {};
+
+/**
+ * @brief Select the instruction set for an array of the specified size
+ *
+ * Returns the widest instruction set enabled at compile time whose packets
+ * of T fit into size entries. Falls back to Scalar for types without packets
+ * and for arrays that are smaller than the narrowest packet.
+ */
+template<typename T, size_t size>
+struct SelectIsa
+{
+	typedef typename std::conditional<IsaFits<T,Avx512,size>::value, Avx512,
+		typename std::conditional<IsaFits<T,Avx2,size>::value, Avx2,
+		typename std::conditional<IsaFits<T,Sse2,size>::value, Sse2,
+		Scalar>::type>::type>::type type;
+};
+
+}
+
+namespace detail {
+
+//! Elementwise kernels on contiguous arrays without SIMD (fallback for all types without packets)
+template<typename T>
+struct ScalarElementwiseKernel
+{
+	static void add(T* dst, const T* src, size_t n) { for(size_t i = 0; i < n; i++) dst[i] += src[i]; }
+	static void subtract(T* dst, const T* src, size_t n) { for(size_t i = 0; i < n; i++) dst[i] -= src[i]; }
+	template<typename S>
+	static void scale(T* dst, const S& factor, size_t n) { for(size_t i = 0; i < n; i++) dst[i] *= factor; }
+	static void fill(T* dst, const T& value, size_t n) { for(size_t i = 0; i < n; i++) dst[i] = value; }
+	static T dot(const T* lhs, const T* rhs, size_t n)
+	{
+		T result(0);
+		for(size_t i = 0; i < n; i++) result += lhs[i]*rhs[i];
+		return result;
+	}
+	static bool equal(const T* lhs, const T* rhs, size_t n)
+	{
+		for(size_t i = 0; i < n; i++) {
+			if(!(lhs[i] == rhs[i])) return false;
+		}
+		return true;
+	}
+};
+
+}
+}
@@ -0,0 +1,162 @@
+/*
+	linear_algebra_containers/singular_value_decomposition header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "matrix.h"
+#include "vector3.h"
+#include "quaternion.h"
+#include "cpu_dispatch.h"
+
+namespace lin_algebra {
+
+/**
+ * Singular value decomposition of a 3x3 matrix
+ *
+ * Decomposes a matrix A = U*diag(sigma)*V^T with the rotations U and V,
+ * available as quaternions or as rotation matrices. As U and V are rotations
+ * (and not only orthogonal), the last singular value is negative if A
+ * contains a reflection, i.e. det(A) < 0, which is the convention of the
+ * inversion aware elasticity models. The singular values are sorted in
+ * descending order of their absolute values.
+ *
+ * The decomposition follows McAdams et al.: V is computed by the branch-free
+ * Jacobi eigen decomposition of A^T*A (see SymmetricEigenDecomposition3), U
+ * and the singular values by a QR decomposition of A*V with Givens rotations
+ * accumulated in a quaternion (see JacobiSvd3 in packet_kernels.h). compute()
+ * decomposes arrays of matrices in structure-of-arrays layout with the same
+ * code on SIMD packets (e.g. 8 float matrices per AVX2 instruction).
+ * @tparam T Type of the entries.
+ */
+template<typename T>
+class SingularValueDecomposition3
+{
+private:
+	typedef detail::native::JacobiSvd3<T,simd::ScalarPacket<T>> Kernel;
+
+	Quaternion<T> u_;
+	Vector3<T> singularValues_;
+	Quaternion<T> v_;
+
+public:
+	//! Computes the decomposition of the specified matrix
+	explicit SingularValueDecomposition3(const Matrix<T,3,3>& mat)
+	{
+		T u[4], sigma[3], v[4];
+		Kernel::decompose(mat.data(), u, sigma, v);
+		u_ = Quaternion<T>(u[0], u[1], u[2], u[3]);
+		singularValues_ = Vector3<T>(sigma[0], sigma[1], sigma[2]);
+		v_ = Quaternion<T>(v[0], v[1], v[2], v[3]);
+	}
+
+	//! Returns the singular values, the last one is negative if the determinant of the matrix is negative
+	const Vector3<T>& singularValues() const { return singularValues_; }
+
+	//! Returns the normalized quaternion of the rotation U
+	const Quaternion<T>& rotationU() const { return u_; }
+
+	//! Returns the normalized quaternion of the rotation V
+	const Quaternion<T>& rotationV() const { return v_; }
+
+	//! Returns the rotation matrix U whose columns are the left singular vectors
+	Matrix<T,3,3> matrixU() const { return u_.toMatrix(); }
+
+	//! Returns the rotation matrix V whose columns are the right singular vectors
+	Matrix<T,3,3> matrixV() const { return v_.toMatrix(); }
+
+	/**
+	 * @brief Decompose an array of matrices in structure-of-arrays layout
+	 *
+	 * matrices are nine streams of the column-major entries a00, a10, a20,
+	 * a01, ..., a22 of count matrices. Writes U and V as quaternions to the
+	 * four streams u and v (q0, q1, q2, q3) and the singular values to the
+	 * three streams sigma. For float and double the SIMD kernel selected for
+	 * the CPU decomposes a full packet of matrices at once.
+	 */
+	static void compute(const T* const* matrices, T* const* u, T* const* sigma, T* const* v, size_t count)
+	{
+		detail::SvdKernelSelect<T>::svd()(matrices, u, sigma, v, count);
+	}
+};
+
+/**
+ * Polar decomposition of a 3x3 matrix
+ *
+ * Decomposes a matrix A = R*S into the rotation R = U*V^T and the symmetric
+ * S = V*diag(sigma)*V^T from the SingularValueDecomposition3 of A, e.g. the
+ * rotation of a deformation gradient. R is always a rotation, so S is not
+ * positive definite if det(A) < 0.
+ * @tparam T Type of the entries.
+ */
+template<typename T>
+class PolarDecomposition3
+{
+private:
+	typedef detail::native::JacobiSvd3<T,simd::ScalarPacket<T>> Kernel;
+
+	Quaternion<T> rotation_;
+	Matrix<T,3,3> stretch_;
+
+public:
+	//! Computes the decomposition of the specified matrix
+	explicit PolarDecomposition3(const Matrix<T,3,3>& mat)
+	{
+		T r[4], s[6];
+		Kernel::polar(mat.data(), r, s);
+		rotation_ = Quaternion<T>(r[0], r[1], r[2], r[3]);
+		const size_t rows[6] = { 0, 1, 2, 0, 0, 1 }, columns[6] = { 0, 1, 2, 1, 2, 2 };
+		for(size_t e = 0; e < 6; e++) {
+			stretch_(rows[e], columns[e]) = s[e];
+			stretch_(columns[e], rows[e]) = s[e];
+		}
+	}
+
+	//! Returns the normalized quaternion of the rotation R
+	const Quaternion<T>& rotation() const { return rotation_; }
+
+	//! Returns the rotation matrix R
+	Matrix<T,3,3> matrixR() const { return rotation_.toMatrix(); }
+
+	//! Returns the symmetric matrix S
+	const Matrix<T,3,3>& matrixS() const { return stretch_; }
+
+	/**
+	 * @brief Decompose an array of matrices in structure-of-arrays layout
+	 *
+	 * matrices are nine streams of the column-major entries of count matrices
+	 * (see SingularValueDecomposition3::compute()). Writes R as quaternions
+	 * to the four streams rotations (q0, q1, q2, q3) and S to the six streams
+	 * stretches (s00, s11, s22, s01, s02, s12).
+	 */
+	static void compute(const T* const* matrices, T* const* rotations, T* const* stretches, size_t count)
+	{
+		detail::SvdKernelSelect<T>::polar()(matrices, rotations, stretches, count);
+	}
+};
+
+}
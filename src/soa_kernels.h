@@ -0,0 +1,87 @@
+/*
+	linear_algebra_containers/soa_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * Kernels on arrays of 3d vectors in structure-of-arrays layout
+ *
+ * The x, y and z coordinates of n vectors are stored in three separate
+ * streams. A vector array is passed as an array of the three stream pointers,
+ * i.e. the vector i is (a[0][i], a[1][i], a[2][i]). The results are computed
+ * with the same operations in the same order as the member functions of
+ * Vector3, so that they are identical to the results of the single vector
+ * operations.
+ */
+template<typename T>
+struct ScalarSoaKernel
+{
+	//! out[i] = dot(a_i, b_i)
+	static void dot3(const T* const* a, const T* const* b, T* out, size_t n)
+	{
+		for(size_t i = 0; i < n; i++) out[i] = a[0][i]*b[0][i] + a[1][i]*b[1][i] + a[2][i]*b[2][i];
+	}
+
+	//! out_i = cross(a_i, b_i), out may be the same array as a or b
+	static void cross3(const T* const* a, const T* const* b, T* const* out, size_t n)
+	{
+		for(size_t i = 0; i < n; i++) {
+			const T x = a[1][i]*b[2][i] - a[2][i]*b[1][i];
+			const T y = a[2][i]*b[0][i] - a[0][i]*b[2][i];
+			const T z = a[0][i]*b[1][i] - a[1][i]*b[0][i];
+			out[0][i] = x;
+			out[1][i] = y;
+			out[2][i] = z;
+		}
+	}
+
+	//! out[i] = |a_i|^2
+	static void normSquared3(const T* const* a, T* out, size_t n)
+	{
+		for(size_t i = 0; i < n; i++) out[i] = a[0][i]*a[0][i] + a[1][i]*a[1][i] + a[2][i]*a[2][i];
+	}
+
+	//! out_i = a_i/|a_i|, out may be the same array as a
+	static void normalize3(const T* const* a, T* const* out, size_t n)
+	{
+		using std::sqrt;
+		for(size_t i = 0; i < n; i++) {
+			const T factor = T(1)/sqrt(a[0][i]*a[0][i] + a[1][i]*a[1][i] + a[2][i]*a[2][i]);
+			out[0][i] = a[0][i]*factor;
+			out[1][i] = a[1][i]*factor;
+			out[2][i] = a[2][i]*factor;
+		}
+	}
+};
+
+}
+}
@@ -0,0 +1,280 @@
+/*
+	linear_algebra_containers/storage header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "aligned_allocator.h"
+
+namespace lin_algebra {
+
+//! Storage policy of matrices storing their entries contiguously in column-major order with the natural alignment of T (default)
+struct DenseStorage {};
+
+/**
+ * Storage policy of aligned matrices
+ *
+ * The entries are aligned to the specified number of bytes (a power of two).
+ * If pad_columns is set, every column is padded to a multiple of
+ * alignment/sizeof(T) entries so that each column starts at an aligned
+ * address and can be processed with full width aligned SIMD loads, e.g. a
+ * Vector3<float> with 16 byte alignment occupies one 128 bit register. The
+ * values of the padding entries are unspecified, they are not part of the
+ * matrix.
+ * Note that operator new only respects alignments larger than the alignment
+ * of std::max_align_t since C++17.
+ * @tparam alignment Alignment of the entries in bytes.
+ * @tparam pad_columns Whether the columns are padded to the alignment.
+ */
+template<size_t alignment, bool pad_columns = false>
+struct AlignedStorage {};
+
+/**
+ * Storage policy of matrices storing their entries on the heap
+ *
+ * The dimensions of the matrix stay compile-time constants but the entries
+ * are allocated on the heap (contiguous, column-major and aligned to the
+ * specified number of bytes) instead of inside of the matrix object. Large
+ * matrices therefore don't overflow the stack and moving a matrix only
+ * transfers the pointer to its entries, so functions returning matrices by
+ * value don't copy the entries. A moved-from matrix has no entries anymore,
+ * it may only be assigned to or destroyed. Assignments (including the
+ * compound assignments and fill()) allocate new value-initialized entries
+ * first.
+ * @tparam alignment Alignment of the entries in bytes.
+ */
+template<size_t alignment = 64>
+struct HeapStorage {};
+
+//! Evaluates to true if the storage policy stores the entries on the heap (see HeapStorage)
+template<typename Storage>
+struct IsHeapStorage : std::false_type {};
+
+template<size_t alignment>
+struct IsHeapStorage<HeapStorage<alignment>> : std::true_type {};
+
+namespace detail {
+
+//! Tag to construct matrices without initializing the entries
+struct UninitializedTag {};
+
+//! Tag to construct the entries of a matrix from a list of values (remaining entries are value-initialized)
+struct EntryListTag {};
+
+//! Tag to construct a heap array taking ownership of an existing allocation
+struct AdoptTag {};
+
+/**
+ * Array of entries stored inside of the matrix object
+ *
+ * @tparam T Type of the entries.
+ * @tparam size Number of entries.
+ * @tparam alignment Alignment of the array in bytes.
+ */
+template<typename T, size_t size, size_t alignment>
+class InlineArray
+{
+private:
+	alignas(alignment) T values_[size];
+
+public:
+	//! Constructs the array without initializing the entries
+	explicit InlineArray(UninitializedTag) {}
+
+	//! Constructs the array with the specified leading entries, all other entries are value-initialized
+	template<typename ...Ts>
+	constexpr InlineArray(EntryListTag, Ts... values)
+		: values_{values...}
+	{
+	}
+
+	//! The entries of inline arrays always exist (see HeapArray::allocateIfEmpty)
+	constexpr void allocateIfEmpty() {}
+
+	constexpr T* data() { return values_; }
+	constexpr const T* data() const { return values_; }
+	constexpr T& operator[](size_t i) { return values_[i]; }
+	constexpr const T& operator[](size_t i) const { return values_[i]; }
+};
+
+/**
+ * Array of entries stored on the heap (see HeapStorage)
+ *
+ * Copies copy the entries, moves only transfer the ownership of the
+ * allocation.
+ * @tparam T Type of the entries.
+ * @tparam size Number of entries.
+ * @tparam alignment Alignment of the array in bytes.
+ */
+template<typename T, size_t size, size_t alignment>
+class HeapArray
+{
+private:
+	T* values_;
+
+	static T* allocate() { return static_cast<T*>(alignedAllocate(size*sizeof(T), alignment)); }
+
+	void destroy()
+	{
+		if(!values_) return;
+		for(size_t i = 0; i < size; i++) values_[i].~T();
+		alignedFree(values_);
+		values_ = nullptr;
+	}
+
+public:
+	//! Constructs the array without initializing the entries
+	explicit HeapArray(UninitializedTag)
+		: values_(allocate())
+	{
+		for(size_t i = 0; i < size; i++) new (values_ + i) T;
+	}
+
+	//! Constructs the array with the specified leading entries, all other entries are value-initialized
+	template<typename ...Ts>
+	HeapArray(EntryListTag, Ts... values)
+		: values_(allocate())
+	{
+		static_assert(sizeof...(Ts) <= size, "Too many initializers for the matrix");
+		const T list[] = {T(values)..., T()};
+		for(size_t i = 0; i < sizeof...(Ts); i++) new (values_ + i) T(list[i]);
+		for(size_t i = sizeof...(Ts); i < size; i++) new (values_ + i) T();
+	}
+
+	/**
+	 * @brief Constructs the array taking ownership of the specified entries
+	 *
+	 * The entries must have been allocated with alignedAllocate with the
+	 * alignment of the array and must contain size constructed values.
+	 */
+	HeapArray(AdoptTag, T* values)
+		: values_(values)
+	{
+	}
+
+	HeapArray(const HeapArray& other)
+		: values_(allocate())
+	{
+		for(size_t i = 0; i < size; i++) new (values_ + i) T(other.values_[i]);
+	}
+
+	HeapArray(HeapArray&& other) noexcept
+		: values_(other.values_)
+	{
+		other.values_ = nullptr;
+	}
+
+	HeapArray& operator=(const HeapArray& other)
+	{
+		if(this == &other) return *this;
+		if(!values_) {
+			HeapArray copy(other);
+			std::swap(values_, copy.values_);
+		} else {
+			for(size_t i = 0; i < size; i++) values_[i] = other.values_[i];
+		}
+		return *this;
+	}
+
+	HeapArray& operator=(HeapArray&& other) noexcept
+	{
+		std::swap(values_, other.values_);
+		return *this;
+	}
+
+	~HeapArray() { destroy(); }
+
+	//! Allocates value-initialized entries if the array has no entries (i.e. it was moved from or released)
+	void allocateIfEmpty()
+	{
+		if(values_) return;
+		HeapArray entries(EntryListTag{});
+		std::swap(values_, entries.values_);
+	}
+
+	//! Gives up the ownership of the entries and returns them, the array has no entries anymore
+	T* release()
+	{
+		T* values = values_;
+		values_ = nullptr;
+		return values;
+	}
+
+	T* data() { return values_; }
+	const T* data() const { return values_; }
+	T& operator[](size_t i) { return values_[i]; }
+	const T& operator[](size_t i) const { return values_[i]; }
+};
+
+/**
+ * Memory layout of the entries of a matrix with the specified storage policy
+ *
+ * Provides the alignment of the array of entries, the leading dimension
+ * (distance between the first entries of two consecutive columns), the
+ * number of entries of the array including the padding and the type of the
+ * array stored in the matrix.
+ */
+template<typename T, size_t rows, size_t cols, typename Storage>
+struct StorageLayout;
+
+template<typename T, size_t rows, size_t cols>
+struct StorageLayout<T,rows,cols,DenseStorage>
+{
+	static constexpr size_t alignment = alignof(T);
+	static constexpr size_t leading_dimension = rows;
+	static constexpr size_t size = rows*cols;
+	typedef InlineArray<T,size,alignment> ArrayType;
+};
+
+template<typename T, size_t rows, size_t cols, size_t alignment_param, bool pad_columns>
+struct StorageLayout<T,rows,cols,AlignedStorage<alignment_param,pad_columns>>
+{
+	static_assert((alignment_param & (alignment_param - 1)) == 0, "Alignment must be a power of two");
+
+	static constexpr size_t alignment = (alignment_param > alignof(T)) ? alignment_param : alignof(T);
+	static constexpr size_t lanes = (alignment > sizeof(T)) ? alignment/sizeof(T) : 1;
+	static constexpr size_t leading_dimension = pad_columns ? (rows + lanes - 1)/lanes*lanes : rows;
+	static constexpr size_t size = leading_dimension*cols;
+	typedef InlineArray<T,size,alignment> ArrayType;
+};
+
+template<typename T, size_t rows, size_t cols, size_t alignment_param>
+struct StorageLayout<T,rows,cols,HeapStorage<alignment_param>>
+{
+	static_assert((alignment_param & (alignment_param - 1)) == 0, "Alignment must be a power of two");
+
+	static constexpr size_t alignment = (alignment_param > alignof(T)) ? alignment_param : alignof(T);
+	static constexpr size_t leading_dimension = rows;
+	static constexpr size_t size = rows*cols;
+	typedef HeapArray<T,size,alignment> ArrayType;
+};
+
+}
+}
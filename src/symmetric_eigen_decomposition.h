@@ -0,0 +1,102 @@
+/*
+	linear_algebra_containers/symmetric_eigen_decomposition header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "matrix.h"
+#include "vector3.h"
+#include "quaternion.h"
+#include "cpu_dispatch.h"
+
+namespace lin_algebra {
+
+/**
+ * Eigen decomposition of a symmetric 3x3 matrix
+ *
+ * Computes the eigenvalues and an orthonormal basis of eigenvectors of a
+ * symmetric matrix such as an inertia or covariance tensor. The eigenvectors
+ * are returned as a rotation, i.e. S = R*diag(eigenvalues)*R^T, either as
+ * a quaternion or as a rotation matrix whose columns are the eigenvectors.
+ * The eigenvalues are sorted in descending order, so the first column of R
+ * is the principal axis of a covariance tensor.
+ *
+ * The decomposition runs a fixed number of Jacobi sweeps with approximate
+ * Givens rotations accumulated in a quaternion (see JacobiEigen3 in
+ * packet_kernels.h) and contains no branches. compute() decomposes arrays of
+ * matrices in structure-of-arrays layout with the same code on SIMD packets
+ * (e.g. 8 float matrices per AVX2 instruction) and the same operations as
+ * the decomposition of a single matrix.
+ * @tparam T Type of the entries.
+ */
+template<typename T>
+class SymmetricEigenDecomposition3
+{
+private:
+	typedef detail::native::JacobiEigen3<T,simd::ScalarPacket<T>> Kernel;
+
+	Vector3<T> eigenvalues_;
+	Quaternion<T> rotation_;
+
+public:
+	//! Computes the decomposition of the specified symmetric matrix (only its lower triangle is read)
+	explicit SymmetricEigenDecomposition3(const Matrix<T,3,3>& mat)
+	{
+		T d[3] = { mat(0,0), mat(1,1), mat(2,2) };
+		T o[3] = { mat(2,1), mat(2,0), mat(1,0) };
+		T q[4];
+		Kernel::decompose(d, o, q);
+		eigenvalues_ = Vector3<T>(d[0], d[1], d[2]);
+		rotation_ = Quaternion<T>(q[0], q[1], q[2], q[3]);
+	}
+
+	//! Returns the eigenvalues in descending order
+	const Vector3<T>& eigenvalues() const { return eigenvalues_; }
+
+	//! Returns the normalized quaternion of the rotation whose matrix has the eigenvectors as columns
+	const Quaternion<T>& rotation() const { return rotation_; }
+
+	//! Returns the rotation matrix whose columns are the eigenvectors in the order of eigenvalues()
+	Matrix<T,3,3> eigenvectors() const { return rotation_.toMatrix(); }
+
+	/**
+	 * @brief Decompose an array of symmetric matrices in structure-of-arrays layout
+	 *
+	 * tensors are six streams of the entries s00, s11, s22, s01, s02 and s12
+	 * of count matrices. Writes the eigenvalues of the matrices (in descending
+	 * order) to the three streams eigenvalues and their rotations as
+	 * quaternions to the four streams rotations (q0, q1, q2, q3). For float
+	 * and double the SIMD kernel selected for the CPU decomposes a full
+	 * packet of matrices at once.
+	 */
+	static void compute(const T* const* tensors, T* const* eigenvalues, T* const* rotations, size_t count)
+	{
+		detail::SymmetricEigenKernelSelect<T>::get()(tensors, eigenvalues, rotations, count);
+	}
+};
+
+}
@@ -0,0 +1,300 @@
+/*
+	linear_algebra_containers/thread_pool header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lin_algebra {
+
+/**
+ * Reusable pool of worker threads with work stealing
+ *
+ * parallelFor() runs a task for every index of a range on the workers and
+ * the calling thread. The range is split evenly into one queue per thread.
+ * Every thread processes the indices of its own queue from the front and
+ * steals the back half of the queue of another thread once its own queue is
+ * empty, so threads that finish early take over the work of slower threads
+ * without any central scheduling. The threads are created once and sleep
+ * while the pool is idle.
+ *
+ * Only one parallelFor() runs on a pool at a time. Calls from other threads
+ * while the pool is busy and nested calls from inside a task are executed
+ * sequentially by the calling thread. Exceptions thrown by a task are
+ * forwarded to the caller of parallelFor().
+ */
+class ThreadPool
+{
+private:
+	typedef void (*TaskFunction)(const void* context, size_t index);
+
+	//! Range of indices owned by one thread (padded so that the queues don't share cache lines)
+	struct Queue
+	{
+		std::mutex mutex;
+		size_t begin = 0;
+		size_t end = 0;
+		char padding[64];
+	};
+
+	std::vector<std::thread> workers_;
+	//! One queue per worker followed by the queue of the calling thread
+	std::unique_ptr<Queue[]> queues_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable idle_;
+	TaskFunction task_ = nullptr;
+	const void* context_ = nullptr;
+	size_t generation_ = 0;
+	size_t active_ = 0;
+	bool stop_ = false;
+	//! First exception thrown by a task of the running parallelFor()
+	std::exception_ptr error_;
+
+	//! Serializes the parallelFor() calls
+	std::mutex submit_;
+
+	//! Returns whether the current thread is executing tasks of a pool
+	static bool& insideTask()
+	{
+		thread_local bool inside = false;
+		return inside;
+	}
+
+	//! Marks the current thread as executing tasks for its lifetime
+	class TaskScope
+	{
+	public:
+		TaskScope() { insideTask() = true; }
+		~TaskScope() { insideTask() = false; }
+
+		TaskScope(const TaskScope&) = delete;
+		TaskScope& operator=(const TaskScope&) = delete;
+	};
+
+	template<typename F>
+	static void invoke(const void* context, size_t index)
+	{
+		(*static_cast<const F*>(context))(index);
+	}
+
+	void start(size_t threadCount)
+	{
+		const size_t workerCount = (threadCount > 1) ? threadCount - 1 : 0;
+		queues_.reset(new Queue[workerCount + 1]);
+		stop_ = false;
+		for(size_t i = 0; i < workerCount; i++) workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for(std::thread& worker : workers_) worker.join();
+		workers_.clear();
+	}
+
+	//! Takes the next index from the front of the queue of the specified thread
+	bool pop(size_t id, size_t& index)
+	{
+		Queue& queue = queues_[id];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.begin == queue.end) return false;
+		index = queue.begin++;
+		return true;
+	}
+
+	//! Moves the back half of the queue of another thread to the queue of the specified thread
+	bool steal(size_t id)
+	{
+		const size_t queueCount = workers_.size() + 1;
+		for(size_t i = 1; i < queueCount; i++) {
+			Queue& victim = queues_[(id + i) % queueCount];
+			size_t begin, end;
+			{
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if(victim.begin == victim.end) continue;
+				end = victim.end;
+				begin = victim.end - (victim.end - victim.begin + 1)/2;
+				victim.end = begin;
+			}
+
+			Queue& queue = queues_[id];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.begin = begin;
+			queue.end = end;
+			return true;
+		}
+		return false;
+	}
+
+	//! Stores the first exception of a task and empties all queues, so that the threads stop taking new indices
+	void cancel(std::exception_ptr error)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(!error_) error_ = error;
+		}
+		const size_t queueCount = workers_.size() + 1;
+		for(size_t i = 0; i < queueCount; i++) {
+			std::lock_guard<std::mutex> lock(queues_[i].mutex);
+			queues_[i].begin = queues_[i].end;
+		}
+	}
+
+	//! Runs tasks until the queues of all threads are empty or a task throws
+	void work(size_t id, TaskFunction task, const void* context)
+	{
+		TaskScope scope;
+		try {
+			size_t index;
+			do {
+				while(pop(id, index)) task(context, index);
+			} while(steal(id));
+		}
+		catch(...) {
+			cancel(std::current_exception());
+		}
+	}
+
+	void workerLoop(size_t id)
+	{
+		size_t generation = 0;
+		for(;;) {
+			TaskFunction task;
+			const void* context;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				wake_.wait(lock, [&]() { return stop_ || (task_ && generation_ != generation); });
+				if(stop_) return;
+				generation = generation_;
+				task = task_;
+				context = context_;
+				active_++;
+			}
+
+			work(id, task, context);
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			if(--active_ == 0) idle_.notify_all();
+		}
+	}
+
+public:
+	//! Constructs a pool running tasks on threadCount threads (threadCount-1 workers and the calling thread)
+	explicit ThreadPool(size_t threadCount)
+	{
+		start(threadCount);
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() { stop(); }
+
+	//! Returns the number of threads running tasks (including the calling thread)
+	size_t threadCount() const { return workers_.size() + 1; }
+
+	//! Changes the number of threads running tasks, waits until running tasks are finished
+	void resize(size_t threadCount)
+	{
+		std::lock_guard<std::mutex> submit(submit_);
+		stop();
+		start(threadCount);
+	}
+
+	/**
+	 * @brief Run a task for every index of a range
+	 *
+	 * Calls function(i) for every i in [0, count) on the threads of the pool
+	 * and returns when all calls are finished. The calls may run in any order
+	 * and concurrently, function must be safe to be called from several
+	 * threads at once. If a call throws, the threads stop taking new indices
+	 * and the first exception is rethrown once all running calls are
+	 * finished.
+	 */
+	template<typename F>
+	void parallelFor(size_t count, const F& function)
+	{
+		std::unique_lock<std::mutex> submit(submit_, std::defer_lock);
+		if(workers_.empty() || count < 2 || insideTask() || !submit.try_lock()) {
+			for(size_t i = 0; i < count; i++) function(i);
+			return;
+		}
+
+		const size_t queueCount = workers_.size() + 1;
+		for(size_t i = 0; i < queueCount; i++) {
+			std::lock_guard<std::mutex> lock(queues_[i].mutex);
+			queues_[i].begin = count*i/queueCount;
+			queues_[i].end = count*(i + 1)/queueCount;
+		}
+
+		const TaskFunction task = &ThreadPool::invoke<F>;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			task_ = task;
+			context_ = &function;
+			generation_++;
+		}
+		wake_.notify_all();
+
+		work(queueCount - 1, task, &function);
+
+		// Workers that didn't pick up the task yet must not start it anymore
+		std::unique_lock<std::mutex> lock(mutex_);
+		task_ = nullptr;
+		context_ = nullptr;
+		idle_.wait(lock, [&]() { return active_ == 0; });
+
+		std::exception_ptr error;
+		std::swap(error, error_);
+		if(error) std::rethrow_exception(error);
+	}
+
+	/**
+	 * @brief Returns the pool shared by the library
+	 *
+	 * The pool is created on first use with one thread per hardware thread
+	 * reported by std::thread::hardware_concurrency(). Use resize() to limit
+	 * it to the number of physical cores.
+	 */
+	static ThreadPool& instance()
+	{
+		static ThreadPool pool(std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1);
+		return pool;
+	}
+};
+
+}
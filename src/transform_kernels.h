@@ -0,0 +1,94 @@
+/*
+	linear_algebra_containers/transform_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace lin_algebra {
+namespace detail {
+
+//! Signature of the batched 3d transformation kernels
+template<typename T>
+using Transform3Function = void (*)(const T* mat, const T* in, T* out, size_t count);
+
+/**
+ * @brief Transform an array of 3d vectors
+ *
+ * Computes out_i = mat*in_i for count vectors that are stored as consecutive
+ * (x,y,z) triplets. mat is a column-major 3x3 matrix. in and out may point
+ * to the same array.
+ */
+template<typename T>
+inline void transform3(const T* mat, const T* in, T* out, size_t count)
+{
+	const T m00 = mat[0], m10 = mat[1], m20 = mat[2];
+	const T m01 = mat[3], m11 = mat[4], m21 = mat[5];
+	const T m02 = mat[6], m12 = mat[7], m22 = mat[8];
+
+	for(size_t i = 0; i < count; i++) {
+		const T x = in[3*i];
+		const T y = in[3*i + 1];
+		const T z = in[3*i + 2];
+		out[3*i] = m00*x + m01*y + m02*z;
+		out[3*i + 1] = m10*x + m11*y + m12*z;
+		out[3*i + 2] = m20*x + m21*y + m22*z;
+	}
+}
+
+//! Signature of the batched quaternion rotation kernels
+template<typename T>
+using QuaternionRotate3Function = void (*)(const T* quats, const T* in, T* out, size_t count);
+
+/**
+ * @brief Rotate an array of 3d vectors by an array of quaternions
+ *
+ * Computes out_i = q_i*in_i*conj(q_i) for count vectors that are stored as
+ * consecutive (x,y,z) triplets and count normalized quaternions that are
+ * stored as (q0,q1,q2,q3) quadruples. The rotation is evaluated as
+ * v + q0*t + qv x t with t = 2*(qv x v), which requires fewer operations than
+ * converting every quaternion to a rotation matrix. in and out may point to
+ * the same array.
+ */
+template<typename T>
+inline void quaternionRotate3(const T* quats, const T* in, T* out, size_t count)
+{
+	for(size_t i = 0; i < count; i++) {
+		const T w = quats[4*i], qx = quats[4*i + 1], qy = quats[4*i + 2], qz = quats[4*i + 3];
+		const T x = in[3*i];
+		const T y = in[3*i + 1];
+		const T z = in[3*i + 2];
+		const T tx = T(2)*(qy*z - qz*y);
+		const T ty = T(2)*(qz*x - qx*z);
+		const T tz = T(2)*(qx*y - qy*x);
+		out[3*i] = x + w*tx + (qy*tz - qz*ty);
+		out[3*i + 1] = y + w*ty + (qz*tx - qx*tz);
+		out[3*i + 2] = z + w*tz + (qx*ty - qy*tx);
+	}
+}
+
+}
+}
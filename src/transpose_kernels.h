@@ -0,0 +1,58 @@
+/*
+	linear_algebra_containers/transpose_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace lin_algebra {
+namespace detail {
+
+/**
+ * @brief Transpose a matrix
+ *
+ * Stores the transposed of the [rows x cols] matrix a (entry (i,j) at
+ * a[i*rsa + j*csa]) in the column-major matrix b with leading dimension ldb.
+ * The matrix is processed in square tiles, so that the cache lines touched by
+ * the strided accesses of a tile are reused instead of being evicted before
+ * their neighboring entries are accessed. a and b must not overlap.
+ */
+template<typename T>
+inline void transposeBlocked(size_t rows, size_t cols, const T* a, size_t rsa, size_t csa, T* b, size_t ldb)
+{
+	const size_t tile = 32;
+	for(size_t jj = 0; jj < cols; jj += tile) {
+		const size_t jEnd = (cols - jj < tile) ? cols : jj + tile;
+		for(size_t ii = 0; ii < rows; ii += tile) {
+			const size_t iEnd = (rows - ii < tile) ? rows : ii + tile;
+			for(size_t i = ii; i < iEnd; i++) {
+				for(size_t j = jj; j < jEnd; j++) b[j + i*ldb] = a[i*rsa + j*csa];
+			}
+		}
+	}
+}
+
+}
+}
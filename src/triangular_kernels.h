@@ -0,0 +1,186 @@
+/*
+	linear_algebra_containers/triangular_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "gemm.h"
+
+namespace lin_algebra {
+namespace detail {
+
+//! Number of rows of the diagonal blocks of the blocked triangular solves and factorizations
+constexpr size_t triangular_block_size = 32;
+
+/**
+ * @brief Subtract a matrix product
+ *
+ * Computes c -= a*b for a [m x n] with the entry (i,k) at a[i*rsa + k*csa],
+ * b [n x p] with the entry (k,j) at b[k*rsb + j*csb] and column-major c. The
+ * product is computed by gemm into a thread local scratch buffer, so c may
+ * be part of the same matrix as a and b as long as the blocks don't overlap.
+ */
+template<typename T>
+inline void subtractProduct(size_t m, size_t n, size_t p, const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+{
+	if(m == 0 || n == 0 || p == 0) return;
+	thread_local std::vector<T> product;
+	if(product.size() < m*p) product.resize(m*p);
+	gemm(m, n, p, a, rsa, csa, b, rsb, csb, product.data(), m);
+	for(size_t j = 0; j < p; j++) {
+		T* cj = c + j*ldc;
+		const T* pj = product.data() + j*m;
+		for(size_t i = 0; i < m; i++) cj[i] -= pj[i];
+	}
+}
+
+//! Forward substitution with the lower triangle of a single block (see solveLower)
+template<typename T>
+inline void solveLowerBlock(size_t n, size_t p, const T* l, size_t ldl, T* b, size_t ldb, bool unitDiagonal)
+{
+	for(size_t c = 0; c < p; c++) {
+		T* x = b + c*ldb;
+		for(size_t j = 0; j < n; j++) {
+			const T* lj = l + j*ldl;
+			if(!unitDiagonal) x[j] /= lj[j];
+			const T xj = x[j];
+			for(size_t i = j + 1; i < n; i++) x[i] -= lj[i]*xj;
+		}
+	}
+}
+
+//! Back substitution with the upper triangle of a single block (see solveUpper)
+template<typename T>
+inline void solveUpperBlock(size_t n, size_t p, const T* u, size_t ldu, T* b, size_t ldb, bool unitDiagonal)
+{
+	for(size_t c = 0; c < p; c++) {
+		T* x = b + c*ldb;
+		for(size_t j = n; j-- > 0;) {
+			const T* uj = u + j*ldu;
+			if(!unitDiagonal) x[j] /= uj[j];
+			const T xj = x[j];
+			for(size_t i = 0; i < j; i++) x[i] -= uj[i]*xj;
+		}
+	}
+}
+
+//! Back substitution with the transposed lower triangle of a single block (see solveLowerTransposed)
+template<typename T>
+inline void solveLowerTransposedBlock(size_t n, size_t p, const T* l, size_t ldl, T* b, size_t ldb, bool unitDiagonal)
+{
+	for(size_t c = 0; c < p; c++) {
+		T* x = b + c*ldb;
+		for(size_t i = n; i-- > 0;) {
+			const T* li = l + i*ldl;
+			T sum = x[i];
+			for(size_t k = i + 1; k < n; k++) sum -= li[k]*x[k];
+			x[i] = unitDiagonal ? sum : sum/li[i];
+		}
+	}
+}
+
+/**
+ * @brief Forward substitution
+ *
+ * Overwrites the p columns of the column-major [n x p] matrix b with the
+ * solution x of l*x = b, where l is the lower triangle of the column-major
+ * [n x n] matrix l. With unitDiagonal the diagonal of l is assumed to be one
+ * and not read. The entries above the diagonal are never read. The columns
+ * of l are processed one after another (unit stride). Larger systems are
+ * solved in blocks of triangular_block_size rows, the rows below a block
+ * are updated by subtractProduct.
+ */
+template<typename T>
+inline void solveLower(size_t n, size_t p, const T* l, size_t ldl, T* b, size_t ldb, bool unitDiagonal)
+{
+	if(n <= triangular_block_size) {
+		solveLowerBlock(n, p, l, ldl, b, ldb, unitDiagonal);
+		return;
+	}
+	for(size_t jb = 0; jb < n; jb += triangular_block_size) {
+		const size_t nb = (n - jb < triangular_block_size) ? n - jb : triangular_block_size;
+		const size_t next = jb + nb;
+		solveLowerBlock(nb, p, l + jb + jb*ldl, ldl, b + jb, ldb, unitDiagonal);
+		subtractProduct(n - next, nb, p, l + next + jb*ldl, 1, ldl, b + jb, 1, ldb, b + next, ldb);
+	}
+}
+
+/**
+ * @brief Back substitution
+ *
+ * Overwrites the p columns of the column-major [n x p] matrix b with the
+ * solution x of u*x = b, where u is the upper triangle of the column-major
+ * [n x n] matrix u. With unitDiagonal the diagonal of u is assumed to be one.
+ * The entries below the diagonal are never read. Larger systems are solved
+ * in blocks of triangular_block_size rows from the bottom to the top, the
+ * rows above a block are updated by subtractProduct.
+ */
+template<typename T>
+inline void solveUpper(size_t n, size_t p, const T* u, size_t ldu, T* b, size_t ldb, bool unitDiagonal)
+{
+	if(n <= triangular_block_size) {
+		solveUpperBlock(n, p, u, ldu, b, ldb, unitDiagonal);
+		return;
+	}
+	for(size_t end = n; end > 0;) {
+		const size_t nb = (end < triangular_block_size) ? end : triangular_block_size;
+		const size_t jb = end - nb;
+		solveUpperBlock(nb, p, u + jb + jb*ldu, ldu, b + jb, ldb, unitDiagonal);
+		subtractProduct(jb, nb, p, u + jb*ldu, 1, ldu, b + jb, 1, ldb, b, ldb);
+		end = jb;
+	}
+}
+
+/**
+ * @brief Back substitution with the transposed of a lower triangle
+ *
+ * Overwrites the columns of b with the solution x of u*x = b, where u is the
+ * transposed of the lower triangle of the column-major [n x n] matrix l,
+ * i.e. u(i,j) = l(j,i). Reads the columns of l with unit stride. Larger
+ * systems are solved in blocks of triangular_block_size rows from the bottom
+ * to the top, the rows above a block are updated by subtractProduct with the
+ * transposed block of l.
+ */
+template<typename T>
+inline void solveLowerTransposed(size_t n, size_t p, const T* l, size_t ldl, T* b, size_t ldb, bool unitDiagonal)
+{
+	if(n <= triangular_block_size) {
+		solveLowerTransposedBlock(n, p, l, ldl, b, ldb, unitDiagonal);
+		return;
+	}
+	for(size_t end = n; end > 0;) {
+		const size_t nb = (end < triangular_block_size) ? end : triangular_block_size;
+		const size_t jb = end - nb;
+		solveLowerTransposedBlock(nb, p, l + jb + jb*ldl, ldl, b + jb, ldb, unitDiagonal);
+		// Rows jb, ..., end - 1 of l (columns of the transposed) above the block
+		subtractProduct(jb, nb, p, l + jb, ldl, 1, b + jb, 1, ldb, b, ldb);
+		end = jb;
+	}
+}
+
+}
+}
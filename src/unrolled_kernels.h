@@ -0,0 +1,175 @@
+/*
+	linear_algebra_containers/unrolled_kernels header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Maximum number of entries of the operands of the elementwise operations
+// and of the matrix product that are expanded into straight-line code at
+// compile time (16 = 4x4 matrix). Larger operands use the loop kernels.
+#ifndef LIN_ALGEBRA_UNROLL_MAX_SIZE
+	#define LIN_ALGEBRA_UNROLL_MAX_SIZE 16
+#endif
+
+namespace lin_algebra {
+namespace detail {
+
+//! Evaluates to true if arrays of the specified size are processed by the unrolled kernels
+template<size_t size>
+struct IsUnrolledSize : std::integral_constant<bool, (size <= LIN_ALGEBRA_UNROLL_MAX_SIZE)> {};
+
+//! Evaluates to true if the product of [m x n] and [n x p] matrices is computed by UnrolledProduct
+template<size_t m, size_t n, size_t p>
+struct IsUnrolledProduct
+	: std::integral_constant<bool, IsUnrolledSize<m*n>::value && IsUnrolledSize<n*p>::value && IsUnrolledSize<m*p>::value> {};
+
+/**
+ * @brief Elementwise kernels for arrays with a small compile-time size
+ *
+ * Provides the interface of ScalarElementwiseKernel for arrays of exactly
+ * size entries (the runtime size argument is ignored). The operations are
+ * expanded from an index sequence into one statement per entry, so they
+ * don't depend on the unrolling heuristics of the compiler, and they are
+ * constexpr. The entries are processed in the same order as by the scalar
+ * kernel, i.e. the results are the same.
+ */
+template<typename T, size_t size, typename Indices = std::make_index_sequence<size>>
+struct UnrolledElementwiseKernel;
+
+template<typename T, size_t size, size_t ...I>
+struct UnrolledElementwiseKernel<T,size,std::index_sequence<I...>>
+{
+	// The braced initializer lists below evaluate their elements in order (pack expansion without fold expressions)
+
+	//! dst[i] += src[i]
+	static constexpr void add(T* dst, const T* src, size_t = size)
+	{
+		const int expand[] = { 0, ((void)(dst[I] += src[I]), 0)... };
+		(void)expand;
+	}
+
+	//! dst[i] -= src[i]
+	static constexpr void subtract(T* dst, const T* src, size_t = size)
+	{
+		const int expand[] = { 0, ((void)(dst[I] -= src[I]), 0)... };
+		(void)expand;
+	}
+
+	//! dst[i] *= factor
+	template<typename S>
+	static constexpr void scale(T* dst, const S& factor, size_t = size)
+	{
+		const int expand[] = { 0, ((void)(dst[I] *= factor), 0)... };
+		(void)expand;
+	}
+
+	//! dst[i] = value
+	static constexpr void fill(T* dst, const T& value, size_t = size)
+	{
+		const int expand[] = { 0, ((void)(dst[I] = value), 0)... };
+		(void)expand;
+	}
+
+	//! Returns the sum of lhs[i]*rhs[i] (summed up sequentially)
+	static constexpr T dot(const T* lhs, const T* rhs, size_t = size)
+	{
+		T result(0);
+		const int expand[] = { 0, ((void)(result += lhs[I]*rhs[I]), 0)... };
+		(void)expand;
+		return result;
+	}
+
+	//! Returns true if all entries compare equal
+	static constexpr bool equal(const T* lhs, const T* rhs, size_t = size)
+	{
+		bool result = true;
+		const int expand[] = { 0, ((void)(result = result && (lhs[I] == rhs[I])), 0)... };
+		(void)expand;
+		return result;
+	}
+};
+
+/**
+ * @brief Inner product of a row vector and a column vector expression
+ *
+ * Returns the sum of lhs(0,k)*rhs(k,0) for k = 0, ..., n-1, expanded from an
+ * index sequence and summed up in order.
+ */
+template<typename T, size_t n, typename Indices = std::make_index_sequence<n>>
+struct UnrolledInnerProduct;
+
+template<typename T, size_t n, size_t ...K>
+struct UnrolledInnerProduct<T,n,std::index_sequence<K...>>
+{
+	template<typename L, typename R>
+	static constexpr T run(const L& lhs, const R& rhs)
+	{
+		T sum(0);
+		const int expand[] = { 0, ((void)(sum += lhs(0,K)*rhs(K,0)), 0)... };
+		(void)expand;
+		return sum;
+	}
+};
+
+/**
+ * @brief Matrix product of small operands with compile-time dimensions
+ *
+ * Computes c = a*b for a [m x n] with the entry (i,k) at a[i*rsa + k*csa],
+ * b [n x p] with the entry (k,j) at b[k*rsb + j*csb] and column-major c
+ * with leading dimension ldc. Every entry of c is expanded into the sum over
+ * k in the order of gemmSmall. c must not alias a or b.
+ */
+template<typename T, size_t m, size_t n, size_t p>
+struct UnrolledProduct
+{
+	static constexpr void run(const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc)
+	{
+		run(a, rsa, csa, b, rsb, csb, c, ldc, std::make_index_sequence<m*p>());
+	}
+
+private:
+	template<size_t ...E>
+	static constexpr void run(const T* a, size_t rsa, size_t csa, const T* b, size_t rsb, size_t csb, T* c, size_t ldc, std::index_sequence<E...>)
+	{
+		const int expand[] = { 0, ((void)(c[E % m + (E / m)*ldc] = entry(a + (E % m)*rsa, csa, b + (E / m)*csb, rsb, std::make_index_sequence<n>())), 0)... };
+		(void)expand;
+	}
+
+	//! Returns the inner product of the row of a and the column of b starting at the specified pointers
+	template<size_t ...K>
+	static constexpr T entry(const T* row, size_t csa, const T* column, size_t rsb, std::index_sequence<K...>)
+	{
+		T sum(0);
+		const int expand[] = { 0, ((void)(sum += row[K*csa]*column[K*rsb]), 0)... };
+		(void)expand;
+		return sum;
+	}
+};
+
+}
+}
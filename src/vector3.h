@@ -27,8 +27,10 @@
 
 #include "matrixbase.h"
 #include "matrix.h"
+#include "matrix_expression.h"
 
 #include <cmath>
+#include <type_traits>
 
 namespace lin_algebra {
 
@@ -40,17 +42,18 @@ namespace lin_algebra {
  * dimensions.
  * @tparam T Type used for the entries of the vector. Must support basic
  * aritmethic operations.
+ * @tparam Storage Storage policy of the entries, see storage.h.
  */
-template<typename T>
-class Matrix<T,3,1> : public MatrixBase<T,3,1>
+template<typename T, typename Storage>
+class Matrix<T,3,1,Storage> : public MatrixBase<T,3,1,Storage>
 {
 private:
-	typedef MatrixBase<T,3,1> MatrixBaseType;
+	typedef MatrixBase<T,3,1,Storage> MatrixBaseType;
 
 public:
 	//! Type of this vector
-	typedef Matrix<T,3,1> VectorType;
-	//! Type of the transposed vector
+	typedef Matrix<T,3,1,Storage> VectorType;
+	//! Type of the evaluated transposed vector
 	typedef Matrix<T,1,3> TransposedVectorType;
 
 	/**
@@ -62,16 +65,32 @@ public:
 	Matrix() = default;
 
 	//! Construct a vector with the specified values
-	Matrix(T x, T y, T z)
+	constexpr Matrix(T x, T y, T z)
 		: MatrixBaseType(x,y,z)
 	{
 	}
 
+	//! Constructs a vector by evaluating the specified matrix expression
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,3,1>::value>::type>
+	constexpr Matrix(const E& expr)
+		: MatrixBaseType(detail::UninitializedTag())
+	{
+		this->assign(expr);
+	}
+
+	//! Assigns the result of the specified matrix expression to this vector
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,3,1>::value>::type>
+	VectorType& operator=(const E& expr)
+	{
+		this->assignAliased(expr);
+		return *this;
+	}
+
 	/**
 	 * @brief Return x value
 	 * @return The x value of the vector
 	 */
-	T x() const
+	constexpr T x() const
 	{
 		return this->entries_[0];
 	}
@@ -80,7 +99,7 @@ public:
 	 * @brief Return y value
 	 * @return The y value of the vector
 	 */
-	T y() const
+	constexpr T y() const
 	{
 		return this->entries_[1];
 	}
@@ -89,7 +108,7 @@ public:
 	 * @brief Return z value
 	 * @return The z value of the vector
 	 */
-	T z() const
+	constexpr T z() const
 	{
 		return this->entries_[2];
 	}
@@ -137,17 +156,19 @@ public:
 	/**
 	 * @brief Calculate cross product
 	 *
-	 * Calculates the cross product of the two specified vectors.
+	 * Calculates the cross product of the two specified vectors. Can be used
+	 * in constant expressions.
 	 * @param lhs The left vector.
 	 * @param rhs The right vector.
 	 * @return The vector normal to the two specified vectors.
 	 */
-	static VectorType crossProduct(const VectorType& lhs, const VectorType& rhs)
+	static constexpr VectorType crossProduct(const VectorType& lhs, const VectorType& rhs)
 	{
-		VectorType result;
-		result[0] = lhs[1]*rhs[2] - lhs[2]*rhs[1];
-		result[1] = lhs[2]*rhs[0] - lhs[0]*rhs[2];
-		result[2] = lhs[0]*rhs[1] - lhs[1]*rhs[0];
+		detail::beginOperation<T>(AccountedOperation::CrossProduct, 9, 9);
+		const VectorType result(lhs[1]*rhs[2] - lhs[2]*rhs[1],
+			lhs[2]*rhs[0] - lhs[0]*rhs[2],
+			lhs[0]*rhs[1] - lhs[1]*rhs[0]);
+		detail::endOperation<T>();
 		return result;
 	}
 
@@ -162,9 +183,8 @@ public:
 	 */
 	static T dotProduct(const VectorType& v1, const VectorType& v2)
 	{
-		return (  v1[0]*v2[0]
-				+ v1[1]*v2[1]
-				+ v1[2]*v2[2] );
+		const detail::OperationScope<T> scope(AccountedOperation::InnerProduct, 2*3, 2*3);
+		return detail::DotKernel<T,3>::dot(v1.data(), v2.data(), 3);
 	}
 
 	/**
@@ -176,9 +196,8 @@ public:
 	 */
 	T normSquared() const
 	{
-		return (  this->entries_[0]*this->entries_[0]
-				+ this->entries_[1]*this->entries_[1]
-				+ this->entries_[2]*this->entries_[2] );
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, 2*3, 3);
+		return detail::DotKernel<T,3>::dot(this->entries_.data(), this->entries_.data(), 3);
 	}
 
 	/**
@@ -190,6 +209,7 @@ public:
 	T norm() const
 	{
 		using std::sqrt;
+		const detail::OperationScope<T> scope(AccountedOperation::Norm, 2*3 + 1, 3);
 		return sqrt(this->normSquared());
 	}
 
@@ -201,6 +221,8 @@ public:
 	 */
 	VectorType& normalize()
 	{
+		// The norm, its reciprocal and the scaling
+		const detail::OperationScope<T> scope(AccountedOperation::Normalize, 3*3 + 2, 2*3);
 		(*this) *= (1/norm());
 		return *this;
 	}
@@ -218,80 +240,57 @@ public:
 		return copy;
 	}
 
-	//! Returns the transposed vector
-	TransposedVectorType transposed() const
+	//! Returns the transposed vector (an expression referring to this vector, see TransposeExpression)
+	constexpr TransposeExpression<VectorType> transposed() const
 	{
-		return TransposedVectorType{this->entries_};
+		return TransposeExpression<VectorType>(*this);
 	}
 
 	//! Adds the right vector to the left.
-	VectorType operator+=(const VectorType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,3,1>::value>::type>
+	VectorType& operator+=(const E& rhs)
 	{
-		this->entries_[0] += rhs.entries_[0];
-		this->entries_[1] += rhs.entries_[1];
-		this->entries_[2] += rhs.entries_[2];
+		this->addAssign(rhs);
 		return *this;
 	}
 
 	//! Substracts the right vector from the left.
-	VectorType operator-=(const VectorType& rhs)
+	template<typename E, typename = typename std::enable_if<IsMatrixExpressionOf<E,T,3,1>::value>::type>
+	VectorType& operator-=(const E& rhs)
 	{
-		this->entries_[0] -= rhs.entries_[0];
-		this->entries_[1] -= rhs.entries_[1];
-		this->entries_[2] -= rhs.entries_[2];
+		this->subtractAssign(rhs);
 		return *this;
 	}
 
 	//! Scales the vector by the specified factor.
-	VectorType operator*=(double factor)
+	template<typename S, typename = typename std::enable_if<IsScalarFor<S,VectorType>::value>::type>
+	VectorType& operator*=(const S& factor)
 	{
-		this->entries_[0] *= factor;
-		this->entries_[1] *= factor;
-		this->entries_[2] *= factor;
+		this->scaleAssign(factor);
 		return *this;
 	}
-
-	//! Returns the vector scaled by the specified factor.
-	friend VectorType operator*(const VectorType& mat, double factor)
-	{
-		VectorType result(mat);
-		result *= factor;
-		return result;
-	}
-
-	//! Returns the vector scaled by the specified factor.
-	friend VectorType operator*(double factor, const VectorType& mat)
-	{
-		VectorType result(mat);
-		result *= factor;
-		return result;
-	}
-
-	//! Returns the sum of the two matrices. Vector dimensions must agree.
-	friend VectorType operator+(const VectorType& lhs, const VectorType& rhs)
-	{
-		VectorType result(lhs);
-		result += rhs;
-		return result;
-	}
-
-	//! Returns the difference of the two matrices. Vector dimensions must agree.
-	friend VectorType operator-(const VectorType& lhs, const VectorType& rhs)
-	{
-		VectorType result(lhs);
-		result -= rhs;
-		return result;
-	}
-
-	//! Returns the negated vector.
-	friend VectorType operator-(const VectorType& in)
-	{
-		return T(-1)*VectorType(in);
-	}
 };
 
 //! Vector template alias
 template<typename T>
 using Vector3 = Matrix<T,3,1>;
 
+//! Vector aligned to the specified number of bytes and padded to full SIMD registers (e.g. 16 bytes for float)
+template<typename T, size_t alignment = 16>
+using AlignedVector3 = Matrix<T,3,1,AlignedStorage<alignment,true>>;
+
+/**
+ * @brief Transform an array of vectors by a matrix
+ *
+ * Computes out[i] = mat*in[i] for count vectors. For float and double the
+ * vectors are transformed with the SIMD kernel selected for the CPU. in and
+ * out may point to the same array.
+ */
+template<typename T>
+inline void transformVectors(const Matrix<T,3,3>& mat, const Vector3<T>* in, Vector3<T>* out, size_t count)
+{
+	static_assert(sizeof(Vector3<T>) == 3*sizeof(T), "Vectors must be stored without padding");
+	detail::Transform3Select<T>::get()(mat.data(), reinterpret_cast<const T*>(in), reinterpret_cast<T*>(out), count);
+}
+
 }
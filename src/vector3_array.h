@@ -0,0 +1,342 @@
+/*
+	linear_algebra_containers/vector3_array header file
+	MIT License
+
+	Copyright (c) 2016 Fabian Löschner
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "vector3.h"
+#include "aligned_allocator.h"
+#include "cpu_dispatch.h"
+
+namespace lin_algebra {
+
+/**
+ * Array of 3d vectors in structure-of-arrays layout
+ *
+ * Instead of storing Vector3 objects one after another (array-of-structures)
+ * the x, y and z coordinates of all vectors are stored in three separate
+ * streams starting at cache line boundaries. The bulk operations of the array
+ * therefore load full SIMD registers of coordinates (8 floats per instruction
+ * with AVX2, 16 with AVX-512) and don't have to shuffle the entries of
+ * individual vectors. The results of the bulk operations are identical to
+ * the results of the corresponding Vector3 operations applied to every vector.
+ * @tparam T Type used for the coordinates of the vectors.
+ */
+template<typename T>
+class Vector3Array
+{
+public:
+	//! Type of the coordinates
+	typedef T ScalarType;
+	//! Type of a single vector of the array
+	typedef Vector3<T> VectorType;
+	//! Alignment of the coordinate streams in bytes
+	static constexpr size_t alignment = 64;
+	//! Type of a coordinate stream
+	typedef std::vector<T,AlignedAllocator<T,alignment>> StreamType;
+
+private:
+	typedef detail::SoaKernel<T> SoaKernels;
+	typedef detail::DynamicElementwise<T> ElementwiseKernels;
+
+	StreamType x_;
+	StreamType y_;
+	StreamType z_;
+
+	//! Throws std::invalid_argument if the arrays don't have the same size
+	static void checkSizes(const Vector3Array& lhs, const Vector3Array& rhs, const char* message)
+	{
+		if(lhs.size() != rhs.size()) throw std::invalid_argument(message);
+	}
+
+public:
+	//! Construct an empty array
+	Vector3Array() = default;
+
+	//! Construct an array of count zero vectors
+	explicit Vector3Array(size_t count)
+		: x_(count, T(0)), y_(count, T(0)), z_(count, T(0))
+	{
+	}
+
+	//! Construct an array from count vectors in array-of-structures layout
+	Vector3Array(const VectorType* vectors, size_t count)
+		: x_(count), y_(count), z_(count)
+	{
+		for(size_t i = 0; i < count; i++) set(i, vectors[i]);
+	}
+
+	//! Construct an array from the specified vectors
+	explicit Vector3Array(const std::vector<VectorType>& vectors)
+		: Vector3Array(vectors.data(), vectors.size())
+	{
+	}
+
+	//! Copies all vectors to out in array-of-structures layout, out must have room for size() vectors
+	void copyTo(VectorType* out) const
+	{
+		for(size_t i = 0; i < size(); i++) out[i] = (*this)[i];
+	}
+
+	//! Returns the vectors in array-of-structures layout
+	std::vector<VectorType> toVector() const
+	{
+		std::vector<VectorType> vectors(size());
+		copyTo(vectors.data());
+		return vectors;
+	}
+
+	//! Returns the number of vectors in the array
+	size_t size() const { return x_.size(); }
+	//! Returns whether the array is empty
+	bool empty() const { return x_.empty(); }
+
+	//! Changes the number of vectors in the array, new vectors are set to zero
+	void resize(size_t count)
+	{
+		x_.resize(count, T(0));
+		y_.resize(count, T(0));
+		z_.resize(count, T(0));
+	}
+
+	//! Reserves memory for count vectors
+	void reserve(size_t count)
+	{
+		x_.reserve(count);
+		y_.reserve(count);
+		z_.reserve(count);
+	}
+
+	//! Removes all vectors from the array
+	void clear()
+	{
+		x_.clear();
+		y_.clear();
+		z_.clear();
+	}
+
+	//! Appends a vector to the array
+	void push_back(const VectorType& v)
+	{
+		x_.push_back(v[0]);
+		y_.push_back(v[1]);
+		z_.push_back(v[2]);
+	}
+
+	//! Returns a copy of the i-th vector
+	VectorType operator[](size_t i) const { return VectorType(x_[i], y_[i], z_[i]); }
+
+	//! Replaces the i-th vector
+	void set(size_t i, const VectorType& v)
+	{
+		x_[i] = v[0];
+		y_[i] = v[1];
+		z_[i] = v[2];
+	}
+
+	//! Returns the stream of x coordinates
+	T* x() { return x_.data(); }
+	//! Returns the stream of x coordinates
+	const T* x() const { return x_.data(); }
+	//! Returns the stream of y coordinates
+	T* y() { return y_.data(); }
+	//! Returns the stream of y coordinates
+	const T* y() const { return y_.data(); }
+	//! Returns the stream of z coordinates
+	T* z() { return z_.data(); }
+	//! Returns the stream of z coordinates
+	const T* z() const { return z_.data(); }
+
+	/**
+	 * @brief Calculate the inner products
+	 *
+	 * Calculates the inner products of the vectors with the same index of
+	 * both arrays. The arrays must have the same size, otherwise
+	 * std::invalid_argument is thrown.
+	 * @param lhs The first array.
+	 * @param rhs The second array.
+	 * @param out Array with room for lhs.size() inner products.
+	 */
+	static void dotProduct(const Vector3Array& lhs, const Vector3Array& rhs, T* out)
+	{
+		checkSizes(lhs, rhs, "Vector3Array::dotProduct: sizes of the arrays don't agree");
+		const T* a[3] = { lhs.x(), lhs.y(), lhs.z() };
+		const T* b[3] = { rhs.x(), rhs.y(), rhs.z() };
+		SoaKernels::dot3(a, b, out, lhs.size());
+	}
+
+	//! Returns the inner products of the vectors with the same index of both arrays
+	static std::vector<T> dotProduct(const Vector3Array& lhs, const Vector3Array& rhs)
+	{
+		std::vector<T> result(lhs.size());
+		dotProduct(lhs, rhs, result.data());
+		return result;
+	}
+
+	/**
+	 * @brief Calculate the cross products
+	 *
+	 * Calculates the cross products of the vectors with the same index of
+	 * both arrays. The arrays must have the same size, otherwise
+	 * std::invalid_argument is thrown.
+	 * @param lhs The array of left vectors.
+	 * @param rhs The array of right vectors.
+	 * @return The array of vectors normal to the vectors of the two arrays.
+	 */
+	static Vector3Array crossProduct(const Vector3Array& lhs, const Vector3Array& rhs)
+	{
+		checkSizes(lhs, rhs, "Vector3Array::crossProduct: sizes of the arrays don't agree");
+		Vector3Array result;
+		result.x_.resize(lhs.size());
+		result.y_.resize(lhs.size());
+		result.z_.resize(lhs.size());
+
+		const T* a[3] = { lhs.x(), lhs.y(), lhs.z() };
+		const T* b[3] = { rhs.x(), rhs.y(), rhs.z() };
+		T* out[3] = { result.x(), result.y(), result.z() };
+		SoaKernels::cross3(a, b, out, lhs.size());
+		return result;
+	}
+
+	//! Calculates the squared euclidean norms of all vectors, out must have room for size() values
+	void normSquared(T* out) const
+	{
+		const T* a[3] = { x(), y(), z() };
+		SoaKernels::normSquared3(a, out, size());
+	}
+
+	//! Returns the squared euclidean norms of all vectors
+	std::vector<T> normSquared() const
+	{
+		std::vector<T> result(size());
+		normSquared(result.data());
+		return result;
+	}
+
+	//! Returns the euclidean norms of all vectors
+	std::vector<T> norm() const
+	{
+		using std::sqrt;
+		std::vector<T> result = normSquared();
+		for(T& value : result) value = sqrt(value);
+		return result;
+	}
+
+	//! Normalizes all vectors of the array
+	Vector3Array& normalize()
+	{
+		const T* a[3] = { x(), y(), z() };
+		T* out[3] = { x(), y(), z() };
+		SoaKernels::normalize3(a, out, size());
+		return *this;
+	}
+
+	//! Returns a copy of the array with all vectors normalized
+	Vector3Array normalized() const
+	{
+		Vector3Array copy(*this);
+		copy.normalize();
+		return copy;
+	}
+
+	//! Adds the vectors of the specified array, the arrays must have the same size (throws std::invalid_argument)
+	Vector3Array& operator+=(const Vector3Array& rhs)
+	{
+		checkSizes(*this, rhs, "Vector3Array::operator+=: sizes of the arrays don't agree");
+		ElementwiseKernels::add(x(), rhs.x(), size());
+		ElementwiseKernels::add(y(), rhs.y(), size());
+		ElementwiseKernels::add(z(), rhs.z(), size());
+		return *this;
+	}
+
+	//! Subtracts the vectors of the specified array, the arrays must have the same size (throws std::invalid_argument)
+	Vector3Array& operator-=(const Vector3Array& rhs)
+	{
+		checkSizes(*this, rhs, "Vector3Array::operator-=: sizes of the arrays don't agree");
+		ElementwiseKernels::subtract(x(), rhs.x(), size());
+		ElementwiseKernels::subtract(y(), rhs.y(), size());
+		ElementwiseKernels::subtract(z(), rhs.z(), size());
+		return *this;
+	}
+
+	//! Multiplies all vectors with the specified factor
+	Vector3Array& operator*=(const T& factor)
+	{
+		ElementwiseKernels::scale(x(), factor, size());
+		ElementwiseKernels::scale(y(), factor, size());
+		ElementwiseKernels::scale(z(), factor, size());
+		return *this;
+	}
+
+	//! Returns whether the two arrays contain the same vectors
+	bool operator==(const Vector3Array& rhs) const
+	{
+		return (size() == rhs.size())
+			&& ElementwiseKernels::equal(x(), rhs.x(), size())
+			&& ElementwiseKernels::equal(y(), rhs.y(), size())
+			&& ElementwiseKernels::equal(z(), rhs.z(), size());
+	}
+
+	//! Returns whether the two arrays differ
+	bool operator!=(const Vector3Array& rhs) const { return !(*this == rhs); }
+};
+
+//! Returns the sum of the two arrays. The arrays must have the same size.
+template<typename T>
+inline Vector3Array<T> operator+(Vector3Array<T> lhs, const Vector3Array<T>& rhs)
+{
+	lhs += rhs;
+	return lhs;
+}
+
+//! Returns the difference of the two arrays. The arrays must have the same size.
+template<typename T>
+inline Vector3Array<T> operator-(Vector3Array<T> lhs, const Vector3Array<T>& rhs)
+{
+	lhs -= rhs;
+	return lhs;
+}
+
+//! Returns the array scaled by the specified factor.
+template<typename T>
+inline Vector3Array<T> operator*(Vector3Array<T> lhs, const T& factor)
+{
+	lhs *= factor;
+	return lhs;
+}
+
+//! Returns the array scaled by the specified factor.
+template<typename T>
+inline Vector3Array<T> operator*(const T& factor, Vector3Array<T> rhs)
+{
+	rhs *= factor;
+	return rhs;
+}
+
+}
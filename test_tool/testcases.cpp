@@ -22,10 +22,31 @@
 
 #include "catch.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include "matrix.h"
 #include "column_vector.h"
 #include "vector3.h"
 #include "quaternion.h"
+#include "vector3_array.h"
+#include "dynamic_matrix.h"
+#include "matrix_view.h"
+#include "counting_scalar.h"
+#include "lu_decomposition.h"
+#include "cholesky_decomposition.h"
+#include "householder_qr.h"
+#include "symmetric_eigen_decomposition.h"
+#include "singular_value_decomposition.h"
 
 using namespace lin_algebra;
 
@@ -203,6 +224,1967 @@ TEST_CASE("Testing Matrix")
 	}
 }
 
+template<typename T, size_t m, size_t n, size_t p>
+static void referenceProduct(const Matrix<T, m, n>& lhs, const Matrix<T, n, p>& rhs, Matrix<T, m, p>& result)
+{
+	for (size_t i = 0; i < m; i++) {
+		for (size_t j = 0; j < p; j++) {
+			T sum(0);
+			for (size_t k = 0; k < n; k++) sum += lhs(i, k) * rhs(k, j);
+			result(i, j) = sum;
+		}
+	}
+}
+
+template<typename T, size_t m, size_t n, size_t p>
+static bool checkProduct()
+{
+	typedef Matrix<T, m, n> lhs_type;
+	typedef Matrix<T, n, p> rhs_type;
+	typedef Matrix<T, m, p> result_type;
+
+	std::unique_ptr<lhs_type> lhs(new lhs_type);
+	std::unique_ptr<rhs_type> rhs(new rhs_type);
+	std::unique_ptr<result_type> expected(new result_type);
+
+	// Small integers keep all products exactly representable
+	for (size_t i = 0; i < m*n; i++) (*lhs)[i] = T(int(i * 7 % 11) - 5);
+	for (size_t i = 0; i < n*p; i++) (*rhs)[i] = T(int(i * 5 % 13) - 6);
+
+	referenceProduct(*lhs, *rhs, *expected);
+	std::unique_ptr<result_type> result(new result_type((*lhs)*(*rhs)));
+	return *result == *expected;
+}
+
+template<typename T, size_t m, size_t n, size_t p>
+static bool checkTransposedProducts()
+{
+	typedef Matrix<T, n, m> lhs_type;
+	typedef Matrix<T, p, n> rhs_type;
+	typedef Matrix<T, m, p> result_type;
+
+	std::unique_ptr<lhs_type> lhs(new lhs_type);
+	std::unique_ptr<rhs_type> rhs(new rhs_type);
+	std::unique_ptr<Matrix<T, m, n>> lhsT(new Matrix<T, m, n>);
+	std::unique_ptr<Matrix<T, n, p>> rhsT(new Matrix<T, n, p>);
+	std::unique_ptr<result_type> expected(new result_type);
+
+	for (size_t i = 0; i < m*n; i++) (*lhs)[i] = T(int(i * 7 % 11) - 5);
+	for (size_t i = 0; i < n*p; i++) (*rhs)[i] = T(int(i * 5 % 13) - 6);
+	for (size_t i = 0; i < m; i++) {
+		for (size_t k = 0; k < n; k++) (*lhsT)(i, k) = (*lhs)(k, i);
+	}
+	for (size_t k = 0; k < n; k++) {
+		for (size_t j = 0; j < p; j++) (*rhsT)(k, j) = (*rhs)(j, k);
+	}
+
+	referenceProduct(*lhsT, *rhsT, *expected);
+	std::unique_ptr<result_type> tn(new result_type(lhs->transposed()*(*rhsT)));
+	std::unique_ptr<result_type> nt(new result_type((*lhsT)*rhs->transposed()));
+	std::unique_ptr<result_type> tt(new result_type(lhs->transposed()*rhs->transposed()));
+	return (*tn == *expected) && (*nt == *expected) && (*tt == *expected);
+}
+
+TEST_CASE("Testing matrix product kernel")
+{
+	SECTION("Testing small products")
+	{
+		REQUIRE((checkProduct<double, 3, 3, 3>()));
+		REQUIRE((checkProduct<double, 2, 5, 7>()));
+		REQUIRE((checkProduct<float, 4, 4, 4>()));
+		REQUIRE((checkProduct<int, 5, 3, 2>()));
+	}
+
+	SECTION("Testing blocked products")
+	{
+		REQUIRE((checkProduct<double, 64, 64, 64>()));
+		REQUIRE((checkProduct<float, 64, 64, 64>()));
+		REQUIRE((checkProduct<int, 40, 40, 40>()));
+	}
+
+	SECTION("Testing blocked products with partial tiles and panels")
+	{
+		REQUIRE((checkProduct<double, 131, 67, 29>()));
+		REQUIRE((checkProduct<double, 37, 300, 41>()));
+		REQUIRE((checkProduct<float, 275, 261, 13>()));
+	}
+
+	SECTION("Testing products with transposed operands")
+	{
+		REQUIRE((checkTransposedProducts<double, 3, 3, 3>()));
+		REQUIRE((checkTransposedProducts<float, 4, 7, 2>()));
+		REQUIRE((checkTransposedProducts<double, 64, 64, 64>()));
+		REQUIRE((checkTransposedProducts<double, 131, 67, 29>()));
+		REQUIRE((checkTransposedProducts<int, 37, 300, 41>()));
+	}
+
+	SECTION("Testing parallel products")
+	{
+		const double threshold = parallelGemmThreshold();
+		const size_t threadCount = ThreadPool::instance().threadCount();
+		setParallelGemmThreshold(0.0);
+		ThreadPool::instance().resize(3);
+		REQUIRE(parallelGemmThreshold() == 0.0);
+
+		REQUIRE((checkProduct<double, 300, 70, 170>()));
+		REQUIRE((checkProduct<float, 275, 261, 13>()));
+		REQUIRE((checkProduct<double, 37, 300, 41>()));
+
+		ThreadPool::instance().resize(threadCount);
+		setParallelGemmThreshold(threshold);
+	}
+}
+
+TEST_CASE("Testing thread pool")
+{
+	ThreadPool pool(4);
+	REQUIRE(pool.threadCount() == 4);
+
+	SECTION("Testing parallel loops")
+	{
+		// Every index is written by exactly one task
+		std::vector<int> counts(1000, 0);
+		pool.parallelFor(counts.size(), [&](size_t i) { counts[i]++; });
+		REQUIRE(std::count(counts.begin(), counts.end(), 1) == 1000);
+
+		pool.resize(2);
+		REQUIRE(pool.threadCount() == 2);
+		pool.parallelFor(counts.size(), [&](size_t i) { counts[i]++; });
+		REQUIRE(std::count(counts.begin(), counts.end(), 2) == 1000);
+
+		pool.parallelFor(0, [&](size_t i) { counts[i]++; });
+		REQUIRE(std::count(counts.begin(), counts.end(), 2) == 1000);
+	}
+
+	SECTION("Testing nested parallel loops")
+	{
+		std::vector<int> counts(64*16, 0);
+		pool.parallelFor(64, [&](size_t i) {
+			pool.parallelFor(16, [&](size_t j) { counts[i*16 + j]++; });
+		});
+		REQUIRE(std::count(counts.begin(), counts.end(), 1) == 64*16);
+	}
+
+	SECTION("Testing uneven tasks")
+	{
+		// Tasks at the front are much more expensive, the other threads have to steal them
+		std::vector<double> results(200, 0.0);
+		pool.parallelFor(results.size(), [&](size_t i) {
+			double sum = 0.0;
+			const size_t steps = (i < 20) ? 200000 : 100;
+			for (size_t k = 0; k < steps; k++) sum += 1.0 / double(k + 1);
+			results[i] = sum;
+		});
+		bool computed = true;
+		for (size_t i = 0; i < results.size(); i++) computed &= (results[i] > 1.0);
+		REQUIRE(computed);
+	}
+	SECTION("Testing exceptions")
+	{
+		// The workers wait until the calling thread threw
+		const std::thread::id caller = std::this_thread::get_id();
+		std::atomic<bool> callerStarted(false);
+		REQUIRE_THROWS_AS(pool.parallelFor(64, [&](size_t) {
+			if (std::this_thread::get_id() == caller) {
+				callerStarted = true;
+				throw std::runtime_error("task failed");
+			}
+			while (!callerStarted) std::this_thread::yield();
+		}), std::runtime_error);
+
+		// The calling thread waits until a worker threw, so the exception has to be forwarded
+		std::atomic<bool> workerStarted(false);
+		REQUIRE_THROWS_AS(pool.parallelFor(64, [&](size_t) {
+			if (std::this_thread::get_id() == caller) {
+				while (!workerStarted) std::this_thread::yield();
+				return;
+			}
+			workerStarted = true;
+			throw std::runtime_error("task failed");
+		}), std::runtime_error);
+
+		// The pool still runs every index exactly once on all threads
+		std::atomic<bool> workerRan(false);
+		std::vector<int> counts(64, 0);
+		pool.parallelFor(counts.size(), [&](size_t i) {
+			counts[i]++;
+			if (std::this_thread::get_id() != caller) workerRan = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+		REQUIRE(std::count(counts.begin(), counts.end(), 1) == 64);
+		REQUIRE(workerRan);
+	}
+}
+
+TEST_CASE("Testing matrix expressions")
+{
+	typedef Matrix<double, 3, 2> mat3x2d;
+	typedef ColumnVector<double, 4> vec4d;
+	typedef Vector3<double> vec3d;
+
+	mat3x2d a{ 1.,2.,3.,4.,5.,6. };
+	mat3x2d b{ 6.,5.,4.,3.,2.,1. };
+	mat3x2d c;
+	c.fill(1);
+
+	SECTION("Testing lazy evaluation")
+	{
+		auto expr = a + b*2.0 - c;
+		REQUIRE(IsExpressionNode<decltype(expr)>::value);
+		REQUIRE((decltype(expr)::rows == 3));
+		REQUIRE((decltype(expr)::cols == 2));
+
+		a.fill(0);
+		const mat3x2d result = expr;
+		for (int i = 0; i < 6; i++) {
+			REQUIRE(result[i] == 2 * b[i] - 1);
+		}
+	}
+
+	SECTION("Testing assignment of expressions")
+	{
+		mat3x2d result;
+		result = -a + 2 * b - c*0.5;
+		for (int i = 0; i < 6; i++) {
+			REQUIRE(result[i] == -a[i] + 2 * b[i] - 0.5);
+		}
+		REQUIRE(result(2, 1) == -6 + 2 - 0.5);
+
+		result += a - c;
+		result -= -b;
+		for (int i = 0; i < 6; i++) {
+			REQUIRE(result[i] == 3 * b[i] - 1.5);
+		}
+
+		a = a + a;
+		REQUIRE(a == mat3x2d(2., 4., 6., 8., 10., 12.));
+	}
+
+	SECTION("Testing products and vector methods of expressions")
+	{
+		Matrix<double, 2, 3> m{ 1.,0.,0.,1.,1.,1. };
+		const Matrix<double, 2, 2> p = m*(a + b);
+		REQUIRE(p == Matrix<double, 2, 2>(14., 14., 14., 14.));
+
+		vec4d v1{ 1.,2.,3.,4. };
+		vec4d v2{ 1.,2.,3.,2. };
+		REQUIRE((v1 - v2).normSquared() == 4);
+		REQUIRE((v1 - v2).norm() == 2);
+		REQUIRE((v1 - v2).normalized() == vec4d(0., 0., 0., 1.));
+		REQUIRE((v1 - v2).transposed()*v1 == 8);
+		REQUIRE(vec4d::dotProduct(v1 + v2, v1) == 52);
+
+		vec3d x(1, 2, 3);
+		vec3d y(1, 1, 1);
+		REQUIRE((x - y).z() == 2);
+		REQUIRE(vec3d::crossProduct(x - y, y) == vec3d(-1, 2, -1));
+	}
+
+	SECTION("Testing transposed expressions")
+	{
+		// The transposed refers to the entries of the matrix
+		auto t = a.transposed();
+		REQUIRE(IsExpressionNode<decltype(t)>::value);
+		REQUIRE((decltype(t)::rows == 2));
+		REQUIRE((decltype(t)::cols == 3));
+		a(2, 1) = 9.;
+		REQUIRE(t(1, 2) == 9.);
+		REQUIRE(t[5] == 9.);
+		REQUIRE(t == Matrix<double, 2, 3>(1., 4., 2., 5., 3., 9.));
+		REQUIRE(&t.transposed() == &a);
+
+		REQUIRE(a.transposed()*b == Matrix<double, 2, 2>(28., 85., 10., 31.));
+		REQUIRE((a + b).transposed()*c == Matrix<double, 2, 2>(21., 24., 21., 24.));
+		REQUIRE(Matrix<double, 2, 3>((a - c).transposed()) == Matrix<double, 2, 3>(0., 3., 1., 4., 2., 8.));
+
+		vec4d v1{ 1.,2.,3.,4. };
+		vec4d v2{ 4.,3.,2.,1. };
+		REQUIRE(v1.transposed()*v2 == 20);
+		REQUIRE((v1*v2.transposed())(3, 0) == 16);
+
+		// Assignment of expressions that read the assigned matrix at other coordinates
+		Matrix<double, 3, 3> s{ 1.,2.,3.,4.,5.,6.,7.,8.,9. };
+		s = s.transposed();
+		REQUIRE(s == Matrix<double, 3, 3>(1., 4., 7., 2., 5., 8., 3., 6., 9.));
+		s += s.transposed();
+		REQUIRE(s == Matrix<double, 3, 3>(2., 6., 10., 6., 10., 14., 10., 14., 18.));
+		s -= 0.5*s.transposed();
+		REQUIRE(s == Matrix<double, 3, 3>(1., 3., 5., 3., 5., 7., 5., 7., 9.));
+
+		Matrix<double, 2, 2> q{ 1.,2.,3.,4. };
+		q = q.transposed() + q;
+		REQUIRE(q == Matrix<double, 2, 2>(2., 5., 5., 8.));
+
+		// Padded columns
+		AlignedMatrix<double, 3, 3> pa(s + Matrix<double, 3, 3>{ 0.,1.,2.,0.,0.,0.,0.,0.,0. });
+		const AlignedMatrix<double, 3, 3> pt = pa.transposed();
+		REQUIRE(pt(0, 2) == pa(2, 0));
+		REQUIRE(pt(2, 0) == pa(0, 2));
+		pa = pa.transposed();
+		REQUIRE(pa == pt);
+	}
+}
+
+template<typename T, size_t m, size_t n>
+static bool checkElementwiseKernels()
+{
+	typedef Matrix<T, m, n> mat_type;
+	mat_type a, b, expected;
+	for (size_t i = 0; i < m*n; i++) {
+		a[i] = T(i) * T(0.5);
+		b[i] = T(3) - T(i);
+	}
+
+	bool ok = true;
+
+	mat_type sum(a);
+	sum += b;
+	for (size_t i = 0; i < m*n; i++) ok &= (sum[i] == T(a[i] + b[i]));
+
+	mat_type difference(a);
+	difference -= b;
+	for (size_t i = 0; i < m*n; i++) ok &= (difference[i] == T(a[i] - b[i]));
+
+	mat_type scaled(a);
+	scaled *= 1.5;
+	for (size_t i = 0; i < m*n; i++) ok &= (scaled[i] == T(a[i] * 1.5));
+
+	// Factor that is not exactly representable as float
+	mat_type scaled2(b);
+	scaled2 *= 0.1;
+	for (size_t i = 0; i < m*n; i++) ok &= (scaled2[i] == T(b[i] * 0.1));
+
+	mat_type filled;
+	filled.fill(T(7));
+	for (size_t i = 0; i < m*n; i++) ok &= (filled[i] == T(7));
+
+	// Comparison must detect a difference in the last (remainder) entry
+	expected = a;
+	ok &= (expected == a);
+	expected[m*n - 1] += T(1);
+	ok &= (expected != a);
+	expected = a;
+	expected[0] -= T(1);
+	ok &= (expected != a);
+
+	return ok;
+}
+
+TEST_CASE("Testing elementwise kernels")
+{
+	SECTION("Testing float")
+	{
+		REQUIRE((checkElementwiseKernels<float, 1, 1>()));
+		REQUIRE((checkElementwiseKernels<float, 3, 1>()));
+		REQUIRE((checkElementwiseKernels<float, 5, 3>()));
+		REQUIRE((checkElementwiseKernels<float, 4, 4>()));
+		REQUIRE((checkElementwiseKernels<float, 7, 9>()));
+		REQUIRE((checkElementwiseKernels<float, 33, 1>()));
+		REQUIRE((checkElementwiseKernels<float, 9, 9>()));
+		REQUIRE((checkElementwiseKernels<float, 16, 16>()));
+	}
+
+	SECTION("Testing double")
+	{
+		REQUIRE((checkElementwiseKernels<double, 1, 1>()));
+		REQUIRE((checkElementwiseKernels<double, 3, 1>()));
+		REQUIRE((checkElementwiseKernels<double, 5, 3>()));
+		REQUIRE((checkElementwiseKernels<double, 4, 4>()));
+		REQUIRE((checkElementwiseKernels<double, 7, 9>()));
+		REQUIRE((checkElementwiseKernels<double, 33, 1>()));
+		REQUIRE((checkElementwiseKernels<double, 9, 9>()));
+		REQUIRE((checkElementwiseKernels<double, 16, 16>()));
+	}
+
+	SECTION("Testing scalar fallback")
+	{
+		REQUIRE((checkElementwiseKernels<int, 5, 3>()));
+		REQUIRE((checkElementwiseKernels<long double, 4, 4>()));
+	}
+
+	SECTION("Testing unrolled kernels")
+	{
+		typedef detail::UnrolledElementwiseKernel<double, 4> kernel;
+		typedef detail::UnrolledProduct<double, 2, 3, 2> product;
+		REQUIRE((std::is_same<detail::Elementwise<long double, 16>, detail::UnrolledElementwiseKernel<long double, 16>>::value == detail::IsUnrolledSize<16>::value));
+		REQUIRE((detail::IsUnrolledProduct<4, 5, 4>::value == detail::IsUnrolledSize<20>::value));
+
+		// The kernels can be evaluated at compile time
+		struct Compute
+		{
+			static constexpr double elementwise()
+			{
+				double a[4] = { 1., 2., 3., 4. };
+				const double b[4] = { 4., 3., 2., 1. };
+				kernel::add(a, b);
+				kernel::scale(a, 0.5);
+				kernel::subtract(a, b);
+				return kernel::dot(a, b) + (kernel::equal(a, b) ? 100. : 0.);
+			}
+
+			static constexpr double entry(size_t i)
+			{
+				const double a[6] = { 1., 2., 3., 4., 5., 6. };
+				const double b[6] = { 1., 0., 1., 0., 1., 1. };
+				double c[4] = {};
+				product::run(a, 1, 2, b, 1, 3, c, 2);
+				return c[i];
+			}
+		};
+		constexpr double dot = Compute::elementwise();
+		constexpr double c01 = Compute::entry(2);
+		REQUIRE(dot == -1.5*4. - 0.5*3. + 0.5*2. + 1.5*1.);
+		REQUIRE(c01 == 3. + 5.);
+		REQUIRE(Compute::entry(3) == 4. + 6.);
+	}
+
+	SECTION("Testing comparison of special values")
+	{
+		Matrix<double, 3, 3> a, b;
+		a.fill(0.0);
+		b.fill(-0.0);
+		REQUIRE(a == b);
+
+		a[4] = std::numeric_limits<double>::quiet_NaN();
+		b[4] = a[4];
+		REQUIRE(a != b);
+	}
+}
+
+TEST_CASE("Testing aligned storage")
+{
+	typedef AlignedMatrix<float, 3, 3> mat3fa;
+	typedef AlignedVector3<float> vec3fa;
+	typedef Matrix<float, 3, 3> mat3f;
+	typedef Vector3<float> vec3f;
+
+	SECTION("Testing layout")
+	{
+		REQUIRE(alignof(vec3fa) == 16);
+		REQUIRE(sizeof(vec3fa) == 16);
+		REQUIRE(size_t(mat3fa::leading_dimension) == 4);
+		REQUIRE(size_t(mat3fa::storage_size) == 12);
+
+		typedef AlignedMatrix<double, 3, 3, 32> mat3da;
+		REQUIRE(alignof(mat3da) == 32);
+		REQUIRE(size_t(mat3da::leading_dimension) == 4);
+		REQUIRE(sizeof(mat3da) == 12 * sizeof(double));
+
+		typedef Matrix<double, 3, 3, AlignedStorage<32>> mat3da_unpadded;
+		REQUIRE(alignof(mat3da_unpadded) == 32);
+		REQUIRE(size_t(mat3da_unpadded::leading_dimension) == 3);
+	}
+
+	SECTION("Testing construction and access")
+	{
+		mat3fa a(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f);
+		mat3f b(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(a.data()) % 16 == 0);
+
+		bool ok = true;
+		for (size_t i = 0; i < 9; i++) ok &= (a[i] == b[i]);
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				ok &= (a(i, j) == b(i, j));
+				ok &= (a.data()[mat3fa::index(i, j)] == b(i, j));
+			}
+		}
+		REQUIRE(ok);
+		REQUIRE(a.data()[4] == 4.0f);
+
+		const mat3fa c(b);
+		REQUIRE(c == a);
+		const mat3f d(a);
+		REQUIRE(d == b);
+	}
+
+	SECTION("Testing arithmetic")
+	{
+		const mat3f b(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f);
+		mat3fa a(b);
+
+		// Padding entries are not part of the matrix
+		a.data()[3] = 42.0f;
+		REQUIRE(a == mat3fa(b));
+
+		a += a;
+		REQUIRE(mat3f(a) == mat3f(2.0f*b));
+		a -= b;
+		REQUIRE(mat3f(a) == b);
+		a *= 0.5;
+		REQUIRE(mat3f(a) == mat3f(b*0.5f));
+
+		a = b;
+		REQUIRE(mat3f(a*a) == b*b);
+		REQUIRE(mat3f(a*b) == b*b);
+		REQUIRE(b*a == b*b);
+
+		const vec3f v(1.0f, -2.0f, 0.5f);
+		const vec3fa va(v);
+		REQUIRE(vec3f(a*va) == b*v);
+		REQUIRE(vec3f(vec3fa::crossProduct(va, vec3fa(0.0f, 1.0f, 0.0f))) == vec3f::crossProduct(v, vec3f(0.0f, 1.0f, 0.0f)));
+		REQUIRE(vec3fa::dotProduct(va, va) == vec3f::dotProduct(v, v));
+		REQUIRE(va.norm() == v.norm());
+
+		vec3fa w(va);
+		w += va;
+		w *= 0.25;
+		REQUIRE(vec3f(w) == vec3f(v*0.5f));
+	}
+}
+
+TEST_CASE("Testing heap storage")
+{
+	typedef HeapMatrix<double, 200, 150> matHeap;
+	typedef Matrix<double, 200, 150> matDense;
+
+	SECTION("Testing layout")
+	{
+		REQUIRE(size_t(matHeap::leading_dimension) == 200);
+		REQUIRE(sizeof(matHeap) == sizeof(double*));
+		REQUIRE(std::is_nothrow_move_constructible<matHeap>::value);
+		REQUIRE(std::is_nothrow_move_assignable<matHeap>::value);
+
+		const HeapMatrix<float, 5, 3> small(1.0f, 2.0f);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(small.data()) % 64 == 0);
+		REQUIRE(small[0] == 1.0f);
+		REQUIRE(small[1] == 2.0f);
+		REQUIRE(small[14] == 0.0f);
+	}
+
+	SECTION("Testing copy and move")
+	{
+		std::unique_ptr<matDense> dense(new matDense);
+		matHeap a;
+		for (size_t i = 0; i < 200 * 150; i++) a[i] = (*dense)[i] = double(i % 97) - 48.0;
+
+		matHeap b(a);
+		REQUIRE(b == a);
+		REQUIRE(b.data() != a.data());
+		b(3, 4) = 1000.0;
+		REQUIRE(a(3, 4) != 1000.0);
+
+		// Moves transfer the entries
+		const double* entries = b.data();
+		matHeap c(std::move(b));
+		REQUIRE(c.data() == entries);
+		matHeap d;
+		d = std::move(c);
+		REQUIRE(d.data() == entries);
+
+		// A moved-from matrix can be assigned to again
+		c = a;
+		REQUIRE(c == a);
+	}
+
+	SECTION("Testing assignments to moved-from matrices")
+	{
+		HeapMatrix<double, 4, 4> b, c;
+		for (size_t i = 0; i < 16; i++) {
+			b[i] = double(i);
+			c[i] = 2.0 - double(i % 5);
+		}
+		const HeapMatrix<double, 4, 4> original(b);
+
+		HeapMatrix<double, 4, 4> d(std::move(b));
+		REQUIRE(b.data() == nullptr);
+		b = d + c;
+		REQUIRE(b(1, 2) == d(1, 2) + c(1, 2));
+
+		HeapMatrix<double, 4, 4> e(std::move(b));
+		b = d.transposed();
+		REQUIRE(b(1, 2) == d(2, 1));
+
+		// Compound assignments start from zero
+		HeapMatrix<double, 4, 4> f(std::move(b));
+		b += d;
+		REQUIRE(b == original);
+		HeapMatrix<double, 4, 4> g(std::move(b));
+		b -= d;
+		REQUIRE(b(1, 2) == -original(1, 2));
+		HeapMatrix<double, 4, 4> h(std::move(b));
+		b *= 2.0;
+		REQUIRE(b(1, 2) == 0.0);
+		HeapMatrix<double, 4, 4> k(std::move(b));
+		b.fill(3.0);
+		REQUIRE(b(3, 3) == 3.0);
+
+		matHeap large;
+		large.fill(1.0);
+		matHeap moved(std::move(large));
+		large = moved.transposed().transposed();
+		REQUIRE(large == moved);
+	}
+
+	SECTION("Testing arithmetic")
+	{
+		std::unique_ptr<matDense> denseA(new matDense), denseB(new matDense);
+		std::unique_ptr<Matrix<double, 150, 40>> denseC(new Matrix<double, 150, 40>);
+		matHeap a, b;
+		HeapMatrix<double, 150, 40> c;
+		for (size_t i = 0; i < 200 * 150; i++) {
+			a[i] = (*denseA)[i] = double(i % 13) * 0.5;
+			b[i] = (*denseB)[i] = 2.0 - double(i % 7);
+		}
+		for (size_t i = 0; i < 150 * 40; i++) c[i] = (*denseC)[i] = double(i % 5) - 2.0;
+
+		const matHeap sum = a + 2.0 * b;
+		const HeapMatrix<double, 200, 40> product = a * c;
+		const HeapMatrix<double, 150, 200> transposed = a.transposed();
+		const std::unique_ptr<matDense> denseSum(new matDense(*denseA + 2.0 * (*denseB)));
+		const std::unique_ptr<Matrix<double, 200, 40>> denseProduct(new Matrix<double, 200, 40>((*denseA) * (*denseC)));
+		bool sameSum = true, sameProduct = true;
+		for (size_t i = 0; i < 200 * 150; i++) sameSum &= (sum[i] == (*denseSum)[i]);
+		for (size_t i = 0; i < 200 * 40; i++) sameProduct &= (product[i] == (*denseProduct)[i]);
+		REQUIRE(sameSum);
+		REQUIRE(sameProduct);
+		REQUIRE(transposed(17, 3) == a(3, 17));
+
+		a += b;
+		a -= b;
+		a *= 2.0;
+		REQUIRE(a(5, 7) == 2.0 * (*denseA)(5, 7));
+
+		// Compound assignments return the matrix itself
+		REQUIRE(&(a += b) == &a);
+		REQUIRE(&(a -= b) == &a);
+		REQUIRE(&(a *= 0.5) == &a);
+		REQUIRE(a(5, 7) == (*denseA)(5, 7));
+	}
+
+	SECTION("Testing operators on expiring operands")
+	{
+		matHeap a, b;
+		for (size_t i = 0; i < 200 * 150; i++) {
+			a[i] = double(i % 13) * 0.5;
+			b[i] = 2.0 - double(i % 7);
+		}
+
+		// The results are computed in the entries of the expiring operands
+		matHeap t(a);
+		const double* entries = t.data();
+		matHeap sum = std::move(t) + b;
+		REQUIRE(sum.data() == entries);
+		REQUIRE(sum(4, 9) == a(4, 9) + b(4, 9));
+
+		matHeap difference = a - std::move(sum);
+		REQUIRE(difference.data() == entries);
+		REQUIRE(difference(4, 9) == -b(4, 9));
+
+		matHeap scaled = 2.0 * (-std::move(difference));
+		REQUIRE(scaled.data() == entries);
+		REQUIRE(scaled(4, 9) == 2.0 * b(4, 9));
+
+		matHeap u(b);
+		matHeap both = std::move(scaled) - std::move(u);
+		REQUIRE(both.data() == entries);
+		REQUIRE(both(4, 9) == b(4, 9));
+
+		// Expressions of lvalues are still evaluated in a single pass
+		const matHeap expression = a + 2.0 * b - a.transposed().transposed();
+		REQUIRE(expression(4, 9) == 2.0 * b(4, 9));
+	}
+}
+
+TEST_CASE("Testing matrix views")
+{
+	SECTION("Testing access")
+	{
+		float buffer[12];
+		for (size_t i = 0; i < 12; i++) buffer[i] = float(i);
+
+		MatrixView<float, 3, 4> view(buffer);
+		REQUIRE(view.data() == buffer);
+		REQUIRE(view(2, 1) == 5.0f);
+		REQUIRE(view[7] == 7.0f);
+		view(1, 2) = 20.0f;
+		REQUIRE(buffer[7] == 20.0f);
+
+		// Copies refer to the same entries, assignments write to the viewed entries
+		MatrixView<float, 3, 4> copy(view);
+		REQUIRE(copy.data() == buffer);
+		const Matrix<float, 3, 4> mat(view);
+		REQUIRE(mat == view);
+		copy.zeros();
+		REQUIRE(buffer[11] == 0.0f);
+		copy = mat;
+		REQUIRE(buffer[11] == 11.0f);
+		REQUIRE(view == mat);
+
+		const ConstMatrixView<float, 3, 4> constView(view);
+		REQUIRE(constView(1, 2) == 20.0f);
+		REQUIRE(ConstMatrixView<float, 3, 4>(mat).data() == mat.data());
+
+		Matrix<float, 3, 4> target;
+		MatrixView<float, 3, 4> targetView(target);
+		targetView = 2.0f * constView;
+		REQUIRE(target(1, 2) == 40.0f);
+	}
+
+	SECTION("Testing strides")
+	{
+		// Row-major 2 x 3 matrix
+		const double rowMajor[] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+		const ConstMatrixView<double, 2, 3> rows(rowMajor, 3, 1);
+		REQUIRE(rows(1, 0) == 4.0);
+		REQUIRE(rows(0, 2) == 3.0);
+		REQUIRE(rows == Matrix<double, 2, 3>(1.0, 4.0, 2.0, 5.0, 3.0, 6.0));
+
+		// The transposed view swaps the strides
+		const ConstMatrixView<double, 3, 2> columns = rows.transposed();
+		REQUIRE(columns.data() == rowMajor);
+		REQUIRE(columns.rowStride() == 1);
+		REQUIRE(columns.columnStride() == 3);
+		REQUIRE(columns(2, 1) == 6.0);
+
+		// Padded columns
+		double padded[8] = { 1.0, 2.0, 3.0, -1.0, 4.0, 5.0, 6.0, -1.0 };
+		MatrixView<double, 3, 2> paddedView(padded, 1, 4);
+		REQUIRE(paddedView == columns);
+		paddedView *= 2.0;
+		REQUIRE(padded[6] == 12.0);
+		REQUIRE(padded[7] == -1.0);
+	}
+
+	SECTION("Testing products")
+	{
+		// Small integers keep all products exactly representable
+		std::vector<double> lhsEntries(40 * 50), rhsEntries(50 * 30);
+		for (size_t i = 0; i < lhsEntries.size(); i++) lhsEntries[i] = double(int(i * 7 % 11) - 5);
+		for (size_t i = 0; i < rhsEntries.size(); i++) rhsEntries[i] = double(int(i * 5 % 13) - 6);
+
+		typedef Matrix<double, 40, 50> matLhs;
+		typedef Matrix<double, 50, 30> matRhs;
+		typedef Matrix<double, 40, 30> matResult;
+		const ConstMatrixView<double, 40, 50> lhs(lhsEntries.data());
+		const ConstMatrixView<double, 50, 30> rhsRowMajor(rhsEntries.data(), 30, 1);
+		std::unique_ptr<matLhs> lhsMat(new matLhs(lhs));
+		std::unique_ptr<matRhs> rhsMat(new matRhs(rhsRowMajor));
+		std::unique_ptr<matResult> expected(new matResult((*lhsMat) * (*rhsMat)));
+
+		REQUIRE(matResult(lhs * rhsRowMajor) == *expected);
+		REQUIRE(matResult((*lhsMat) * rhsRowMajor) == *expected);
+		REQUIRE(matResult(lhs * (*rhsMat)) == *expected);
+		REQUIRE(matResult(lhs.transposed().transposed() * rhsRowMajor.transposed().transposed()) == *expected);
+
+		// Small strided products
+		const Matrix<double, 3, 3> small(2.0, 0.0, 1.0, -1.0, 3.0, 0.0, 4.0, 1.0, 5.0);
+		const ConstMatrixView<double, 3, 3> smallView(small);
+		REQUIRE(Matrix<double, 3, 3>(smallView.transposed() * smallView) == small.transposed() * small);
+
+		// Row times column vector is a scalar
+		const ConstVectorView<double, 3> column(small.data(), 1, 3);
+		REQUIRE(column.transposed() * column == 5.0);
+	}
+
+	SECTION("Testing vectors")
+	{
+		// Positions interleaved with a fourth attribute
+		float frame[] = { 3.0f, 0.0f, 4.0f, 7.0f, 0.0f, 1.0f, 0.0f, 9.0f };
+		VectorView<float, 3> p(frame), q(frame + 4);
+		REQUIRE(p.norm() == 5.0f);
+		REQUIRE(VectorView<float, 3>::dotProduct(p, q) == 0.0f);
+		REQUIRE(VectorView<float, 3>::dotProduct(p, Vector3<float>(1.0f, 1.0f, 1.0f)) == 7.0f);
+		REQUIRE(Vector3<float>::crossProduct(p, q) == Vector3<float>(-4.0f, 0.0f, 3.0f));
+		REQUIRE(Vector3<float>(p + q) == Vector3<float>(3.0f, 1.0f, 4.0f));
+
+		p.normalize();
+		REQUIRE(frame[0] == 0.6f);
+		REQUIRE(frame[3] == 7.0f);
+
+		// Stride over the x coordinates of both positions
+		const ConstVectorView<float, 2> xs(frame, 4, 0);
+		REQUIRE(xs[1] == 0.0f);
+		REQUIRE(xs.x() == 0.6f);
+
+		const Matrix<float, 3, 3> rotation(0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+		REQUIRE(Vector3<float>(rotation * q) == Vector3<float>(-1.0f, 0.0f, 0.0f));
+	}
+}
+
+TEST_CASE("Testing dynamic matrices")
+{
+	SECTION("Testing construction and access")
+	{
+		DynamicMatrix<float> a(3, 2);
+		REQUIRE(a.rows() == 3);
+		REQUIRE(a.cols() == 2);
+		REQUIRE(a.size() == 6);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(a.data()) % 64 == 0);
+		REQUIRE(a[5] == 0.0f);
+
+		a(2, 1) = 4.0f;
+		REQUIRE(a[5] == 4.0f);
+		REQUIRE(a.data()[a.index(2, 1)] == 4.0f);
+
+		const float entries[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+		const DynamicMatrix<float> b(2, 3, entries);
+		REQUIRE(b(1, 0) == 2.0f);
+		REQUIRE(b(0, 2) == 5.0f);
+		REQUIRE(b.transposed()(2, 0) == 5.0f);
+		REQUIRE(DynamicMatrix<float>::createIdentity(3, 3)(1, 1) == 1.0f);
+
+		DynamicMatrix<float> empty;
+		REQUIRE(empty.empty());
+		REQUIRE(empty.data() == nullptr);
+		empty = b;
+		REQUIRE(empty == b);
+		a.resize(3, 4);
+		REQUIRE(a.size() == 12);
+		REQUIRE(a[11] == 0.0f);
+
+		// Moves transfer the entries
+		const float* data = empty.data();
+		DynamicMatrix<float> c(std::move(empty));
+		REQUIRE(c.data() == data);
+		REQUIRE(empty.empty());
+	}
+
+	SECTION("Testing dimension checks")
+	{
+		// The dimensions are checked in all builds, also if NDEBUG is defined
+		DynamicMatrix<double> a(3, 2), b(2, 3), c(3, 2);
+		REQUIRE_THROWS_AS(a += b, std::invalid_argument);
+		REQUIRE_THROWS_AS(a -= b, std::invalid_argument);
+		REQUIRE_THROWS_AS(a + b, std::invalid_argument);
+		REQUIRE_THROWS_AS(a * c, std::invalid_argument);
+		REQUIRE_NOTHROW(a * b);
+		REQUIRE_THROWS_AS((a.asMatrix<2, 3>()), std::invalid_argument);
+		REQUIRE_THROWS_AS((a.toMatrix<3, 3>()), std::invalid_argument);
+		REQUIRE_THROWS_AS(DynamicVector<double>(std::move(b)), std::invalid_argument);
+		REQUIRE_THROWS_AS(DynamicVector<double>::dotProduct(DynamicVector<double>(3), DynamicVector<double>(4)), std::invalid_argument);
+
+		// A failed hand over keeps the entries
+		const double* entries = a.data();
+		REQUIRE_THROWS_AS((std::move(a).toHeapMatrix<2, 3>()), std::invalid_argument);
+		REQUIRE(a.data() == entries);
+		REQUIRE(a.rows() == 3);
+	}
+
+	SECTION("Testing conversion to and from fixed-size matrices")
+	{
+		const Matrix<double, 3, 2> fixed(1.0, 2.0, 3.0, 4.0, 5.0, 6.0);
+		DynamicMatrix<double> a(fixed);
+		REQUIRE(a.rows() == 3);
+		REQUIRE(a.cols() == 2);
+		REQUIRE(a(1, 1) == 5.0);
+		REQUIRE(a.toMatrix<3, 2>() == fixed);
+
+		// Access without copying
+		Matrix<double, 3, 2>& view = a.asMatrix<3, 2>();
+		REQUIRE(view.data() == a.data());
+		view(0, 1) = 10.0;
+		REQUIRE(a(0, 1) == 10.0);
+
+		const AlignedMatrix<float, 3, 2> padded(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f);
+		REQUIRE(DynamicMatrix<float>(padded)(2, 1) == 6.0f);
+
+		// Heap matrices are exchanged without copying
+		HeapMatrix<double, 100, 80> heap;
+		for (size_t i = 0; i < 100 * 80; i++) heap[i] = double(i);
+		const double* entries = heap.data();
+		DynamicMatrix<double> b(std::move(heap));
+		REQUIRE(b.data() == entries);
+		REQUIRE(b.rows() == 100);
+		REQUIRE(b(3, 2) == 203.0);
+
+		HeapMatrix<double, 100, 80> back = std::move(b).toHeapMatrix<100, 80>();
+		REQUIRE(back.data() == entries);
+		REQUIRE(b.empty());
+		REQUIRE(back(3, 2) == 203.0);
+
+		// Moved-from heap matrices give empty matrices and can be assigned to again
+		DynamicMatrix<double> none(std::move(heap));
+		REQUIRE(none.empty());
+		REQUIRE(none.rows() == 0);
+		REQUIRE(none.data() == nullptr);
+		heap = back + back;
+		REQUIRE(heap(3, 2) == 406.0);
+		DynamicMatrix<double> again(std::move(heap));
+		REQUIRE(again.rows() == 100);
+		REQUIRE(again(3, 2) == 406.0);
+
+		const Matrix<double, 3, 1> column(1.0, 2.0, 3.0);
+		DynamicVector<double> v(column);
+		REQUIRE(v.size() == 3);
+		REQUIRE(v.asMatrix<3, 1>() == column);
+	}
+
+	SECTION("Testing arithmetic")
+	{
+		typedef Matrix<double, 40, 50> matLhs;
+		typedef Matrix<double, 50, 30> matRhs;
+		std::unique_ptr<matLhs> fixedA(new matLhs), fixedB(new matLhs);
+		std::unique_ptr<matRhs> fixedC(new matRhs);
+		for (size_t i = 0; i < 40 * 50; i++) {
+			(*fixedA)[i] = double(i % 13) * 0.5;
+			(*fixedB)[i] = 2.0 - double(i % 7);
+		}
+		for (size_t i = 0; i < 50 * 30; i++) (*fixedC)[i] = double(i % 5) - 2.0;
+
+		const DynamicMatrix<double> a(*fixedA), b(*fixedB), c(*fixedC);
+		REQUIRE((a + 2.0 * b).toMatrix<40, 50>() == matLhs(*fixedA + 2.0 * (*fixedB)));
+		REQUIRE((a - b).toMatrix<40, 50>() == matLhs(*fixedA - *fixedB));
+		REQUIRE((-a).toMatrix<40, 50>() == matLhs(-(*fixedA)));
+		REQUIRE((a * c).toMatrix<40, 30>() == (*fixedA) * (*fixedC));
+		REQUIRE(a.transposed().toMatrix<50, 40>() == fixedA->transposed());
+
+		// Transposition of a matrix that is not a multiple of the tile size
+		DynamicMatrix<float> d(70, 45);
+		for (size_t i = 0; i < d.size(); i++) d[i] = float(i);
+		const DynamicMatrix<float> dt = d.transposed();
+		bool transposed = (dt.rows() == 45) && (dt.cols() == 70);
+		for (size_t i = 0; i < 70; i++) {
+			for (size_t j = 0; j < 45; j++) transposed &= (dt(j, i) == d(i, j));
+		}
+		REQUIRE(transposed);
+		REQUIRE(dt.transposed() == d);
+
+		DynamicMatrix<double> e(a);
+		e += b;
+		e -= b;
+		e *= 2.0;
+		REQUIRE(e(5, 7) == 2.0 * a(5, 7));
+		REQUIRE(e != a);
+	}
+
+	SECTION("Testing vectors")
+	{
+		const double values[] = { 3.0, 0.0, 4.0 };
+		const DynamicVector<double> v(3, values);
+		REQUIRE(v.norm() == 5.0);
+		REQUIRE(DynamicVector<double>::dotProduct(v, v) == 25.0);
+		REQUIRE(v.normalized()[2] == 0.8);
+
+		const DynamicVector<double> w = 2.0 * v - v;
+		REQUIRE(w == v);
+
+		const Matrix<double, 2, 3> fixed(1.0, 2.0, 3.0, 4.0, 5.0, 6.0);
+		const DynamicVector<double> product = DynamicMatrix<double>(fixed) * v;
+		REQUIRE(product.size() == 2);
+		REQUIRE(product.asMatrix<2, 1>() == fixed * Matrix<double, 3, 1>(3.0, 0.0, 4.0));
+	}
+}
+
+//! Returns the largest absolute difference of the entries of the two n x n matrices
+template<typename T, size_t n, typename LhsStorage, typename RhsStorage>
+static T maxDifference(const Matrix<T, n, n, LhsStorage>& lhs, const Matrix<T, n, n, RhsStorage>& rhs)
+{
+	T difference = T(0);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) difference = std::max(difference, std::abs(lhs(i, j) - rhs(i, j)));
+	}
+	return difference;
+}
+
+//! Returns a well conditioned n x n matrix with entries depending on seed
+template<typename T, size_t n>
+static Matrix<T, n, n> testMatrix(size_t seed)
+{
+	Matrix<T, n, n> mat;
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) mat(i, j) = T(int((7 * i + 3 * j + 5 * seed) % 11) - 5) / T(10);
+		mat(i, i) += T(n);
+	}
+	return mat;
+}
+
+TEST_CASE("Testing inverse and determinant")
+{
+	SECTION("Testing determinant()")
+	{
+		const Matrix<double, 2, 2> a(1.0, 3.0, 2.0, 4.0);
+		REQUIRE(a.determinant() == -2.0);
+
+		Matrix<double, 3, 3> b = Matrix<double, 3, 3>::createIdentity();
+		b(0, 1) = 2.0; b(2, 0) = 1.0; b(2, 2) = 3.0;
+		REQUIRE(b.determinant() == Approx(1.0 * 3.0 - 2.0 * (0.0 * 3.0 - 0.0 * 1.0)));
+
+		Matrix<double, 4, 4> c = Matrix<double, 4, 4>::createIdentity();
+		c(0, 0) = 2.0; c(1, 1) = 3.0; c(3, 3) = 0.5; c(0, 3) = 7.0;
+		REQUIRE(c.determinant() == Approx(3.0));
+
+		// Swapping two rows flips the sign
+		Matrix<double, 4, 4> d = testMatrix<double, 4>(1), e = d;
+		for (size_t j = 0; j < 4; j++) std::swap(e(1, j), e(3, j));
+		REQUIRE(e.determinant() == Approx(-d.determinant()));
+	}
+
+	SECTION("Testing inverse()")
+	{
+		const Matrix<double, 2, 2> a = testMatrix<double, 2>(1);
+		const Matrix<double, 3, 3> b = testMatrix<double, 3>(2);
+		const Matrix<double, 4, 4> c = testMatrix<double, 4>(3);
+		REQUIRE(maxDifference(Matrix<double, 2, 2>(a * a.inverse()), Matrix<double, 2, 2>::createIdentity()) < 1e-14);
+		REQUIRE(maxDifference(Matrix<double, 3, 3>(b * b.inverse()), Matrix<double, 3, 3>::createIdentity()) < 1e-14);
+		REQUIRE(maxDifference(Matrix<double, 4, 4>(c * c.inverse()), Matrix<double, 4, 4>::createIdentity()) < 1e-14);
+		REQUIRE(c.inverse().determinant() == Approx(1.0 / c.determinant()));
+
+		// Padded storage
+		AlignedMatrix<float, 3, 3> aligned;
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) aligned(i, j) = float(b(i, j));
+		}
+		const AlignedMatrix<float, 3, 3> alignedInverse = aligned.inverse();
+		REQUIRE(aligned.determinant() == Approx(float(b.determinant())));
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) REQUIRE(alignedInverse(i, j) == Approx(float(b.inverse()(i, j))));
+		}
+	}
+
+	SECTION("Testing affineInverse() and rigidInverse()")
+	{
+		typedef Matrix<double, 4, 4> mat4d;
+		const Matrix<double, 3, 3> rotation = Quaternion<double>::fromAxisAndAngle(Vector3<double>(1, 2, 3).normalized(), 0.8).toMatrix();
+		const Matrix<double, 3, 3> linear = testMatrix<double, 3>(4);
+
+		mat4d rigid = mat4d::createIdentity(), affine = mat4d::createIdentity();
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) {
+				rigid(i, j) = rotation(i, j);
+				affine(i, j) = linear(i, j);
+			}
+			rigid(i, 3) = double(i) - 1.5;
+			affine(i, 3) = 2.0 * double(i) + 0.5;
+		}
+
+		REQUIRE(maxDifference(rigid.rigidInverse(), rigid.inverse()) < 1e-14);
+		REQUIRE(maxDifference(affine.affineInverse(), affine.inverse()) < 1e-14);
+		REQUIRE(affine.affineInverse()(3, 3) == 1.0);
+		REQUIRE(affine.affineInverse()(3, 0) == 0.0);
+	}
+
+	SECTION("Testing invertMatrices()")
+	{
+		std::vector<Matrix<float, 3, 3>> in3(37), out3(37);
+		std::vector<Matrix<float, 4, 4>> in4(37), out4(37);
+		std::vector<Matrix<float, 2, 2>> in2(37), out2(37);
+		for (size_t i = 0; i < 37; i++) {
+			in2[i] = testMatrix<float, 2>(i);
+			in3[i] = testMatrix<float, 3>(i);
+			in4[i] = testMatrix<float, 4>(i);
+		}
+
+		invertMatrices(in2.data(), out2.data(), in2.size());
+		invertMatrices(in3.data(), out3.data(), in3.size());
+		invertMatrices(in4.data(), out4.data(), in4.size());
+		for (size_t i = 0; i < 37; i++) {
+			CHECK(maxDifference(out2[i], in2[i].inverse()) < 1e-6f);
+			CHECK(maxDifference(out3[i], in3[i].inverse()) < 1e-6f);
+			CHECK(maxDifference(out4[i], in4[i].inverse()) < 1e-6f);
+		}
+
+		// In place
+		std::vector<Matrix<float, 4, 4>> inPlace(in4);
+		invertMatrices(inPlace.data(), inPlace.data(), inPlace.size());
+		REQUIRE(inPlace == out4);
+	}
+}
+
+//! Destroys and frees a matrix allocated by allocateAligned()
+template<typename M>
+struct AlignedDelete
+{
+	void operator()(M* mat) const
+	{
+		mat->~M();
+		AlignedAllocator<M, alignof(M)>().deallocate(mat, 1);
+	}
+};
+
+//! Allocates a zero matrix with the alignment of its storage on the heap (new only respects extended alignments since C++17)
+template<typename M>
+static std::unique_ptr<M, AlignedDelete<M>> allocateAligned()
+{
+	return std::unique_ptr<M, AlignedDelete<M>>(new(AlignedAllocator<M, alignof(M)>().allocate(1)) M());
+}
+
+//! Fills the k right-hand sides of a linear system with small integers
+template<typename T, size_t n, size_t k, typename Storage>
+static void rightHandSides(Matrix<T, n, k, Storage>& b, size_t seed)
+{
+	for (size_t i = 0; i < n; i++) {
+		for (size_t c = 0; c < k; c++) b(i, c) = T(int((i + 3 * c + seed) % 7) - 3);
+	}
+}
+
+//! Returns the largest entry of |a*x - b|, computed entry by entry
+template<typename T, size_t m, size_t n, size_t k, typename StorageA, typename StorageX, typename StorageB>
+static T maxResidual(const Matrix<T, m, n, StorageA>& a, const Matrix<T, n, k, StorageX>& x, const Matrix<T, m, k, StorageB>& b)
+{
+	T residual = T(0);
+	for (size_t i = 0; i < m; i++) {
+		for (size_t c = 0; c < k; c++) {
+			T sum = -b(i, c);
+			for (size_t j = 0; j < n; j++) sum += a(i, j) * x(j, c);
+			residual = std::max(residual, std::abs(sum));
+		}
+	}
+	return residual;
+}
+
+//! Returns a regular n x n matrix whose factorization has to swap rows in every step
+template<typename T, size_t n, typename Storage>
+static void pivotingMatrix(Matrix<T, n, n, Storage>& mat, size_t seed)
+{
+	// Reversed rows of a diagonally dominant matrix
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) mat(i, j) = T(int((7 * i + 3 * j + 5 * seed) % 11) - 5) / T(10);
+		mat(i, n - 1 - i) += T(n);
+	}
+}
+
+//! Solves a system with k right-hand sides by LUDecomposition and returns the largest entry of the residual
+template<typename T, size_t n, size_t k, typename Storage = DenseStorage>
+static T luResidual(size_t seed)
+{
+	const auto a = allocateAligned<Matrix<T, n, n, Storage>>();
+	HeapMatrix<T, n, k> b;
+	pivotingMatrix(*a, seed);
+	rightHandSides(b, seed);
+
+	const LUDecomposition<T, n, Storage> lu(*a);
+	const HeapMatrix<T, n, k> x(lu.solve(b));
+	return maxResidual(*a, x, b);
+}
+
+TEST_CASE("Testing LU decomposition")
+{
+	SECTION("Testing solve()")
+	{
+		// Unrolled
+		REQUIRE(luResidual<double, 2, 1>(1) < 1e-13);
+		REQUIRE(luResidual<double, 3, 2>(2) < 1e-13);
+		REQUIRE(luResidual<double, 4, 4>(3) < 1e-13);
+		REQUIRE(luResidual<double, 8, 3>(4) < 1e-13);
+		REQUIRE(luResidual<float, 5, 2>(5) < 1e-5f);
+		// Loops
+		REQUIRE(luResidual<double, 9, 1>(6) < 1e-12);
+		REQUIRE(luResidual<double, 33, 5>(7) < 1e-12);
+		REQUIRE(luResidual<double, 63, 2>(8) < 1e-12);
+		// Blocked
+		REQUIRE(luResidual<double, 64, 1>(9) < 1e-12);
+		REQUIRE(luResidual<double, 100, 40>(10) < 1e-12);
+		REQUIRE(luResidual<double, 130, 3, HeapStorage<64>>(11) < 1e-12);
+		REQUIRE(luResidual<float, 70, 2>(12) < 1e-4f);
+		// Padded storage
+		REQUIRE(luResidual<float, 7, 2, AlignedStorage<16, true>>(13) < 1e-5f);
+		REQUIRE(luResidual<double, 65, 2, AlignedStorage<32, true>>(14) < 1e-12);
+	}
+
+	SECTION("Testing vector right-hand sides")
+	{
+		Matrix<double, 5, 5> a;
+		pivotingMatrix(a, 1);
+		const ColumnVector<double, 5> b{ 1.0, -2.0, 3.0, 0.5, 4.0 };
+		const LUDecomposition<double, 5> lu(a);
+		const ColumnVector<double, 5> x = lu.solve(b);
+		REQUIRE(ColumnVector<double, 5>(a * x - b).norm() < 1e-14);
+
+		Matrix<double, 3, 3> c;
+		pivotingMatrix(c, 2);
+		const Vector3<double> y = LUDecomposition<double, 3>(c).solve(Vector3<double>(1.0, 2.0, 3.0));
+		REQUIRE(Vector3<double>(c * y - Vector3<double>(1.0, 2.0, 3.0)).norm() < 1e-14);
+	}
+
+	SECTION("Testing the factors")
+	{
+		const Matrix<double, 2, 2> a(0.0, 1.0, 2.0, 3.0);
+		const LUDecomposition<double, 2> lu(a);
+		REQUIRE(lu.pivots()[0] == 1);
+		REQUIRE(lu.matrixLU()(0, 0) == 1.0);
+		REQUIRE(lu.matrixLU()(0, 1) == 3.0);
+		REQUIRE(lu.matrixLU()(1, 0) == 0.0);
+		REQUIRE(lu.matrixLU()(1, 1) == 2.0);
+		REQUIRE(lu.determinant() == -2.0);
+
+		// The blocked factorization computes the same factors as the unblocked one
+		typedef Matrix<double, 70, 70> mat70;
+		std::unique_ptr<mat70> b(new mat70), unblocked(new mat70);
+		pivotingMatrix(*b, 3);
+		*unblocked = *b;
+		std::array<size_t, 70> pivots;
+		REQUIRE(detail::luPanel(70, 70, unblocked->data(), 70, pivots.data()));
+		const LUDecomposition<double, 70> blocked(*b);
+		REQUIRE(blocked.pivots() == pivots);
+		REQUIRE(maxDifference(blocked.matrixLU(), *unblocked) < 1e-12);
+	}
+
+	SECTION("Testing determinant() and inverse()")
+	{
+		Matrix<double, 3, 3> a;
+		Matrix<double, 4, 4> b;
+		pivotingMatrix(a, 1);
+		pivotingMatrix(b, 2);
+		REQUIRE(LUDecomposition<double, 3>(a).determinant() == Approx(a.determinant()));
+		REQUIRE(LUDecomposition<double, 4>(b).determinant() == Approx(b.determinant()));
+		REQUIRE(maxDifference(LUDecomposition<double, 4>(b).inverse(), b.inverse()) < 1e-14);
+
+		const Matrix<double, 12, 12> c = testMatrix<double, 12>(3);
+		REQUIRE(maxDifference(Matrix<double, 12, 12>(c * LUDecomposition<double, 12>(c).inverse()), Matrix<double, 12, 12>::createIdentity()) < 1e-14);
+	}
+
+	SECTION("Testing singular matrices")
+	{
+		Matrix<double, 3, 3> a;
+		pivotingMatrix(a, 1);
+		REQUIRE(!LUDecomposition<double, 3>(a).isSingular());
+		for (size_t j = 0; j < 3; j++) a(2, j) = 2.0 * a(0, j);
+		REQUIRE(LUDecomposition<double, 3>(a).isSingular());
+		REQUIRE(LUDecomposition<double, 3>(a).determinant() == 0.0);
+
+		std::unique_ptr<Matrix<double, 80, 80>> b(new Matrix<double, 80, 80>);
+		pivotingMatrix(*b, 2);
+		REQUIRE(!LUDecomposition<double, 80>(*b).isSingular());
+		for (size_t i = 0; i < 80; i++) (*b)(i, 40) = 0.0;
+		REQUIRE(LUDecomposition<double, 80>(*b).isSingular());
+		REQUIRE(LUDecomposition<double, 12>(Matrix<double, 12, 12>()).isSingular());
+	}
+}
+
+//! Sets the lower triangle of mat to a symmetric positive definite matrix and the upper triangle to NaN
+template<typename T, size_t n, typename Storage>
+static void spdLowerTriangle(Matrix<T, n, n, Storage>& mat, size_t seed)
+{
+	for (size_t j = 0; j < n; j++) {
+		for (size_t i = 0; i < j; i++) mat(i, j) = std::numeric_limits<T>::quiet_NaN();
+		for (size_t i = j; i < n; i++) mat(i, j) = T(int((3 * i * j + i + j + 5 * seed) % 13) - 6) / T(13);
+		mat(j, j) += T(n);
+	}
+}
+
+//! Solves a system with k right-hand sides by CholeskyDecomposition and returns the largest entry of the residual
+template<typename T, size_t n, size_t k, typename Storage = DenseStorage>
+static T choleskyResidual(size_t seed)
+{
+	const auto a = allocateAligned<Matrix<T, n, n, Storage>>();
+	HeapMatrix<T, n, k> b;
+	spdLowerTriangle(*a, seed);
+	rightHandSides(b, seed);
+
+	const CholeskyDecomposition<T, n, Storage> cholesky(*a);
+	if (!cholesky.isPositiveDefinite()) return std::numeric_limits<T>::infinity();
+	const HeapMatrix<T, n, k> x(cholesky.solve(b));
+
+	// Mirror the lower triangle for the residual of the symmetric matrix
+	for (size_t j = 0; j < n; j++) {
+		for (size_t i = 0; i < j; i++) (*a)(i, j) = (*a)(j, i);
+	}
+	return maxResidual(*a, x, b);
+}
+
+TEST_CASE("Testing Cholesky decomposition")
+{
+	SECTION("Testing solve()")
+	{
+		// The upper triangles are NaN, so every residual also checks that only the lower triangle is read
+		// Unrolled
+		REQUIRE(choleskyResidual<double, 1, 1>(1) < 1e-14);
+		REQUIRE(choleskyResidual<double, 3, 2>(2) < 1e-13);
+		REQUIRE(choleskyResidual<double, 6, 1>(3) < 1e-13);
+		REQUIRE(choleskyResidual<double, 12, 4>(4) < 1e-13);
+		REQUIRE(choleskyResidual<float, 9, 2>(5) < 1e-5f);
+		// Loops
+		REQUIRE(choleskyResidual<double, 13, 1>(6) < 1e-12);
+		REQUIRE(choleskyResidual<double, 40, 3>(7) < 1e-12);
+		// Blocked
+		REQUIRE(choleskyResidual<double, 64, 2>(8) < 1e-12);
+		REQUIRE(choleskyResidual<double, 100, 33>(9) < 1e-12);
+		REQUIRE(choleskyResidual<double, 150, 1, HeapStorage<64>>(10) < 1e-12);
+		REQUIRE(choleskyResidual<float, 70, 2>(11) < 1e-4f);
+		// Padded storage
+		REQUIRE(choleskyResidual<float, 5, 3, AlignedStorage<16, true>>(12) < 1e-5f);
+		REQUIRE(choleskyResidual<double, 67, 2, AlignedStorage<32, true>>(13) < 1e-12);
+	}
+
+	SECTION("Testing the factor")
+	{
+		const Matrix<double, 2, 2> a(4.0, 2.0, 2.0, 5.0);
+		const CholeskyDecomposition<double, 2> cholesky(a);
+		REQUIRE(cholesky.isPositiveDefinite());
+		REQUIRE(cholesky.matrixL()(0, 0) == 2.0);
+		REQUIRE(cholesky.matrixL()(1, 0) == 1.0);
+		REQUIRE(cholesky.matrixL()(1, 1) == 2.0);
+		REQUIRE(cholesky.matrixL()(0, 1) == 2.0);
+		REQUIRE(cholesky.determinant() == Approx(a.determinant()));
+
+		// The blocked factorization computes the same factor as the unblocked one
+		typedef Matrix<double, 90, 90> mat90;
+		std::unique_ptr<mat90> b(new mat90), unblocked(new mat90);
+		spdLowerTriangle(*b, 3);
+		*unblocked = *b;
+		REQUIRE(detail::choleskyUnblocked(90, unblocked->data(), 90));
+		const CholeskyDecomposition<double, 90> blocked(*b);
+		for (size_t j = 0; j < 90; j++) {
+			for (size_t i = j; i < 90; i++) REQUIRE(std::abs(blocked.matrixL()(i, j) - (*unblocked)(i, j)) < 1e-13);
+		}
+	}
+
+	SECTION("Testing vector right-hand sides")
+	{
+		Matrix<double, 4, 4> a;
+		spdLowerTriangle(a, 1);
+		for (size_t j = 0; j < 4; j++) {
+			for (size_t i = 0; i < j; i++) a(i, j) = a(j, i);
+		}
+		const ColumnVector<double, 4> b{ 1.0, -2.0, 3.0, 0.5 };
+		const ColumnVector<double, 4> x = CholeskyDecomposition<double, 4>(a).solve(b);
+		REQUIRE(ColumnVector<double, 4>(a * x - b).norm() < 1e-14);
+		REQUIRE(ColumnVector<double, 4>(x - LUDecomposition<double, 4>(a).solve(b)).norm() < 1e-14);
+	}
+
+	SECTION("Testing matrices that are not positive definite")
+	{
+		const Matrix<double, 2, 2> a(1.0, 2.0, 2.0, 1.0);
+		REQUIRE(!CholeskyDecomposition<double, 2>(a).isPositiveDefinite());
+		REQUIRE(!CholeskyDecomposition<double, 20>(Matrix<double, 20, 20>()).isPositiveDefinite());
+
+		std::unique_ptr<Matrix<double, 80, 80>> b(new Matrix<double, 80, 80>);
+		spdLowerTriangle(*b, 2);
+		(*b)(75, 75) = -1.0;
+		REQUIRE(!CholeskyDecomposition<double, 80>(*b).isPositiveDefinite());
+	}
+}
+
+//! Fills the matrix with pseudo-random entries in [-1, 1)
+template<typename T, size_t m, size_t n, typename Storage>
+static void randomMatrix(Matrix<T, m, n, Storage>& mat, size_t seed)
+{
+	for (size_t j = 0; j < n; j++) {
+		for (size_t i = 0; i < m; i++) {
+			uint32_t hash = uint32_t(i * n + j + 7919 * seed);
+			hash = (hash ^ (hash >> 16)) * 0x45d9f3bu;
+			hash = (hash ^ (hash >> 16)) * 0x45d9f3bu;
+			hash ^= hash >> 16;
+			mat(i, j) = T(hash >> 8) / T(1 << 23) - T(1);
+		}
+	}
+}
+
+//! Solves a least squares problem by leastSquares() and returns the largest entry of A^T*A*X - A^T*B relative to m
+template<typename T, size_t m, size_t n, size_t k, typename Storage = DenseStorage>
+static T qrNormalResidual(size_t seed)
+{
+	const auto a = allocateAligned<Matrix<T, m, n, Storage>>();
+	HeapMatrix<T, m, k> b;
+	randomMatrix(*a, seed);
+	rightHandSides(b, seed);
+
+	// The least squares solution solves the normal equations
+	const HeapMatrix<T, n, k> x(leastSquares(*a, b));
+	const HeapMatrix<T, n, n> normal(a->transposed() * (*a));
+	const HeapMatrix<T, n, k> rhs(a->transposed() * b);
+	return maxResidual(normal, x, rhs) / T(m);
+}
+
+TEST_CASE("Testing Householder QR decomposition")
+{
+	SECTION("Testing least squares solutions")
+	{
+		REQUIRE(qrNormalResidual<double, 3, 2, 1>(1) < 1e-14);
+		REQUIRE(qrNormalResidual<double, 20, 6, 2>(2) < 1e-14);
+		REQUIRE(qrNormalResidual<float, 50, 4, 1>(3) < 1e-5f);
+		REQUIRE(qrNormalResidual<double, 33, 33, 3>(4) < 1e-13);
+		// Blocked
+		REQUIRE(qrNormalResidual<double, 100, 64, 1>(5) < 1e-13);
+		REQUIRE(qrNormalResidual<double, 150, 70, 40>(6) < 1e-13);
+		REQUIRE(qrNormalResidual<double, 300, 100, 2, HeapStorage<64>>(7) < 1e-13);
+		// Padded storage
+		REQUIRE(qrNormalResidual<double, 13, 5, 2, AlignedStorage<32, true>>(8) < 1e-14);
+	}
+
+	SECTION("Testing tall polynomial fits")
+	{
+		const size_t m = 10000;
+		typedef Matrix<double, m, 6, HeapStorage<64>> DesignMatrix;
+		DesignMatrix a;
+		Matrix<double, m, 1, HeapStorage<64>> b;
+		const double coefficients[6] = { 1.0, -2.0, 3.0, 0.5, -1.0, 2.0 };
+		for (size_t i = 0; i < m; i++) {
+			const double t = double(i) / double(m - 1);
+			double power = 1.0;
+			b[i] = 0.0;
+			for (size_t j = 0; j < 6; j++) {
+				a(i, j) = power;
+				b[i] += coefficients[j] * power;
+				power *= t;
+			}
+		}
+
+		const HouseholderQR<double, m, 6, HeapStorage<64>> qr(a);
+		REQUIRE(qr.hasFullRank());
+		const Matrix<double, 6, 1, HeapStorage<64>> x = qr.solve(b);
+		for (size_t j = 0; j < 6; j++) REQUIRE(std::abs(x[j] - coefficients[j]) < 1e-9);
+
+		const Matrix<double, 6, 1, HeapStorage<64>> y = leastSquares(DesignMatrix(a), b);
+		for (size_t j = 0; j < 6; j++) REQUIRE(y[j] == x[j]);
+	}
+
+	SECTION("Testing the factors")
+	{
+		// Blocked and unblocked factorization
+		std::unique_ptr<Matrix<double, 100, 70>> a(new Matrix<double, 100, 70>);
+		randomMatrix(*a, 9);
+		std::unique_ptr<Matrix<double, 100, 70>> unblocked(new Matrix<double, 100, 70>(*a));
+		double tau[70];
+		detail::qrPanel(100, 70, unblocked->data(), 100, tau);
+
+		const HouseholderQR<double, 100, 70> blocked(*a);
+		for (size_t j = 0; j < 70; j++) {
+			REQUIRE(std::abs(blocked.tau()[j] - tau[j]) < 1e-13);
+			for (size_t i = 0; i < 100; i++) REQUIRE(std::abs(blocked.matrixQR()(i, j) - (*unblocked)(i, j)) < 1e-12);
+		}
+
+		// Q^T*A = R with blocked and unblocked application of Q^T
+		std::unique_ptr<Matrix<double, 100, 70>> r(new Matrix<double, 100, 70>(*a));
+		blocked.applyQTransposed(*r);
+		const Matrix<double, 70, 70> upper = blocked.matrixR();
+		for (size_t j = 0; j < 70; j++) {
+			for (size_t i = 0; i < 100; i++) {
+				const double expected = (i < 70) ? upper(i, j) : 0.0;
+				REQUIRE(std::abs((*r)(i, j) - expected) < 1e-12);
+			}
+		}
+		Matrix<double, 100, 1> column;
+		for (size_t i = 0; i < 100; i++) column[i] = (*a)(i, 3);
+		blocked.applyQTransposed(column);
+		for (size_t i = 0; i < 100; i++) REQUIRE(std::abs(column[i] - (*r)(i, 3)) < 1e-12);
+
+		// Square matrices
+		Matrix<double, 4, 4> b;
+		pivotingMatrix(b, 1);
+		const ColumnVector<double, 4> rhs{ 1.0, -2.0, 3.0, 0.5 };
+		const ColumnVector<double, 4> x = HouseholderQR<double, 4, 4>(b).solve(rhs);
+		REQUIRE(ColumnVector<double, 4>(x - LUDecomposition<double, 4>(b).solve(rhs)).norm() < 1e-14);
+	}
+
+	SECTION("Testing rank deficient matrices")
+	{
+		Matrix<double, 5, 3> a;
+		randomMatrix(a, 10);
+		REQUIRE(HouseholderQR<double, 5, 3>(a).hasFullRank());
+		for (size_t i = 0; i < 5; i++) a(i, 1) = 0.0;
+		REQUIRE(!HouseholderQR<double, 5, 3>(a).hasFullRank());
+	}
+}
+
+//! Returns the largest entry of R*diag(eigenvalues)*R^T - S relative to the largest entry of S
+template<typename T>
+static T eigenResidual(const Matrix<T, 3, 3>& s, const Vector3<T>& eigenvalues, const Quaternion<T>& rotation)
+{
+	const Matrix<T, 3, 3> r = rotation.toMatrix();
+	T scale = T(0), residual = T(0);
+	for (size_t i = 0; i < 9; i++) scale = std::max(scale, std::abs(s[i]));
+	for (size_t i = 0; i < 3; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			T sum = T(0);
+			for (size_t k = 0; k < 3; k++) sum += r(i, k) * eigenvalues[k] * r(j, k);
+			residual = std::max(residual, std::abs(sum - s(i, j)));
+		}
+	}
+	return (scale > T(0)) ? residual / scale : residual;
+}
+
+template<typename T>
+static T eigenResidual(const Matrix<T, 3, 3>& s, const SymmetricEigenDecomposition3<T>& eigen)
+{
+	return eigenResidual(s, eigen.eigenvalues(), eigen.rotation());
+}
+
+//! Fills the matrix with a symmetric matrix of pseudo-random entries, every fourth matrix has a double eigenvalue
+template<typename T>
+static void randomSymmetricMatrix(Matrix<T, 3, 3>& s, size_t seed)
+{
+	randomMatrix(s, seed);
+	for (size_t j = 0; j < 3; j++) {
+		for (size_t i = 0; i < j; i++) s(i, j) = s(j, i);
+	}
+	if (seed % 4 == 0) {
+		// Covariance of points on a circle in a rotated plane
+		const Matrix<T, 3, 3> r = Quaternion<T>::fromAxisAndAngle(Vector3<T>(s(0, 0), s(1, 0), T(1)).normalized(), s(2, 0)).toMatrix();
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) s(i, j) = r(i, 0) * r(j, 0) + r(i, 1) * r(j, 1);
+		}
+	}
+}
+
+template<typename T>
+static void checkSymmetricEigenDecompositions(T tolerance)
+{
+	for (size_t seed = 0; seed < 200; seed++) {
+		Matrix<T, 3, 3> s;
+		randomSymmetricMatrix(s, seed);
+		const SymmetricEigenDecomposition3<T> eigen(s);
+		REQUIRE(eigenResidual(s, eigen) < tolerance);
+		REQUIRE(eigen.eigenvalues()[0] >= eigen.eigenvalues()[1]);
+		REQUIRE(eigen.eigenvalues()[1] >= eigen.eigenvalues()[2]);
+
+		const Matrix<T, 3, 3> r = eigen.eigenvectors();
+		const Matrix<T, 3, 3> identity = r.transposed() * r;
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) REQUIRE(std::abs(identity(i, j) - T(i == j ? 1 : 0)) < tolerance);
+		}
+	}
+}
+
+TEST_CASE("Testing symmetric eigen decomposition")
+{
+	SECTION("Testing decompositions")
+	{
+		checkSymmetricEigenDecompositions<float>(1e-5f);
+		checkSymmetricEigenDecompositions<double>(1e-13);
+	}
+
+	SECTION("Testing special matrices")
+	{
+		const Matrix<double, 3, 3> diagonal(1.0, 0.0, 0.0, 0.0, 3.0, 0.0, 0.0, 0.0, 2.0);
+		const SymmetricEigenDecomposition3<double> eigen(diagonal);
+		REQUIRE(eigenResidual(diagonal, eigen) < 1e-15);
+		REQUIRE(eigen.eigenvalues()[0] == Approx(3.0));
+		REQUIRE(eigen.eigenvalues()[1] == Approx(2.0));
+		REQUIRE(eigen.eigenvalues()[2] == Approx(1.0));
+		REQUIRE(std::abs(eigen.eigenvectors()(1, 0)) == Approx(1.0));
+
+		const Matrix<float, 3, 3> zero;
+		const SymmetricEigenDecomposition3<float> zeroEigen(zero);
+		REQUIRE(zeroEigen.eigenvalues().norm() == 0.0f);
+		REQUIRE(std::abs(Quaternion<float>::dotProduct(zeroEigen.rotation(), zeroEigen.rotation()) - 1.0f) < 1e-6f);
+
+		// Only the lower triangle is read
+		Matrix<double, 3, 3> s;
+		randomSymmetricMatrix(s, 1);
+		Matrix<double, 3, 3> lower(s);
+		lower(0, 1) = lower(0, 2) = lower(1, 2) = std::numeric_limits<double>::quiet_NaN();
+		REQUIRE(SymmetricEigenDecomposition3<double>(lower).eigenvalues() == SymmetricEigenDecomposition3<double>(s).eigenvalues());
+	}
+
+	SECTION("Testing batched decompositions")
+	{
+		const size_t count = 37;
+		std::vector<float> streams(13 * count);
+		const float* tensors[6];
+		float* eigenvalues[3];
+		float* rotations[4];
+		for (size_t k = 0; k < 6; k++) tensors[k] = streams.data() + k * count;
+		for (size_t k = 0; k < 3; k++) eigenvalues[k] = streams.data() + (6 + k) * count;
+		for (size_t k = 0; k < 4; k++) rotations[k] = streams.data() + (9 + k) * count;
+
+		std::vector<Matrix<float, 3, 3>> matrices(count);
+		for (size_t i = 0; i < count; i++) {
+			randomSymmetricMatrix(matrices[i], i + 5);
+			const size_t entries[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 1, 0 }, { 2, 0 }, { 2, 1 } };
+			for (size_t k = 0; k < 6; k++) streams[k * count + i] = matrices[i](entries[k][0], entries[k][1]);
+		}
+
+		// The eigenvectors of double eigenvalues may differ if the compiler contracts the scalar code to fused multiply-adds
+		SymmetricEigenDecomposition3<float>::compute(tensors, eigenvalues, rotations, count);
+		for (size_t i = 0; i < count; i++) {
+			const SymmetricEigenDecomposition3<float> eigen(matrices[i]);
+			const Vector3<float> values(eigenvalues[0][i], eigenvalues[1][i], eigenvalues[2][i]);
+			const Quaternion<float> rotation(rotations[0][i], rotations[1][i], rotations[2][i], rotations[3][i]);
+			CHECK((values - eigen.eigenvalues()).norm() <= 1e-6f);
+			CHECK(eigenResidual(matrices[i], values, rotation) < 1e-5f);
+		}
+	}
+}
+
+//! Returns the largest entry of U*diag(sigma)*V^T - A relative to the largest entry of A
+template<typename T>
+static T svdResidual(const Matrix<T, 3, 3>& a, const Quaternion<T>& u, const Vector3<T>& sigma, const Quaternion<T>& v)
+{
+	const Matrix<T, 3, 3> mu = u.toMatrix(), mv = v.toMatrix();
+	T scale = T(0), residual = T(0);
+	for (size_t i = 0; i < 9; i++) scale = std::max(scale, std::abs(a[i]));
+	for (size_t i = 0; i < 3; i++) {
+		for (size_t j = 0; j < 3; j++) {
+			T sum = T(0);
+			for (size_t k = 0; k < 3; k++) sum += mu(i, k) * sigma[k] * mv(j, k);
+			residual = std::max(residual, std::abs(sum - a(i, j)));
+		}
+	}
+	return (scale > T(0)) ? residual / scale : residual;
+}
+
+//! Fills the matrix with pseudo-random entries, every third matrix has rank two and every fifth matrix rank one
+template<typename T>
+static void randomSvdMatrix(Matrix<T, 3, 3>& a, size_t seed)
+{
+	randomMatrix(a, seed);
+	for (size_t i = 0; i < 3; i++) {
+		if (seed % 3 == 0) a(i, 2) = T(2) * a(i, 0) - a(i, 1);
+		if (seed % 5 == 0) a(i, 1) = a(i, 2) = T(-0.5) * a(i, 0);
+	}
+}
+
+template<typename T>
+static void checkSingularValueDecompositions(T tolerance)
+{
+	for (size_t seed = 0; seed < 200; seed++) {
+		Matrix<T, 3, 3> a;
+		randomSvdMatrix(a, seed);
+		const SingularValueDecomposition3<T> svd(a);
+		const Vector3<T>& sigma = svd.singularValues();
+		REQUIRE(svdResidual(a, svd.rotationU(), sigma, svd.rotationV()) < tolerance);
+		REQUIRE(sigma[0] >= sigma[1]);
+		REQUIRE(sigma[1] >= std::abs(sigma[2]) - tolerance);
+		REQUIRE(std::abs(Quaternion<T>::dotProduct(svd.rotationU(), svd.rotationU()) - T(1)) < tolerance);
+		REQUIRE(std::abs(Quaternion<T>::dotProduct(svd.rotationV(), svd.rotationV()) - T(1)) < tolerance);
+
+		const PolarDecomposition3<T> polar(a);
+		const Matrix<T, 3, 3> r = polar.matrixR();
+		const Matrix<T, 3, 3> product = r * polar.matrixS();
+		T scale = T(0);
+		for (size_t i = 0; i < 9; i++) scale = std::max(scale, std::abs(a[i]));
+		for (size_t i = 0; i < 9; i++) REQUIRE(std::abs(product[i] - a[i]) < tolerance * scale);
+		const Matrix<T, 3, 3> identity = r.transposed() * r;
+		for (size_t i = 0; i < 3; i++) {
+			for (size_t j = 0; j < 3; j++) REQUIRE(std::abs(identity(i, j) - T(i == j ? 1 : 0)) < tolerance);
+		}
+	}
+}
+
+TEST_CASE("Testing singular value and polar decomposition")
+{
+	SECTION("Testing decompositions")
+	{
+		checkSingularValueDecompositions<float>(1e-5f);
+		checkSingularValueDecompositions<double>(1e-13);
+	}
+
+	SECTION("Testing special matrices")
+	{
+		// Reflections keep U and V rotations and have a negative singular value
+		const Matrix<double, 3, 3> reflection(2.0, 0.0, 0.0, 0.0, -3.0, 0.0, 0.0, 0.0, 1.0);
+		const SingularValueDecomposition3<double> svd(reflection);
+		REQUIRE(svdResidual(reflection, svd.rotationU(), svd.singularValues(), svd.rotationV()) < 1e-15);
+		REQUIRE(svd.singularValues()[0] == Approx(3.0));
+		REQUIRE(svd.singularValues()[1] == Approx(2.0));
+		REQUIRE(svd.singularValues()[2] == Approx(-1.0));
+
+		const Matrix<double, 3, 3> rotation = Quaternion<double>::fromAxisAndAngle(Vector3<double>(1.0, 2.0, 2.0).normalized(), 0.7).toMatrix();
+		const PolarDecomposition3<double> polar(rotation);
+		const Matrix<double, 3, 3> identity = Matrix<double, 3, 3>::createIdentity();
+		for (size_t i = 0; i < 9; i++) {
+			REQUIRE(std::abs(polar.matrixR()[i] - rotation[i]) < 1e-14);
+			REQUIRE(std::abs(polar.matrixS()[i] - identity[i]) < 1e-14);
+		}
+
+		const Matrix<float, 3, 3> zero;
+		const SingularValueDecomposition3<float> zeroSvd(zero);
+		REQUIRE(zeroSvd.singularValues().norm() == 0.0f);
+		REQUIRE(std::abs(Quaternion<float>::dotProduct(zeroSvd.rotationU(), zeroSvd.rotationU()) - 1.0f) < 1e-6f);
+	}
+
+	SECTION("Testing batched decompositions")
+	{
+		const size_t count = 37;
+		std::vector<float> streams(20 * count);
+		const float* matrices[9];
+		float* out[11];
+		for (size_t k = 0; k < 9; k++) matrices[k] = streams.data() + k * count;
+		for (size_t k = 0; k < 11; k++) out[k] = streams.data() + (9 + k) * count;
+
+		std::vector<Matrix<float, 3, 3>> inputs(count);
+		for (size_t i = 0; i < count; i++) {
+			randomSvdMatrix(inputs[i], i + 7);
+			for (size_t k = 0; k < 9; k++) streams[k * count + i] = inputs[i][k];
+		}
+
+		SingularValueDecomposition3<float>::compute(matrices, out, out + 4, out + 7, count);
+		for (size_t i = 0; i < count; i++) {
+			const SingularValueDecomposition3<float> svd(inputs[i]);
+			const Quaternion<float> u(out[0][i], out[1][i], out[2][i], out[3][i]);
+			const Vector3<float> sigma(out[4][i], out[5][i], out[6][i]);
+			const Quaternion<float> v(out[7][i], out[8][i], out[9][i], out[10][i]);
+			CHECK((sigma - svd.singularValues()).norm() <= 1e-5f);
+			CHECK(svdResidual(inputs[i], u, sigma, v) < 1e-5f);
+		}
+
+		PolarDecomposition3<float>::compute(matrices, out, out + 4, count);
+		for (size_t i = 0; i < count; i++) {
+			const Matrix<float, 3, 3> r = Quaternion<float>(out[0][i], out[1][i], out[2][i], out[3][i]).toMatrix();
+			const float* s = out[4];
+			const Matrix<float, 3, 3> stretch = PolarDecomposition3<float>(inputs[i]).matrixS();
+			const size_t entries[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 0, 1 }, { 0, 2 }, { 1, 2 } };
+			for (size_t k = 0; k < 6; k++) CHECK(std::abs(s[k * count + i] - stretch(entries[k][0], entries[k][1])) < 1e-5f);
+			const Matrix<float, 3, 3> product = r * stretch;
+			for (size_t k = 0; k < 9; k++) CHECK(std::abs(product[k] - inputs[i][k]) < 1e-5f);
+		}
+	}
+}
+
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+template<typename T>
+static bool checkKernelTable(simd::InstructionSet isa)
+{
+	const detail::KernelTable<T> kernels = detail::makeKernelTable<T>(isa);
+	const detail::KernelTable<T> reference = detail::makeKernelTable<T>(simd::InstructionSet::Scalar);
+	const T tolerance = T(100) * std::numeric_limits<T>::epsilon();
+	bool ok = (kernels.isa == isa);
+
+	const size_t n = 131;
+	std::vector<T> a(n), b(n), x(n), y(n);
+	for (size_t i = 0; i < n; i++) {
+		a[i] = T(i % 17) * T(0.25) - T(1);
+		b[i] = T(2) - T(i % 13) * T(0.5);
+	}
+
+	x = a; y = a;
+	kernels.add(x.data(), b.data(), n);
+	reference.add(y.data(), b.data(), n);
+	ok &= (x == y);
+
+	x = a; y = a;
+	kernels.subtract(x.data(), b.data(), n);
+	reference.subtract(y.data(), b.data(), n);
+	ok &= (x == y);
+
+	x = a; y = a;
+	kernels.scale(x.data(), T(1.5), n);
+	reference.scale(y.data(), T(1.5), n);
+	ok &= (x == y);
+
+	kernels.fill(x.data(), T(3), n);
+	reference.fill(y.data(), T(3), n);
+	ok &= (x == y);
+
+	ok &= kernels.equal(a.data(), a.data(), n);
+	x = a;
+	x[n - 1] += T(1);
+	ok &= !kernels.equal(a.data(), x.data(), n);
+
+	const T dot = kernels.dot(a.data(), b.data(), n);
+	const T dotReference = reference.dot(a.data(), b.data(), n);
+	ok &= (std::abs(dot - dotReference) <= tolerance * n);
+
+	const T mat[9] = { T(0.5), T(-1), T(2), T(1.5), T(0.25), T(-3), T(1), T(2), T(-0.5) };
+	x = a; y = a;
+	kernels.transform3(mat, x.data(), x.data(), n / 3);
+	reference.transform3(mat, y.data(), y.data(), n / 3);
+	for (size_t i = 0; i < n; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance * 8);
+
+	// Rotations by a stream of (unnormalized) quaternions taken from b
+	x = a; y = a;
+	kernels.quaternionRotate3(b.data(), x.data(), x.data(), n / 4);
+	reference.quaternionRotate3(b.data(), y.data(), y.data(), n / 4);
+	for (size_t i = 0; i < n; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance * 64);
+
+	// Conversions between rotation matrices and quaternions, the matrices are computed from normalized quaternions
+	const size_t rotationCount = n / 9;
+	std::vector<T> quats(4*rotationCount), mats(9*rotationCount), matsReference(9*rotationCount);
+	for (size_t i = 0; i < rotationCount; i++) {
+		T normSquared = T(0);
+		for (size_t k = 0; k < 4; k++) normSquared += b[4*i + k]*b[4*i + k];
+		for (size_t k = 0; k < 4; k++) quats[4*i + k] = b[4*i + k]/std::sqrt(normSquared);
+	}
+	kernels.quaternionToMatrix(quats.data(), mats.data(), rotationCount);
+	reference.quaternionToMatrix(quats.data(), matsReference.data(), rotationCount);
+	for (size_t i = 0; i < mats.size(); i++) ok &= (std::abs(mats[i] - matsReference[i]) <= tolerance * 8);
+
+	std::vector<T> quatsConverted(4*rotationCount), quatsReference(4*rotationCount);
+	kernels.matrixToQuaternion(matsReference.data(), quatsConverted.data(), rotationCount);
+	reference.matrixToQuaternion(matsReference.data(), quatsReference.data(), rotationCount);
+	for (size_t i = 0; i < quats.size(); i++) ok &= (std::abs(quatsConverted[i] - quatsReference[i]) <= tolerance * 8);
+
+	// Inversion of well conditioned matrices
+	for (size_t dim = 2; dim <= 4; dim++) {
+		const size_t matrixCount = n / (dim*dim);
+		std::vector<T> mats(dim*dim*matrixCount);
+		for (size_t i = 0; i < mats.size(); i++) mats[i] = a[i];
+		for (size_t i = 0; i < matrixCount; i++) {
+			for (size_t k = 0; k < dim; k++) mats[dim*dim*i + k*(dim + 1)] += T(4);
+		}
+		const detail::InverseFunction<T> invert = (dim == 2) ? kernels.invert2 : ((dim == 3) ? kernels.invert3 : kernels.invert4);
+		const detail::InverseFunction<T> invertReference = (dim == 2) ? reference.invert2 : ((dim == 3) ? reference.invert3 : reference.invert4);
+		x = mats; y = mats;
+		invert(x.data(), x.data(), matrixCount);
+		invertReference(y.data(), y.data(), matrixCount);
+		for (size_t i = 0; i < mats.size(); i++) ok &= (std::abs(x[i] - y[i]) <= tolerance);
+	}
+	x.resize(n);
+	y.resize(n);
+
+	// One register tile with a partial tile in the lower right corner
+	const size_t MR = detail::GemmBlocking<T>::MR;
+	const size_t NR = detail::GemmBlocking<T>::NR;
+	const size_t kc = 7;
+	std::vector<T> packedA(MR*kc), packedB(NR*kc), c(MR*NR, T(1)), cReference(MR*NR, T(1));
+	for (size_t i = 0; i < packedA.size(); i++) packedA[i] = a[i % n];
+	for (size_t i = 0; i < packedB.size(); i++) packedB[i] = b[i % n];
+	kernels.gemmMicroKernel(kc, packedA.data(), packedB.data(), c.data(), MR, MR, NR, true);
+	reference.gemmMicroKernel(kc, packedA.data(), packedB.data(), cReference.data(), MR, MR, NR, true);
+	kernels.gemmMicroKernel(kc, packedA.data(), packedB.data(), c.data(), MR, MR - 1, NR - 1, false);
+	reference.gemmMicroKernel(kc, packedA.data(), packedB.data(), cReference.data(), MR, MR - 1, NR - 1, false);
+	for (size_t i = 0; i < c.size(); i++) ok &= (std::abs(c[i] - cReference[i]) <= tolerance * 8);
+
+	// Structure-of-arrays kernels on n / 3 vectors with the coordinates in a and b
+	const size_t count = n / 3;
+	const T* soaA[3] = { a.data(), a.data() + count, a.data() + 2*count };
+	const T* soaB[3] = { b.data(), b.data() + count, b.data() + 2*count };
+	T* soaX[3] = { x.data(), x.data() + count, x.data() + 2*count };
+	T* soaY[3] = { y.data(), y.data() + count, y.data() + 2*count };
+
+	kernels.dot3(soaA, soaB, x.data(), count);
+	reference.dot3(soaA, soaB, y.data(), count);
+	for (size_t i = 0; i < count; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance * 8);
+
+	kernels.normSquared3(soaA, x.data(), count);
+	reference.normSquared3(soaA, y.data(), count);
+	for (size_t i = 0; i < count; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance * 8);
+
+	kernels.cross3(soaA, soaB, soaX, count);
+	reference.cross3(soaA, soaB, soaY, count);
+	for (size_t i = 0; i < 3*count; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance * 8);
+
+	// In place, the vectors of b have no zero coordinates
+	x = b; y = b;
+	kernels.normalize3(soaX, soaX, count);
+	reference.normalize3(soaY, soaY, count);
+	for (size_t i = 0; i < 3*count; i++) ok &= (std::abs(x[i] - y[i]) <= tolerance);
+
+	// Eigen decompositions of n / 6 symmetric matrices with the entries in a
+	const size_t tensorCount = n / 6;
+	std::vector<T> eigen(7*tensorCount), eigenReference(7*tensorCount);
+	const T* tensors[6];
+	T* eigenOut[7];
+	T* eigenReferenceOut[7];
+	for (size_t k = 0; k < 6; k++) tensors[k] = a.data() + k*tensorCount;
+	for (size_t k = 0; k < 7; k++) {
+		eigenOut[k] = eigen.data() + k*tensorCount;
+		eigenReferenceOut[k] = eigenReference.data() + k*tensorCount;
+	}
+	kernels.symmetricEigen3(tensors, eigenOut, eigenOut + 3, tensorCount);
+	reference.symmetricEigen3(tensors, eigenReferenceOut, eigenReferenceOut + 3, tensorCount);
+	for (size_t i = 0; i < eigen.size(); i++) ok &= (std::abs(eigen[i] - eigenReference[i]) <= tolerance);
+
+	// Singular values and polar decompositions of n / 9 matrices with the entries in a (R is not unique for singular matrices)
+	const size_t matrixCount = n / 9;
+	std::vector<T> svd(11*matrixCount), svdReference(11*matrixCount);
+	const T* matrices[9];
+	T* svdOut[11];
+	T* svdReferenceOut[11];
+	for (size_t k = 0; k < 9; k++) matrices[k] = a.data() + k*matrixCount;
+	for (size_t k = 0; k < 11; k++) {
+		svdOut[k] = svd.data() + k*matrixCount;
+		svdReferenceOut[k] = svdReference.data() + k*matrixCount;
+	}
+	kernels.svd3(matrices, svdOut, svdOut + 4, svdOut + 7, matrixCount);
+	reference.svd3(matrices, svdReferenceOut, svdReferenceOut + 4, svdReferenceOut + 7, matrixCount);
+	for (size_t i = 4*matrixCount; i < 7*matrixCount; i++) ok &= (std::abs(svd[i] - svdReference[i]) <= tolerance * 8);
+	kernels.polar3(matrices, svdOut, svdOut + 4, matrixCount);
+	reference.polar3(matrices, svdReferenceOut, svdReferenceOut + 4, matrixCount);
+	for (size_t i = 4*matrixCount; i < 10*matrixCount; i++) ok &= (std::abs(svd[i] - svdReference[i]) <= tolerance * 8);
+
+	return ok;
+}
+#endif
+
+TEST_CASE("Testing runtime dispatch")
+{
+#if defined(LIN_ALGEBRA_RUNTIME_DISPATCH)
+	SECTION("Testing kernels of all supported instruction sets")
+	{
+		const simd::InstructionSet isa = simd::runtimeInstructionSet();
+		INFO("Detected instruction set: " << simd::instructionSetName(isa));
+		const simd::InstructionSet isas[] = { simd::InstructionSet::Scalar, simd::InstructionSet::Sse2, simd::InstructionSet::Avx2, simd::InstructionSet::Avx512 };
+		for (simd::InstructionSet candidate : isas) {
+			if (candidate > isa) break;
+			INFO("Checking " << simd::instructionSetName(candidate));
+			REQUIRE(checkKernelTable<float>(candidate));
+			REQUIRE(checkKernelTable<double>(candidate));
+		}
+	}
+#endif
+
+	SECTION("Testing inner products of long vectors")
+	{
+		ColumnVector<double, 100> v1, v2;
+		double expected = 0;
+		for (size_t i = 0; i < 100; i++) {
+			v1[i] = 0.5 * double(i);
+			v2[i] = 3.0 - double(i);
+			expected += v1[i] * v2[i];
+		}
+		REQUIRE(ColumnVector<double, 100>::dotProduct(v1, v2) == Approx(expected));
+		REQUIRE(v1.normSquared() == Approx(ColumnVector<double, 100>::dotProduct(v1, v1)));
+	}
+
+	SECTION("Testing batched vector transformations")
+	{
+		typedef Vector3<float> vec3f;
+		const Matrix<float, 3, 3> mat(0.5f, -1.0f, 2.0f, 1.5f, 0.25f, -3.0f, 1.0f, 2.0f, -0.5f);
+		std::vector<vec3f> in(37), out(37);
+		for (size_t i = 0; i < in.size(); i++) in[i] = vec3f(float(i), 1.0f - float(i), 0.5f * float(i));
+
+		transformVectors(mat, in.data(), out.data(), in.size());
+		for (size_t i = 0; i < in.size(); i++) {
+			const vec3f expected = mat * in[i];
+			CHECK((out[i] - expected).norm() <= 1e-5f * (1.0f + expected.norm()));
+		}
+
+		// In place
+		std::vector<vec3f> inPlace(in);
+		transformVectors(mat, inPlace.data(), inPlace.data(), inPlace.size());
+		REQUIRE(inPlace == out);
+	}
+
+	SECTION("Testing batched quaternion transformations")
+	{
+		typedef Vector3<double> vec3d;
+		const Quaternion<double> q = Quaternion<double>::fromAxisAndAngle(vec3d(1, 2, -0.5).normalized(), 0.7);
+		std::vector<vec3d> in(21), out(21);
+		for (size_t i = 0; i < in.size(); i++) in[i] = vec3d(double(i), 2.0 - double(i), 0.25 * double(i));
+
+		q.transform(in.data(), out.data(), in.size());
+		for (size_t i = 0; i < in.size(); i++) {
+			const vec3d expected = q.transform(in[i]);
+			CHECK((out[i] - expected).norm() <= 1e-12 * (1.0 + expected.norm()));
+		}
+
+		// Points stored in the columns of a matrix
+		Matrix<double, 3, 21> points;
+		for (size_t i = 0; i < in.size(); i++) {
+			for (size_t j = 0; j < 3; j++) points(j, i) = in[i][j];
+		}
+		const Matrix<double, 3, 21> rotated = q.transform(points);
+		for (size_t i = 0; i < in.size(); i++) {
+			for (size_t j = 0; j < 3; j++) CHECK(rotated(j, i) == out[i][j]);
+		}
+	}
+
+	SECTION("Testing quaternion streams")
+	{
+		typedef Vector3<float> vec3f;
+		typedef Quaternion<float> quatf;
+		std::vector<quatf> rotations(37);
+		std::vector<vec3f> in(37), out(37);
+		for (size_t i = 0; i < in.size(); i++) {
+			rotations[i] = quatf::fromAxisAndAngle(vec3f(1.0f, float(i % 5) - 2.0f, 0.5f).normalized(), 0.1f * float(i));
+			in[i] = vec3f(float(i), 2.0f - float(i), 0.25f * float(i));
+		}
+
+		quatf::transform(rotations.data(), in.data(), out.data(), in.size());
+		for (size_t i = 0; i < in.size(); i++) {
+			const vec3f expected = rotations[i].transform(in[i]);
+			CHECK((out[i] - expected).norm() <= 1e-5f * (1.0f + expected.norm()));
+		}
+
+		Matrix<float, 3, 37> points;
+		for (size_t i = 0; i < in.size(); i++) {
+			for (size_t j = 0; j < 3; j++) points(j, i) = in[i][j];
+		}
+		const Matrix<float, 3, 37> rotated = quatf::transform(rotations.data(), points);
+		for (size_t i = 0; i < in.size(); i++) {
+			for (size_t j = 0; j < 3; j++) CHECK(rotated(j, i) == out[i][j]);
+		}
+
+		// In place
+		std::vector<vec3f> inPlace(in);
+		quatf::transform(rotations.data(), inPlace.data(), inPlace.data(), inPlace.size());
+		REQUIRE(inPlace == out);
+	}
+}
+
 TEST_CASE("Testing ColumnVector")
 {
 	typedef ColumnVector<double, 4> vec4d;
@@ -360,6 +2342,106 @@ TEST_CASE("Testing Vector3")
 	}
 }
 
+TEST_CASE("Testing Vector3Array")
+{
+	typedef Vector3<float> vec3f;
+	typedef Vector3Array<float> array3f;
+	const float tolerance = 1e-6f;
+
+	// 37 vectors to cover full packets and a remainder with every instruction set
+	std::vector<vec3f> vectors1, vectors2;
+	for (size_t i = 0; i < 37; i++) {
+		vectors1.push_back(vec3f(float(i) - 3.5f, 1.0f - 0.5f * float(i), 0.25f * float(i) + 1.0f));
+		vectors2.push_back(vec3f(2.0f - float(i % 5), float(i % 7) + 0.5f, -1.5f * float(i % 3) - 0.25f));
+	}
+	const array3f a1(vectors1), a2(vectors2);
+
+	SECTION("Testing construction and conversion")
+	{
+		REQUIRE(a1.size() == vectors1.size());
+		REQUIRE(a1.toVector() == vectors1);
+		REQUIRE(array3f(vectors1.data(), vectors1.size()) == a1);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(a1.x()) % size_t(array3f::alignment) == 0);
+		REQUIRE(reinterpret_cast<std::uintptr_t>(a1.z()) % size_t(array3f::alignment) == 0);
+		REQUIRE(a1.y()[4] == vectors1[4][1]);
+
+		const array3f zeros(5);
+		REQUIRE(zeros.size() == 5);
+		REQUIRE(zeros[4] == vec3f(0, 0, 0));
+		REQUIRE(array3f().empty());
+	}
+
+	SECTION("Testing modification")
+	{
+		array3f array;
+		for (const vec3f& v : vectors1) array.push_back(v);
+		REQUIRE(array == a1);
+
+		array.set(3, vec3f(1, 2, 3));
+		REQUIRE(array[3] == vec3f(1, 2, 3));
+		REQUIRE(array != a1);
+
+		array.resize(40);
+		REQUIRE(array[39] == vec3f(0, 0, 0));
+		REQUIRE(array[36] == vectors1[36]);
+		array.clear();
+		REQUIRE(array.empty());
+	}
+
+	SECTION("Testing bulk operations")
+	{
+		const std::vector<float> dots = array3f::dotProduct(a1, a2);
+		const std::vector<float> norms = a1.norm();
+		const array3f crosses = array3f::crossProduct(a1, a2);
+		const array3f normalized = a1.normalized();
+		REQUIRE(dots.size() == a1.size());
+		REQUIRE(crosses.size() == a1.size());
+
+		for (size_t i = 0; i < a1.size(); i++) {
+			const float dot = vec3f::dotProduct(vectors1[i], vectors2[i]);
+			CHECK(std::abs(dots[i] - dot) <= tolerance * (1.0f + std::abs(dot)));
+			CHECK(std::abs(norms[i] - vectors1[i].norm()) <= tolerance * vectors1[i].norm());
+
+			const vec3f cross = vec3f::crossProduct(vectors1[i], vectors2[i]);
+			CHECK((crosses[i] - cross).norm() <= tolerance * (1.0f + cross.norm()));
+			CHECK((normalized[i] - vectors1[i].normalized()).norm() <= tolerance);
+		}
+	}
+
+	SECTION("Testing arithmetic")
+	{
+		const array3f sum = a1 + a2;
+		const array3f difference = a1 - a2;
+		const array3f scaled = 2.0f * a1;
+		for (size_t i = 0; i < a1.size(); i++) {
+			REQUIRE(sum[i] == vec3f(vectors1[i] + vectors2[i]));
+			REQUIRE(difference[i] == vec3f(vectors1[i] - vectors2[i]));
+			REQUIRE(scaled[i] == vec3f(2.0f * vectors1[i]));
+		}
+
+		array3f array(a1);
+		array += a2;
+		array -= a2;
+		array *= 0.5f;
+		REQUIRE(array == 0.5f * a1);
+	}
+
+	SECTION("Testing size checks")
+	{
+		array3f shorter(a2);
+		shorter.resize(36);
+		std::vector<float> dots(a1.size());
+		REQUIRE_THROWS_AS(array3f::dotProduct(a1, shorter, dots.data()), std::invalid_argument);
+		REQUIRE_THROWS_AS(array3f::dotProduct(a1, shorter), std::invalid_argument);
+		REQUIRE_THROWS_AS(array3f::crossProduct(a1, shorter), std::invalid_argument);
+		REQUIRE_THROWS_AS(a1 + shorter, std::invalid_argument);
+
+		array3f array(a1);
+		REQUIRE_THROWS_AS(array -= shorter, std::invalid_argument);
+		REQUIRE(array == a1);
+	}
+}
+
 TEST_CASE("Testing Quaternion")
 {
 	typedef Quaternion<double> quatd;
@@ -411,6 +2493,67 @@ TEST_CASE("Testing Quaternion")
 		REQUIRE(quatd::slerp(q, q2, 0.5) == (q*quatd::pow(q.inverse()*q2, 0.5)));
 	}
 
+	SECTION("Testing toMatrix() and fromMatrix()")
+	{
+		const double pi = 3.141592653589793238462643383;
+		const vec3d axes[] = { vec3d(1, 0, 0), vec3d(0, 1, 0), vec3d(0, 0, 1), vec3d(1, -2, 0.5).normalized() };
+		const double angles[] = { 0.0, 0.3, -1.2, 2.5, pi - 1e-9, pi };
+		const vec3d v(0.3, -1.5, 2.0);
+
+		for (const vec3d& axis : axes) {
+			for (double angle : angles) {
+				const quatd rotation = quatd::fromAxisAndAngle(axis, angle);
+				const Matrix<double, 3, 3> mat = rotation.toMatrix();
+				CHECK((mat*v - rotation.transform(v)).norm() < 1e-14);
+
+				// The conversion may flip the sign of all components
+				const quatd converted = quatd::fromMatrix(mat);
+				const double sign = (quatd::dotProduct(rotation, converted) < 0) ? -1.0 : 1.0;
+				CHECK(std::abs(converted.q0() - sign*rotation.q0()) < 1e-14);
+				CHECK((converted.vector() - sign*rotation.vector()).norm() < 1e-14);
+			}
+		}
+	}
+
+	SECTION("Testing batched matrix conversions")
+	{
+		typedef Quaternion<float> quatf;
+		typedef Matrix<float, 3, 3> mat3f;
+		std::vector<quatf> rotations(37), converted(37);
+		std::vector<mat3f> matrices(37);
+		for (size_t i = 0; i < rotations.size(); i++) {
+			rotations[i] = quatf::fromAxisAndAngle(Vector3<float>(float(i % 3) - 1.0f, 1.0f, float(i % 5)).normalized(), 0.17f * float(i));
+		}
+
+		quatf::toMatrices(rotations.data(), matrices.data(), rotations.size());
+		quatf::fromMatrices(matrices.data(), converted.data(), matrices.size());
+		for (size_t i = 0; i < rotations.size(); i++) {
+			const mat3f expected = rotations[i].toMatrix();
+			for (size_t j = 0; j < 9; j++) CHECK(std::abs(matrices[i][j] - expected[j]) < 1e-6f);
+
+			const quatf expectedQuat = quatf::fromMatrix(matrices[i]);
+			CHECK(std::abs(converted[i].q0() - expectedQuat.q0()) < 1e-6f);
+			CHECK((converted[i].vector() - expectedQuat.vector()).norm() < 1e-6f);
+		}
+	}
+
+	SECTION("Testing compound assignment")
+	{
+		const quatd p(1, 2, 3, 4), r(0.5, -1, 0.25, 2);
+		quatd test(p);
+		REQUIRE(&(test *= r) == &test);
+		REQUIRE(test == p*r);
+		REQUIRE(&(test += r) == &test);
+		REQUIRE(&(test -= r) == &test);
+		REQUIRE(test == p*r);
+		REQUIRE(&(test *= 2.0) == &test);
+		REQUIRE(test == 2.0*(p*r));
+
+		test = p;
+		test *= test;
+		REQUIRE(test == p*p);
+	}
+
 	SECTION("Testing exp() and transform()")
 	{
 		vec3d x(0, 1, 0);
@@ -433,4 +2576,251 @@ TEST_CASE("Testing Quaternion")
 		REQUIRE(relativeError<double>(1, x.y()) < 2e-14);
 		REQUIRE(x.z() < 2e-15);
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("Testing constant expressions")
+{
+	typedef Matrix<double, 3, 3> mat3x3d;
+	typedef Matrix<double, 2, 3> mat2x3d;
+	typedef Vector3<double> vec3d;
+	typedef Quaternion<double> quatd;
+
+	SECTION("Testing matrices")
+	{
+		constexpr mat3x3d eye = mat3x3d::createIdentity();
+		static_assert(eye(0, 0) == 1 && eye(1, 1) == 1 && eye(2, 2) == 1, "Diagonal of the identity");
+		static_assert(eye(1, 0) == 0 && eye(0, 2) == 0, "Off-diagonal entries of the identity");
+
+		constexpr mat2x3d a{ 1., 2., 3., 4., 5., 6. };
+		constexpr Matrix<double, 3, 2> at = a.transposed();
+		static_assert(at(0, 1) == 2 && at(2, 0) == 5 && at(1, 1) == 4, "Transposed");
+
+		constexpr mat2x3d sum = a + 2.0*a - a;
+		static_assert(sum(1, 2) == 12 && sum(0, 0) == 2, "Elementwise arithmetic");
+
+		constexpr Matrix<double, 2, 2> product = a*at;
+		static_assert(product(0, 0) == 35 && product(0, 1) == 44 && product(1, 1) == 56, "Matrix product");
+		constexpr Matrix<double, 2, 3> swapped = a*eye;
+		static_assert(swapped(1, 2) == 6, "Product with the identity");
+		constexpr Matrix<double, 3, 3> gram = a.transposed()*a;
+		static_assert(gram(2, 1) == 39, "Product with a transposed operand");
+
+		const Matrix<double, 2, 2> runtimeProduct = a*at;
+		REQUIRE(runtimeProduct == product);
+	}
+
+	SECTION("Testing vectors and quaternions")
+	{
+		constexpr vec3d x(1, 0, 0), y(0, 1, 0);
+		constexpr vec3d z = vec3d::crossProduct(x, y);
+		static_assert(z.x() == 0 && z.y() == 0 && z.z() == 1, "Cross product");
+		static_assert(x.transposed()*y == 0, "Inner product");
+
+		// Rotation of 90 degrees about the z axis applied twice
+		constexpr double s = 0.70710678118654752440;
+		constexpr quatd q(s, 0, 0, s);
+		constexpr quatd q2 = q*q;
+		static_assert(q2.q1() == 0 && q2.q2() == 0, "Quaternion product");
+		REQUIRE(std::abs(q2.q0()) < 1e-15);
+		REQUIRE(std::abs(q2.q3() - 1) < 1e-15);
+
+		constexpr quatd identity = q*q.conjugated();
+		static_assert(identity.q3() == 0, "Product with the conjugate");
+		constexpr quatd diff = (q + 2.0*q) - q;
+		static_assert(diff.q0() == (s + 2*s) - s && diff.q1() == 0, "Quaternion sum and difference");
+	}
+}
+
+/**
+ * Checks the operations counted by an OperationCounter
+ *
+ * The arithmetic operations are compared exactly. Constructions, copies
+ * and moves are compared as their sum, because compilers differ in which
+ * copies of return values they elide.
+ */
+static void checkCounts(const OperationCounts& counts, size_t temporaries, size_t additions, size_t multiplications,
+	size_t divisions = 0, size_t functions = 0)
+{
+	INFO(counts);
+	CHECK(counts.temporaries() == temporaries);
+	CHECK(counts.additions == additions);
+	CHECK(counts.multiplications == multiplications);
+	CHECK(counts.divisions == divisions);
+	CHECK(counts.functions == functions);
+}
+
+TEST_CASE("Testing operation counts")
+{
+	typedef CountingScalar<double> scalar;
+	typedef Matrix<scalar, 3, 3> mat3x3;
+	typedef ColumnVector<scalar, 4> vec4;
+	typedef Vector3<scalar> vec3;
+	typedef Quaternion<scalar> quat;
+
+	const mat3x3 a{ 1., 2., 3., 4., 5., 6., 7., 8., 10. }, b(a);
+	const vec3 x(1., 2., 3.), y(-1., 0.5, 2.);
+	const vec4 u{ 1., 2., 3., 4. }, w{ 4., 3., 2., 1. };
+	const quat p(0.5, 0.5, 0.5, 0.5), q(0.8, 0., 0.6, 0.);
+
+	SECTION("Testing the counter")
+	{
+		OperationCounter counter;
+		scalar s(2.0);
+		scalar t(s);
+		scalar r = s*t + s/t - sqrt(s);
+		REQUIRE(r.value() == 4.0 + 1.0 - std::sqrt(2.0));
+		const OperationCounts counts = counter.counts();
+		REQUIRE(counts.constructions == 1);
+		REQUIRE(counts.copies == 1);
+		REQUIRE(counts.additions == 2);
+		REQUIRE(counts.multiplications == 1);
+		REQUIRE(counts.divisions == 1);
+		REQUIRE(counts.functions == 1);
+
+		counter.reset();
+		{
+			OperationCounter inner;
+			s += t;
+			REQUIRE(inner.counts().additions == 1);
+		}
+		REQUIRE(counter.counts().additions == 1);
+		REQUIRE(counter.counts().temporaries() == 0);
+	}
+
+	SECTION("Testing Matrix")
+	{
+		OperationCounter counter;
+		{ const mat3x3 m{ 1., 2., 3., 4., 5., 6., 7., 8., 9. }; }
+		checkCounts(counter.counts(), 9, 0, 0);
+
+		counter.reset();
+		{ const mat3x3 m(a); }
+		checkCounts(counter.counts(), 9, 0, 0);
+
+		counter.reset();
+		{ const mat3x3 m = a + b; (void)m; }
+		checkCounts(counter.counts(), 36, 9, 0);
+
+		counter.reset();
+		{ const mat3x3 m = a + 2.0*b; (void)m; }
+		checkCounts(counter.counts(), 45, 9, 9);
+
+		counter.reset();
+		{ const mat3x3 m = a*b; (void)m; }
+		checkCounts(counter.counts(), 27, 27, 27);
+
+		counter.reset();
+		{ const mat3x3 m = a.transposed(); (void)m; }
+		checkCounts(counter.counts(), 27, 0, 0);
+
+		counter.reset();
+		{ const vec3 m = a*x; (void)m; }
+		checkCounts(counter.counts(), 9, 9, 9);
+
+		counter.reset();
+		{ const mat3x3 m = mat3x3::createIdentity(); (void)m; }
+		checkCounts(counter.counts(), 15, 0, 0);
+
+		mat3x3 m(a);
+		counter.reset();
+		m += b;
+		checkCounts(counter.counts(), 0, 9, 0);
+		counter.reset();
+		m *= scalar(2.0);
+		checkCounts(counter.counts(), 1, 0, 9);
+	}
+
+	SECTION("Testing ColumnVector and Vector3")
+	{
+		OperationCounter counter;
+		{ const vec4 m = u + w; (void)m; }
+		checkCounts(counter.counts(), 16, 4, 0);
+
+		counter.reset();
+		{ const scalar d = vec4::dotProduct(u, w); (void)d; }
+		checkCounts(counter.counts(), 1, 4, 4);
+
+		counter.reset();
+		{ const scalar d = vec3::dotProduct(x, y); (void)d; }
+		checkCounts(counter.counts(), 1, 3, 3);
+
+		counter.reset();
+		{ const scalar d = x.transposed()*y; (void)d; }
+		checkCounts(counter.counts(), 4, 3, 3);
+
+		counter.reset();
+		{ const vec3 m = vec3::crossProduct(x, y); (void)m; }
+		checkCounts(counter.counts(), 12, 3, 6);
+
+		counter.reset();
+		{ const scalar d = x.norm(); (void)d; }
+		checkCounts(counter.counts(), 1, 3, 3, 0, 1);
+
+		counter.reset();
+		{ const vec3 m = y.normalized(); (void)m; }
+		checkCounts(counter.counts(), 5, 3, 6, 1, 1);
+	}
+
+	SECTION("Testing Quaternion")
+	{
+		OperationCounter counter;
+		{ const quat m = p*q; (void)m; }
+		checkCounts(counter.counts(), 43, 13, 16);
+
+		counter.reset();
+		{ const quat m = p + q; (void)m; }
+		checkCounts(counter.counts(), 16, 4, 0);
+
+		counter.reset();
+		{ const quat m = q.conjugated(); (void)m; }
+		checkCounts(counter.counts(), 14, 3, 0);
+
+		counter.reset();
+		{ const quat m = q.inverse(); (void)m; }
+		checkCounts(counter.counts(), 20, 7, 8, 1);
+
+		counter.reset();
+		{ const quat m = quat::log(q); (void)m; }
+		checkCounts(counter.counts(), 17, 7, 10, 2, 4);
+
+		counter.reset();
+		{ const quat m = quat::exp(q); (void)m; }
+		checkCounts(counter.counts(), 20, 3, 10, 1, 4);
+
+		counter.reset();
+		{ const quat m = quat::slerp(p, q, scalar(0.5)); (void)m; }
+		checkCounts(counter.counts(), 177, 43, 72, 4, 8);
+
+		counter.reset();
+		{ const vec3 m = q.transform(x); (void)m; }
+		checkCounts(counter.counts(), 56, 18, 29);
+
+		counter.reset();
+		{ const mat3x3 m = q.toMatrix(); (void)m; }
+		checkCounts(counter.counts(), 38, 12, 18);
+
+		quat m(p);
+		counter.reset();
+		m *= q;
+		checkCounts(counter.counts(), 43, 13, 16);
+	}
+}
+
+TEST_CASE("Testing disabled FLOP accounting")
+{
+	REQUIRE(!flopAccountingEnabled);
+
+	typedef Matrix<double,4,4> mat4x4;
+	const mat4x4 a = mat4x4::createIdentity();
+	const mat4x4 b = a*a + a.inverse();
+	const Quaternion<double> p(0.5, 0.5, 0.5, 0.5), q(0.8, 0., 0.6, 0.);
+	const Quaternion<double> r = Quaternion<double>::slerp(p, q, 0.5)*q;
+	const DynamicMatrix<double> c(5, 3), d(3, 2);
+	const DynamicMatrix<double> e = c*d;
+	(void)b; (void)r; (void)e;
+
+	// The operations compile to nothing, so the tallies of the thread stay zero
+	const OperationTally total = operationTallies().total();
+	REQUIRE(total.calls == 0);
+	REQUIRE(total.flops == 0);
+	REQUIRE(total.bytes == 0);
+}